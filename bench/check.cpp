@@ -0,0 +1,1078 @@
+//
+//  check.cpp
+//
+//  Purpose
+//  =======
+//
+//  Checks the routines that are only available as templates, in include,
+//  against the routines of the legacy interface, for each precision they
+//  take.  Each operation is done both ways on the same operands, over its
+//  options and with unit and non-unit strides, and the largest difference
+//  relative to the largest element of the legacy result is reported along
+//  with whether it is within the tolerance of the precision:
+//
+//      axpydot, axpydotc   axpy and dot, dotc
+//      waxpby              copy, scal and axpy
+//      axpy2               two axpy
+//      scalcopy            copy and scal
+//      rank_update         ger, gerc, syr, syr2, her and her2
+//      rfp                 conversions between full, packed and RFP storage
+//      sfrk, hfrk          syrk, herk
+//      tfsm                trsm
+//      sfmv, hfmv          symv, hemv
+//      tbsm                scal and tbsv for each right-hand side
+//      gbmm                gbmv for each column
+//      sbmm, hbmm          symm, hemm on the band expanded to full storage
+//      trsv_multi          trsv for each vector
+//      trmv_multi          trmv for each vector
+//      rot_sequence        rot for each rotation
+//      rotg_batch          rotg for each point
+//      rotmg_batch         rotmg for each point
+//      async               the same operations, in order, through a stream
+//                          and without one, and many small gemv queued on
+//                          several streams at once
+//      dag                 the same operations queued on one task graph,
+//                          large enough to span several tiles, and on
+//                          views whose tiles do not line up
+//
+//  Usage
+//  =====
+//
+//      tblas-check
+//
+
+#include "blas.h"
+#include "async.h"
+#include "axpy2.h"
+#include "axpydot.h"
+#include "dag.h"
+#include "gbmm.h"
+#include "hbmm.h"
+#include "hfmv.h"
+#include "hfrk.h"
+#include "rfp.h"
+#include "rot.h"
+#include "rotg.h"
+#include "rotmg.h"
+#include "sbmm.h"
+#include "scalcopy.h"
+#include "sfmv.h"
+#include "sfrk.h"
+#include "tbsm.h"
+#include "tfsm.h"
+#include "trmv.h"
+#include "trsv.h"
+#include "update.h"
+#include "waxpby.h"
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <vector>
+
+using std::complex;
+using std::vector;
+
+int failures=0;
+
+template <typename T>
+struct real_part
+{
+    typedef T type;
+};
+
+template <typename T>
+struct real_part<complex<T> >
+{
+    typedef T type;
+};
+
+template <typename T>
+struct make
+{
+    static T value(double re, double im)
+    {
+        return T(re);
+    }
+};
+
+template <typename T>
+struct make<complex<T> >
+{
+    static complex<T> value(double re, double im)
+    {
+        return complex<T>(re,im);
+    }
+};
+
+template <typename T> const char *prefix();
+template <> const char *prefix<float>() { return "s"; }
+template <> const char *prefix<double>() { return "d"; }
+template <> const char *prefix<complex<float> >() { return "c"; }
+template <> const char *prefix<complex<double> >() { return "z"; }
+
+template <typename T>
+double tolerance()
+{
+    return (sizeof(typename real_part<T>::type)==sizeof(float))?1e-4:1e-11;
+}
+
+template <typename T>
+T alpha()
+{
+    return make<T>::value(0.5,0.25);
+}
+
+template <typename T>
+T beta()
+{
+    return make<T>::value(0.25,-0.5);
+}
+
+template <typename T>
+void fill(vector<T> &a, int seed)
+{
+    for(size_t i=0;i<a.size();i++)
+        a[i]=make<T>::value(((i*7919+seed*104729)%2003)/2003.0-0.5,((i*6007+seed*7177)%1999)/1999.0-0.5);
+}
+
+//  Scales a by 1/scale and sets the n elements a[first+k*step] to 2, so
+//  that triangular solves with the matrix are well conditioned.
+
+template <typename T>
+void dominant(vector<T> &a, size_t n, int scale, size_t first, size_t step)
+{
+    for(size_t i=0;i<a.size();i++)
+        a[i]*=typename real_part<T>::type(1.0/scale);
+    for(size_t k=0;k<n;k++)
+        a[first+k*step]=make<T>::value(2.0,0.0);
+}
+
+//  Largest difference between a and b relative to the largest element of b.
+
+template <typename T>
+double error(const vector<T> &a, const vector<T> &b)
+{
+    using std::abs;
+    if(a.size()!=b.size())
+        return 1e30;
+    double diff=0.0,size=1e-30;
+    for(size_t i=0;i<a.size();i++)
+    {
+        diff=std::max(diff,double(abs(a[i]-b[i])));
+        size=std::max(size,double(abs(b[i])));
+    }
+    return (diff==diff)?diff/size:1e30;
+}
+
+template <typename T>
+double error(T a, T b)
+{
+    return error(vector<T>(1,a),vector<T>(1,b));
+}
+
+template <typename T>
+void report(const char *name, double e)
+{
+    const bool pass=(e<=tolerance<T>());
+    std::printf("%s%-13s %10.2e%s\n",prefix<T>(),name,e,pass?"":"  FAILED");
+    if(!pass)
+        failures++;
+}
+
+//  The complex dot products return their value through the first argument
+//  when built with the Intel compiler.
+
+#ifdef __INTEL_COMPILER
+complex<float> cdotc(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { complex<float> d; cdotc_(d,n,x,incx,y,incy); return d; }
+complex<float> cdotu(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { complex<float> d; cdotu_(d,n,x,incx,y,incy); return d; }
+complex<double> zdotc(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { complex<double> d; zdotc_(d,n,x,incx,y,incy); return d; }
+complex<double> zdotu(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { complex<double> d; zdotu_(d,n,x,incx,y,incy); return d; }
+#else
+complex<float> cdotc(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { return cdotc_(n,x,incx,y,incy); }
+complex<float> cdotu(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { return cdotu_(n,x,incx,y,incy); }
+complex<double> zdotc(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { return zdotc_(n,x,incx,y,incy); }
+complex<double> zdotu(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { return zdotu_(n,x,incx,y,incy); }
+#endif
+
+//  Strides of the Level-1 checks: all unit, then mixed and negative.  The
+//  legacy scal does nothing for a negative stride, so the checks scale by
+//  its absolute value, which takes the same elements.
+
+const int n1=5000;
+const int strides[][3]={{1,1,1},{3,-2,2}};
+
+//  axpydot, or axpydotc if conj is set and T is complex.
+
+template <typename T>
+T fused(bool conj, size_t n, T alpha, T *v, ptrdiff_t incv, T *w, ptrdiff_t incw, T *u, ptrdiff_t incu)
+{
+    return tblas::axpydot(n,alpha,v,incv,w,incw,u,incu);
+}
+
+template <typename T>
+complex<T> fused(bool conj, size_t n, complex<T> alpha, complex<T> *v, ptrdiff_t incv, complex<T> *w, ptrdiff_t incw, complex<T> *u, ptrdiff_t incu)
+{
+    if(conj)
+        return tblas::axpydotc(n,alpha,v,incv,w,incw,u,incu);
+    return tblas::axpydot(n,alpha,v,incv,w,incw,u,incu);
+}
+
+template <typename T, typename AXPY, typename DOT>
+void check_axpydot(const char *name, bool conj, AXPY axpy, DOT dot)
+{
+    double e=0.0;
+    for(const int *inc:strides)
+    {
+        const int n=n1/3;
+        vector<T> v(n1),w(n1),u(n1);
+        fill(v,1);
+        fill(w,2);
+        fill(u,3);
+        vector<T> w1(w);
+        const T r=fused(conj,n,alpha<T>(),v.data(),inc[0],w.data(),inc[1],u.data(),inc[2]);
+        axpy(n,-alpha<T>(),v.data(),inc[0],w1.data(),inc[1]);
+        const T r1=dot(n,w1.data(),inc[1],u.data(),inc[2]);
+        e=std::max(e,std::max(error(w,w1),error(r,r1)));
+    }
+    report<T>(name,e);
+}
+
+template <typename T, typename COPY, typename SCAL, typename AXPY>
+void check_waxpby(COPY copy, SCAL scal, AXPY axpy)
+{
+    double e=0.0;
+    for(const int *inc:strides)
+    {
+        const int n=n1/3;
+        vector<T> x(n1),y(n1),w(n1),w1(n1);
+        fill(x,1);
+        fill(y,2);
+        tblas::waxpby(n,alpha<T>(),x.data(),inc[0],beta<T>(),y.data(),inc[1],w.data(),inc[2]);
+        copy(n,y.data(),inc[1],w1.data(),inc[2]);
+        scal(n,beta<T>(),w1.data(),std::abs(inc[2]));
+        axpy(n,alpha<T>(),x.data(),inc[0],w1.data(),inc[2]);
+        e=std::max(e,error(w,w1));
+    }
+    report<T>("waxpby",e);
+}
+
+template <typename T, typename AXPY>
+void check_axpy2(AXPY axpy)
+{
+    double e=0.0;
+    for(const int *inc:strides)
+    {
+        const int n=n1/3;
+        vector<T> x1(n1),x2(n1),y(n1);
+        fill(x1,1);
+        fill(x2,2);
+        fill(y,3);
+        vector<T> y1(y);
+        tblas::axpy2(n,alpha<T>(),x1.data(),inc[0],beta<T>(),x2.data(),inc[1],y.data(),inc[2]);
+        axpy(n,alpha<T>(),x1.data(),inc[0],y1.data(),inc[2]);
+        axpy(n,beta<T>(),x2.data(),inc[1],y1.data(),inc[2]);
+        e=std::max(e,error(y,y1));
+    }
+    report<T>("axpy2",e);
+}
+
+template <typename T, typename U, typename COPY, typename SCAL>
+void check_scalcopy(const char *name, U a, COPY copy, SCAL scal)
+{
+    double e=0.0;
+    for(const int *inc:strides)
+    {
+        const int n=n1/3;
+        vector<T> x(n1),y(n1),y1(n1);
+        fill(x,1);
+        tblas::scalcopy(n,a,x.data(),inc[0],y.data(),inc[1]);
+        copy(n,x.data(),inc[0],y1.data(),inc[1]);
+        scal(n,a,y1.data(),std::abs(inc[1]));
+        e=std::max(e,error(y,y1));
+    }
+    report<T>(name,e);
+}
+
+//  rank_update with uplo='G' against ger (geru for complex) and gerc, with
+//  a capacity small enough that the updates are flushed part way.
+
+template <typename T, typename GER, typename GERC>
+void check_update_general(GER ger, GERC gerc)
+{
+    const int m=57,n=43;
+    vector<T> A(m*n),x(2*m),y(2*n);
+    fill(A,1);
+    vector<T> A1(A);
+    {
+        tblas::rank_update<T> acc('G',m,n,A.data(),m,3);
+        for(int r=0;r<5;r++)
+        {
+            fill(x,2+r);
+            fill(y,3+r);
+            const int incx=(r%2)?-2:1;
+            const int incy=(r%3)?1:2;
+            if(r%2)
+            {
+                acc.gerc(alpha<T>(),x.data(),incx,y.data(),incy);
+                gerc(m,n,alpha<T>(),x.data(),incx,y.data(),incy,A1.data(),m);
+            }
+            else
+            {
+                acc.ger(alpha<T>(),x.data(),incx,y.data(),incy);
+                ger(m,n,alpha<T>(),x.data(),incx,y.data(),incy,A1.data(),m);
+            }
+        }
+    }
+    report<T>("rank_update G",error(A,A1));
+}
+
+//  rank_update with uplo='U' and 'L' against syr and syr2 for real, or her
+//  and her2 for complex matrices.
+
+template <typename T, typename R1, typename R2>
+void check_update_triangle(bool hermitian, R1 rank1, R2 rank2)
+{
+    typedef typename real_part<T>::type R;
+    const int n=51;
+    double e=0.0;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        vector<T> A(n*n),x(2*n),y(2*n);
+        fill(A,1);
+        for(int i=0;i<n;i++)
+            A[i+i*n]=make<T>::value(std::real(A[i+i*n]),0.0);
+        vector<T> A1(A);
+        tblas::rank_update<T> acc(*uplo,n,n,A.data(),n,3);
+        for(int r=0;r<6;r++)
+        {
+            fill(x,2+r);
+            fill(y,3+r);
+            const int incx=(r%2)?-2:1;
+            if(r%3==0)
+            {
+                if(hermitian)
+                    acc.her(R(0.75),x.data(),incx);
+                else
+                    acc.syr(T(0.75),x.data(),incx);
+                rank1(*uplo,n,R(0.75),x.data(),incx,A1.data(),n);
+            }
+            else
+            {
+                if(hermitian)
+                    acc.her2(alpha<T>(),x.data(),incx,y.data(),1);
+                else
+                    acc.syr2(alpha<T>(),x.data(),incx,y.data(),1);
+                rank2(*uplo,n,alpha<T>(),x.data(),incx,y.data(),1,A1.data(),n);
+            }
+        }
+        e=std::max(e,error(vector<T>(acc.matrix(),acc.matrix()+n*n),A1));
+    }
+    report<T>(hermitian?"rank_update H":"rank_update S",e);
+}
+
+//  Upper or lower triangle of the order n matrix A in packed storage.
+
+template <typename T>
+vector<T> pack(char uplo, int n, const vector<T> &A, int ldA)
+{
+    vector<T> AP;
+    for(int j=0;j<n;j++)
+        for(int i=(uplo=='U')?0:j;i<((uplo=='U')?j+1:n);i++)
+            AP.push_back(A[i+j*ldA]);
+    return AP;
+}
+
+//  Conversions between full, packed and RFP storage: full to RFP and back
+//  leaves the triangle as it was and the other triangle untouched, and
+//  packed to RFP and back agree with full to RFP and with packing.
+
+template <typename T>
+void check_rfp()
+{
+    double e=0.0;
+    for(int n=6;n<=9;n++)
+    {
+        const int ldA=n+2;
+        const char tr[]={'N',tblas::rfp_trans(T(0)),0};
+        for(const char *transr=tr;*transr;transr++)
+            for(const char *uplo="UL";*uplo;uplo++)
+            {
+                vector<T> A(ldA*n),B(ldA*n),ARF(n*(n+1)/2),ARF1(n*(n+1)/2),AP1(n*(n+1)/2);
+                fill(A,1);
+                fill(B,2);
+                vector<T> B1(B);
+                for(int j=0;j<n;j++)
+                    for(int i=0;i<n;i++)
+                        if((*uplo=='U')?(i<=j):(i>=j))
+                            B1[i+j*ldA]=A[i+j*ldA];
+                vector<T> AP=pack(*uplo,n,A,ldA);
+                tblas::trttf(*transr,*uplo,n,A.data(),ldA,ARF.data());
+                tblas::tfttr(*transr,*uplo,n,ARF.data(),B.data(),ldA);
+                tblas::tpttf(*transr,*uplo,n,AP.data(),ARF1.data());
+                tblas::tfttp(*transr,*uplo,n,ARF.data(),AP1.data());
+                e=std::max(e,error(B,B1));
+                e=std::max(e,error(ARF1,ARF));
+                e=std::max(e,error(AP1,AP));
+            }
+    }
+    report<T>("rfp",e);
+}
+
+//  Orders of the RFP checks, odd and even, small and blocked.
+
+const int rfp_orders[]={7,8,63,64};
+
+//  sfrk against syrk, or hfrk against herk, on the matrix converted back to
+//  full storage.
+
+template <typename T>
+void rank_k(char transr, char uplo, char trans, size_t n, size_t k, T alpha, T *A, size_t ldA, T beta, T *C)
+{
+    tblas::sfrk(transr,uplo,trans,n,k,alpha,A,ldA,beta,C);
+}
+
+template <typename T>
+void rank_k(char transr, char uplo, char trans, size_t n, size_t k, T alpha, complex<T> *A, size_t ldA, T beta, complex<T> *C)
+{
+    tblas::hfrk(transr,uplo,trans,n,k,alpha,A,ldA,beta,C);
+}
+
+template <typename T, typename SYRK>
+void check_sfrk(const char *name, SYRK syrk)
+{
+    typedef typename real_part<T>::type R;
+    const char h=tblas::rfp_trans(T(0));
+    const char tr[]={'N',h,0};
+    double e=0.0;
+    for(int n:rfp_orders)
+    {
+        const int k=n/2+3;
+        vector<T> A(n*k),C(n*n),CRF(n*(n+1)/2);
+        fill(A,1);
+        for(const char *transr=tr;*transr;transr++)
+            for(const char *uplo="UL";*uplo;uplo++)
+                for(const char *trans=tr;*trans;trans++)
+                {
+                    const int ldA=(*trans=='N')?n:k;
+                    fill(C,2);
+                    for(int i=0;i<n;i++)
+                        C[i+i*n]=make<T>::value(std::real(C[i+i*n]),0.0);
+                    vector<T> C1(C);
+                    tblas::trttf(*transr,*uplo,n,C.data(),n,CRF.data());
+                    rank_k(*transr,*uplo,*trans,n,k,R(0.5),A.data(),ldA,R(0.25),CRF.data());
+                    tblas::tfttr(*transr,*uplo,n,CRF.data(),C.data(),n);
+                    syrk(*uplo,*trans,n,k,R(0.5),A.data(),ldA,R(0.25),C1.data(),n);
+                    e=std::max(e,error(C,C1));
+                }
+    }
+    report<T>(name,e);
+}
+
+template <typename T, typename TRSM>
+void check_tfsm(TRSM trsm)
+{
+    const char tr[]={'N',tblas::rfp_trans(T(0)),0};
+    double e=0.0;
+    for(int order:rfp_orders)
+        for(const char *side="LR";*side;side++)
+        {
+            const int m=(*side=='L')?order:order/2+5;
+            const int n=(*side=='L')?order/2+5:order;
+            vector<T> A(order*order),ARF(order*(order+1)/2),B(m*n);
+            fill(A,1);
+            dominant(A,order,order,0,order+1);
+            for(const char *transr=tr;*transr;transr++)
+                for(const char *uplo="UL";*uplo;uplo++)
+                {
+                    tblas::trttf(*transr,*uplo,order,A.data(),order,ARF.data());
+                    for(const char *trans=tr;*trans;trans++)
+                        for(const char *diag="NU";*diag;diag++)
+                        {
+                            fill(B,2);
+                            vector<T> B1(B);
+                            tblas::tfsm(*transr,*side,*uplo,*trans,*diag,m,n,alpha<T>(),ARF.data(),B.data(),m);
+                            trsm(*side,*uplo,*trans,*diag,m,n,alpha<T>(),A.data(),order,B1.data(),m);
+                            e=std::max(e,error(B,B1));
+                        }
+                }
+        }
+    report<T>("tfsm",e);
+}
+
+//  sfmv against symv, or hfmv against hemv.
+
+template <typename T>
+void rfp_mv(char transr, char uplo, size_t n, T alpha, T *A, T *x, ptrdiff_t incx, T beta, T *y, ptrdiff_t incy)
+{
+    tblas::sfmv(transr,uplo,n,alpha,A,x,incx,beta,y,incy);
+}
+
+template <typename T>
+void rfp_mv(char transr, char uplo, size_t n, complex<T> alpha, complex<T> *A, complex<T> *x, ptrdiff_t incx, complex<T> beta, complex<T> *y, ptrdiff_t incy)
+{
+    tblas::hfmv(transr,uplo,n,alpha,A,x,incx,beta,y,incy);
+}
+
+template <typename T, typename SYMV>
+void check_sfmv(const char *name, SYMV symv)
+{
+    const char tr[]={'N',tblas::rfp_trans(T(0)),0};
+    double e=0.0;
+    for(int n:rfp_orders)
+    {
+        vector<T> A(n*n),ARF(n*(n+1)/2),x(2*n),y(2*n);
+        fill(A,1);
+        fill(x,2);
+        for(const char *transr=tr;*transr;transr++)
+            for(const char *uplo="UL";*uplo;uplo++)
+                for(const int *inc:strides)
+                {
+                    fill(y,3);
+                    vector<T> y1(y);
+                    tblas::trttf(*transr,*uplo,n,A.data(),n,ARF.data());
+                    rfp_mv(*transr,*uplo,n,alpha<T>(),ARF.data(),x.data(),inc[2],beta<T>(),y.data(),inc[1]);
+                    symv(*uplo,n,alpha<T>(),A.data(),n,x.data(),inc[2],beta<T>(),y1.data(),inc[1]);
+                    e=std::max(e,error(y,y1));
+                }
+    }
+    report<T>(name,e);
+}
+
+//  tbsm against scal and tbsv on each right-hand side.
+
+template <typename T, typename SCAL, typename TBSV>
+void check_tbsm(SCAL scal, TBSV tbsv)
+{
+    const int n=71,k=4,nrhs=37,ldA=k+2;
+    double e=0.0;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        vector<T> A(ldA*n),B(n*nrhs);
+        fill(A,1);
+        dominant(A,n,k+1,(*uplo=='U')?k:0,ldA);
+        for(const char *trans="NTC";*trans;trans++)
+            for(const char *diag="NU";*diag;diag++)
+            {
+                fill(B,2);
+                vector<T> B1(B);
+                tblas::tbsm(*uplo,*trans,*diag,n,k,nrhs,alpha<T>(),A.data(),ldA,B.data(),n);
+                for(int j=0;j<nrhs;j++)
+                {
+                    scal(n,alpha<T>(),&B1[j*n],1);
+                    tbsv(*uplo,*trans,*diag,n,k,A.data(),ldA,&B1[j*n],1);
+                }
+                e=std::max(e,error(B,B1));
+            }
+    }
+    report<T>("tbsm",e);
+}
+
+//  gbmm against gbmv on each column.
+
+template <typename T, typename GBMV>
+void check_gbmm(GBMV gbmv)
+{
+    const int m=53,n=29,k=41,kl=3,ku=5,ldA=kl+ku+2;
+    vector<T> A(ldA*std::max(m,k)),B(k*n),C(m*n);
+    fill(A,1);
+    fill(B,2);
+    double e=0.0;
+    for(const char *trans="NTC";*trans;trans++)
+    {
+        const int rows=(*trans=='N')?m:k;
+        const int cols=(*trans=='N')?k:m;
+        fill(C,3);
+        vector<T> C1(C);
+        tblas::gbmm(*trans,m,n,k,kl,ku,alpha<T>(),A.data(),ldA,B.data(),k,beta<T>(),C.data(),m);
+        for(int j=0;j<n;j++)
+            gbmv(*trans,rows,cols,kl,ku,alpha<T>(),A.data(),ldA,&B[j*k],1,beta<T>(),&C1[j*m],1);
+        e=std::max(e,error(C,C1));
+    }
+    report<T>("gbmm",e);
+}
+
+//  sbmm against symm, or hbmm against hemm, on the band expanded to the
+//  stored triangle of a full matrix.
+
+template <typename T>
+void band_mm(char uplo, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC, bool hermitian)
+{
+    tblas::sbmm(uplo,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC);
+}
+
+template <typename T>
+void band_mm(char uplo, size_t m, size_t n, size_t k, complex<T> alpha, complex<T> *A, size_t ldA, complex<T> *B, size_t ldB, complex<T> beta, complex<T> *C, size_t ldC, bool hermitian)
+{
+    if(hermitian)
+        tblas::hbmm(uplo,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC);
+    else
+        tblas::sbmm(uplo,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC);
+}
+
+template <typename T, typename SYMM>
+void check_sbmm(const char *name, bool hermitian, SYMM symm)
+{
+    const int m=67,n=23,k=4,ldA=k+2;
+    vector<T> A(ldA*m),B(m*n),C(m*n);
+    fill(A,1);
+    fill(B,2);
+    double e=0.0;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        vector<T> F(m*m);
+        for(int j=0;j<m;j++)
+        {
+            const int first=(*uplo=='U')?std::max(0,j-k):j;
+            const int last=(*uplo=='U')?j:std::min(m-1,j+k);
+            for(int i=first;i<=last;i++)
+                F[i+j*m]=A[((*uplo=='U')?k+i-j:i-j)+j*ldA];
+        }
+        fill(C,3);
+        vector<T> C1(C);
+        band_mm(*uplo,m,n,k,alpha<T>(),A.data(),ldA,B.data(),m,beta<T>(),C.data(),m,hermitian);
+        symm('L',*uplo,m,n,alpha<T>(),F.data(),m,B.data(),m,beta<T>(),C1.data(),m);
+        e=std::max(e,error(C,C1));
+    }
+    report<T>(name,e);
+}
+
+//  trsv_multi or trmv_multi against trsv or trmv on each vector.
+
+template <typename T, typename TRXV>
+void check_multi(const char *name, bool solve, TRXV trxv)
+{
+    const int n=97,nv=4;
+    const ptrdiff_t incx[nv]={1,2,-1,-3};
+    vector<T> A(n*n);
+    fill(A,1);
+    dominant(A,n,n,0,n+1);
+    double e=0.0;
+    for(const char *uplo="UL";*uplo;uplo++)
+        for(const char *trans="NTC";*trans;trans++)
+            for(const char *diag="NU";*diag;diag++)
+            {
+                vector<T> x[nv],x1[nv];
+                T *p[nv];
+                for(int v=0;v<nv;v++)
+                {
+                    x[v].resize(3*n);
+                    fill(x[v],2+v);
+                    x1[v]=x[v];
+                    p[v]=x[v].data();
+                }
+                if(solve)
+                    tblas::trsv_multi(*uplo,*trans,*diag,n,A.data(),n,nv,p,incx);
+                else
+                    tblas::trmv_multi(*uplo,*trans,*diag,n,A.data(),n,nv,p,incx);
+                for(int v=0;v<nv;v++)
+                {
+                    trxv(*uplo,*trans,*diag,n,A.data(),n,x1[v].data(),int(incx[v]));
+                    e=std::max(e,error(x[v],x1[v]));
+                }
+            }
+    report<T>(name,e);
+}
+
+//  rot_sequence against rot on each pair of columns or rows.
+
+template <typename T, typename ROT>
+void check_rot_sequence(ROT rot)
+{
+    typedef typename real_part<T>::type R;
+    const int m=131,n=47,k=5;
+    double e=0.0;
+    for(const char *side="LR";*side;side++)
+        for(const char *direct="FB";*direct;direct++)
+        {
+            const int len=((*side=='L')?m:n)-1;
+            const int ld=len+1;
+            vector<R> C(ld*k),S(ld*k);
+            for(int i=0;i<ld*k;i++)
+            {
+                const double theta=((i*7919)%2003)/2003.0*6.283185307179586;
+                C[i]=R(std::cos(theta));
+                S[i]=R(std::sin(theta));
+            }
+            vector<T> A(m*n);
+            fill(A,1);
+            vector<T> A1(A);
+            tblas::rot_sequence(*side,*direct,m,n,k,C.data(),ld,S.data(),ld,A.data(),m);
+            for(int l=0;l<k;l++)
+                for(int step=0;step<len;step++)
+                {
+                    const int j=(*direct=='F')?step:len-1-step;
+                    const R c=C[j+l*ld];
+                    const R s=S[j+l*ld];
+                    if(*side=='R')
+                        rot(m,&A1[j*m],1,&A1[(j+1)*m],1,c,s);
+                    else
+                        rot(n,&A1[j],m,&A1[j+1],m,c,s);
+                }
+            e=std::max(e,error(A,A1));
+        }
+    report<T>("rot_sequence",e);
+}
+
+//  rotg_batch against rotg on each point, including points with a zero
+//  coordinate.
+
+template <typename T, typename ROTG>
+void check_rotg_batch(ROTG rotg)
+{
+    typedef typename real_part<T>::type R;
+    const int n=1000;
+    vector<T> a(n),b(n),s(n);
+    vector<R> c(n);
+    fill(a,1);
+    fill(b,2);
+    for(int i=0;i<n;i+=7)
+        a[i]=T(0.0);
+    for(int i=0;i<n;i+=5)
+        b[i]=T(0.0);
+    vector<T> a1(a),b1(b),s1(n);
+    vector<R> c1(n);
+    tblas::rotg_batch(n,a.data(),b.data(),c.data(),s.data());
+    for(int i=0;i<n;i++)
+        rotg(a1[i],b1[i],c1[i],s1[i]);
+    double e=std::max(error(a,a1),error(b,b1));
+    e=std::max(e,std::max(error(c,c1),error(s,s1)));
+    report<T>("rotg_batch",e);
+}
+
+//  rotmg_batch against rotmg on each point, comparing the flags and the
+//  elements of H that the flag says are set.
+
+template <typename T, typename ROTMG>
+void check_rotmg_batch(ROTMG rotmg)
+{
+    const int n=1000;
+    vector<T> d1(n),d2(n),x1(n),y1(n),H(4*n);
+    vector<int> flag(n);
+    fill(d1,1);
+    fill(d2,2);
+    fill(x1,3);
+    fill(y1,4);
+    for(int i=0;i<n;i++)
+    {
+        d1[i]=(i%11==0)?-d1[i]:d1[i]+T(0.5);
+        d2[i]*=(i%13==0)?T(1e-9):(i%17==0)?T(1e9):T(1.0);
+        if(i%19==0)
+            y1[i]=T(0.0);
+    }
+    vector<T> e1(d1),e2(d2),u1(x1);
+    tblas::rotmg_batch(n,d1.data(),d2.data(),x1.data(),y1.data(),H.data(),flag.data());
+    vector<T> h(4*n),h1(4*n);
+    int mismatched=0;
+    for(int i=0;i<n;i++)
+    {
+        T param[5]={0.0,0.0,0.0,0.0,0.0};
+        rotmg(e1[i],e2[i],u1[i],y1[i],param);
+        if(int(param[0])!=flag[i])
+            mismatched++;
+        const bool set[4]={flag[i]!=0&&flag[i]!=-2,flag[i]<=0&&flag[i]!=-2,flag[i]<=0&&flag[i]!=-2,flag[i]!=0&&flag[i]!=-2};
+        for(int l=0;l<4;l++)
+            if(set[l])
+            {
+                h[4*i+l]=H[4*i+l];
+                h1[4*i+l]=param[1+l];
+            }
+    }
+    double e=std::max(error(d1,e1),error(d2,e2));
+    e=std::max(e,std::max(error(x1,u1),error(h,h1)));
+    report<T>("rotmg_batch",(mismatched>0)?1e30:e);
+}
+
+//  Level-3 operations on two matrices, each through a task graph, async
+//  or serially through the legacy interface, for the async and dag checks.
+
+template <typename T>
+struct operands
+{
+    operands(int n) : n(n), A(n*n), B(n*n), L(n*n), C(n*n), D(n*n), E(n*n)
+    {
+        fill(A,1);
+        fill(B,2);
+        fill(L,3);
+        dominant(L,n,n,0,n+1);
+        fill(C,4);
+        fill(D,5);
+        fill(E,6);
+    }
+
+    double error(const operands &b) const
+    {
+        return std::max(::error(C,b.C),std::max(::error(D,b.D),::error(E,b.E)));
+    }
+
+    int n;
+    vector<T> A,B,L,C,D,E;
+};
+
+//  gemm, then trsm and trmm on its result, and syrk and syr2k.
+
+template <typename T, typename GEMM, typename TRSM, typename TRMM, typename SYRK, typename SYR2K>
+void legacy_sequence(operands<T> &o, GEMM gemm, TRSM trsm, TRMM trmm, SYRK syrk, SYR2K syr2k)
+{
+    const int n=o.n;
+    gemm('N','T',n,n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.C.data(),n);
+    trsm('L','L','N','N',n,n,alpha<T>(),o.L.data(),n,o.C.data(),n);
+    trmm('R','U','T','N',n,n,alpha<T>(),o.L.data(),n,o.C.data(),n);
+    syrk('U','N',n,n,alpha<T>(),o.A.data(),n,beta<T>(),o.D.data(),n);
+    syr2k('L','T',n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.E.data(),n);
+}
+
+template <typename T, typename GEMM, typename GEMV, typename TRSM, typename TRMM, typename SYMM, typename SYRK, typename SYR2K>
+void check_async(GEMM gemm, GEMV gemv, TRSM trsm, TRMM trmm, SYMM symm, SYRK syrk, SYR2K syr2k)
+{
+    const size_t n=150;
+    operands<T> o(n),o1(n);
+    vector<T> x(n),y(n),F(n*n);
+    fill(x,7);
+    fill(y,8);
+    fill(F,9);
+    vector<T> y1(y),F1(F);
+    {
+        tblas::async::stream s;
+        std::future<void> ops[]={
+            tblas::async::gemm(s,'N','T',n,n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.C.data(),n),
+            tblas::async::trsm(s,'L','L','N','N',n,n,alpha<T>(),o.L.data(),n,o.C.data(),n),
+            tblas::async::trmm(s,'R','U','T','N',n,n,alpha<T>(),o.L.data(),n,o.C.data(),n),
+            tblas::async::syrk('U','N',n,n,alpha<T>(),o.A.data(),n,beta<T>(),o.D.data(),n),
+            tblas::async::syr2k(s,'L','T',n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.E.data(),n),
+            tblas::async::gemv('T',n,n,alpha<T>(),o.A.data(),n,x.data(),1,beta<T>(),y.data(),1),
+            tblas::async::symm('R','U',n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),F.data(),n)};
+        for(std::future<void> &f:ops)
+            f.get();
+    }
+    legacy_sequence(o1,gemm,trsm,trmm,syrk,syr2k);
+    gemv('T',n,n,alpha<T>(),o1.A.data(),n,x.data(),1,beta<T>(),y1.data(),1);
+    symm('R','U',n,n,alpha<T>(),o1.A.data(),n,o1.B.data(),n,beta<T>(),F1.data(),n);
+    const double e=std::max(o.error(o1),std::max(error(y,y1),error(F,F1)));
+    report<T>("async",e);
+}
+
+template <typename T, typename HEMM, typename HERK, typename HER2K>
+void check_async_hermitian(HEMM hemm, HERK herk, HER2K her2k)
+{
+    typedef typename real_part<T>::type R;
+    const size_t n=150;
+    operands<T> o(n),o1(n);
+    {
+        tblas::async::stream s;
+        std::future<void> ops[]={
+            tblas::async::hemm(s,'L','L',n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.C.data(),n),
+            tblas::async::herk(s,'U','C',n,n,R(0.5),o.A.data(),n,R(0.25),o.D.data(),n),
+            tblas::async::her2k('L','N',n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,R(0.25),o.E.data(),n)};
+        for(std::future<void> &f:ops)
+            f.get();
+    }
+    hemm('L','L',n,n,alpha<T>(),o1.A.data(),n,o1.B.data(),n,beta<T>(),o1.C.data(),n);
+    herk('U','C',n,n,R(0.5),o1.A.data(),n,R(0.25),o1.D.data(),n);
+    her2k('L','N',n,n,alpha<T>(),o1.A.data(),n,o1.B.data(),n,R(0.25),o1.E.data(),n);
+    report<T>("async herm",o.error(o1));
+}
+
+//  Many small gemv, a quarter of them without a stream and the rest spread
+//  over several streams, each writing a vector of its own, so that far
+//  more operations are queued than the executor has threads.
+
+template <typename T, typename GEMV>
+void check_async_many(GEMV gemv)
+{
+    const size_t n=40,nv=256,ns=16;
+    vector<T> A(n*n),x(n),y(n*nv);
+    fill(A,1);
+    fill(x,2);
+    fill(y,3);
+    vector<T> y1(y);
+    {
+        vector<tblas::async::stream> s(ns);
+        vector<std::future<void> > ops;
+        for(size_t k=0;k<nv;k++)
+        {
+            if(k%4==0)
+                ops.push_back(tblas::async::gemv('N',n,n,alpha<T>(),A.data(),n,x.data(),1,beta<T>(),&y[k*n],1));
+            else
+                ops.push_back(tblas::async::gemv(s[k%ns],'N',n,n,alpha<T>(),A.data(),n,x.data(),1,beta<T>(),&y[k*n],1));
+        }
+        for(std::future<void> &f:ops)
+            f.get();
+    }
+    for(size_t k=0;k<nv;k++)
+        gemv('N',n,n,alpha<T>(),A.data(),n,x.data(),1,beta<T>(),&y1[k*n],1);
+    report<T>("async many",error(y,y1));
+}
+
+//  The dag checks queue all the operations on one graph before waiting, so
+//  the trsm and trmm start on tiles of the gemm result as they are done.
+
+template <typename T, typename GEMM, typename TRSM, typename TRMM, typename SYRK, typename SYR2K>
+void check_dag(GEMM gemm, TRSM trsm, TRMM trmm, SYRK syrk, SYR2K syr2k)
+{
+    const size_t n=2*tblas::tile_order<T>()+37;
+    operands<T> o(n),o1(n);
+    tblas::task_graph g;
+    tblas::gemm(g,'N','T',n,n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.C.data(),n);
+    tblas::trsm(g,'L','L','N','N',n,n,alpha<T>(),o.L.data(),n,o.C.data(),n);
+    tblas::trmm(g,'R','U','T','N',n,n,alpha<T>(),o.L.data(),n,o.C.data(),n);
+    tblas::syrk(g,'U','N',n,n,alpha<T>(),o.A.data(),n,beta<T>(),o.D.data(),n);
+    tblas::syr2k(g,'L','T',n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.E.data(),n);
+    g.wait();
+    legacy_sequence(o1,gemm,trsm,trmm,syrk,syr2k);
+    report<T>("dag",o.error(o1));
+}
+
+//  gemm, then a gemm reading the result through a view a few rows and
+//  columns in and a trsm writing another such view, whose tiles do not
+//  line up with those of the first gemm or with each other.
+
+template <typename T, typename GEMM, typename TRSM>
+void check_dag_overlap(GEMM gemm, TRSM trsm)
+{
+    const size_t n=2*tblas::tile_order<T>()+37;
+    operands<T> o(n),o1(n);
+    tblas::task_graph g;
+    tblas::gemm(g,'N','T',n,n,n,alpha<T>(),o.A.data(),n,o.B.data(),n,beta<T>(),o.C.data(),n);
+    tblas::gemm(g,'N','N',n-5,n,n-3,alpha<T>(),o.C.data()+5+3*n,n,o.B.data(),n,beta<T>(),o.D.data(),n);
+    tblas::trsm(g,'L','L','N','N',n-7,n-7,alpha<T>(),o.L.data(),n,o.C.data()+7+7*n,n);
+    g.wait();
+    gemm('N','T',n,n,n,alpha<T>(),o1.A.data(),n,o1.B.data(),n,beta<T>(),o1.C.data(),n);
+    gemm('N','N',n-5,n,n-3,alpha<T>(),o1.C.data()+5+3*n,n,o1.B.data(),n,beta<T>(),o1.D.data(),n);
+    trsm('L','L','N','N',n-7,n-7,alpha<T>(),o1.L.data(),n,o1.C.data()+7+7*n,n);
+    report<T>("dag overlap",o.error(o1));
+}
+
+template <typename T, typename HERK>
+void check_dag_hermitian(HERK herk)
+{
+    typedef typename real_part<T>::type R;
+    const size_t n=2*tblas::tile_order<T>()+37;
+    operands<T> o(n),o1(n);
+    tblas::task_graph g;
+    tblas::herk(g,'U','C',n,n,R(0.5),o.A.data(),n,R(0.25),o.D.data(),n);
+    tblas::herk(g,'L','N',n,n,R(0.5),o.B.data(),n,R(0.25),o.E.data(),n);
+    g.wait();
+    herk('U','C',n,n,R(0.5),o1.A.data(),n,R(0.25),o1.D.data(),n);
+    herk('L','N',n,n,R(0.5),o1.B.data(),n,R(0.25),o1.E.data(),n);
+    report<T>("dag herk",o.error(o1));
+}
+
+int main(int argc, char **argv)
+{
+    typedef complex<float> C;
+    typedef complex<double> Z;
+
+    std::printf("%-14s %10s\n","routine","error");
+
+    check_axpydot<float>("axpydot",false,saxpy_,sdot_);
+    check_axpydot<double>("axpydot",false,daxpy_,ddot_);
+    check_axpydot<C>("axpydot",false,caxpy_,cdotu);
+    check_axpydot<Z>("axpydot",false,zaxpy_,zdotu);
+    check_axpydot<C>("axpydotc",true,caxpy_,cdotc);
+    check_axpydot<Z>("axpydotc",true,zaxpy_,zdotc);
+
+    check_waxpby<float>(scopy_,sscal_,saxpy_);
+    check_waxpby<double>(dcopy_,dscal_,daxpy_);
+    check_waxpby<C>(ccopy_,cscal_,caxpy_);
+    check_waxpby<Z>(zcopy_,zscal_,zaxpy_);
+
+    check_axpy2<float>(saxpy_);
+    check_axpy2<double>(daxpy_);
+    check_axpy2<C>(caxpy_);
+    check_axpy2<Z>(zaxpy_);
+
+    check_scalcopy<float>("scalcopy",alpha<float>(),scopy_,sscal_);
+    check_scalcopy<double>("scalcopy",alpha<double>(),dcopy_,dscal_);
+    check_scalcopy<C>("scalcopy",alpha<C>(),ccopy_,cscal_);
+    check_scalcopy<Z>("scalcopy",alpha<Z>(),zcopy_,zscal_);
+    check_scalcopy<C>("scalcopy real",0.75f,ccopy_,csscal_);
+    check_scalcopy<Z>("scalcopy real",0.75,zcopy_,zdscal_);
+
+    check_update_general<float>(sger_,sger_);
+    check_update_general<double>(dger_,dger_);
+    check_update_general<C>(cgeru_,cgerc_);
+    check_update_general<Z>(zgeru_,zgerc_);
+    check_update_triangle<float>(false,ssyr_,ssyr2_);
+    check_update_triangle<double>(false,dsyr_,dsyr2_);
+    check_update_triangle<C>(true,cher_,cher2_);
+    check_update_triangle<Z>(true,zher_,zher2_);
+
+    check_rfp<float>();
+    check_rfp<double>();
+    check_rfp<C>();
+    check_rfp<Z>();
+    check_sfrk<float>("sfrk",ssyrk_);
+    check_sfrk<double>("sfrk",dsyrk_);
+    check_sfrk<C>("hfrk",cherk_);
+    check_sfrk<Z>("hfrk",zherk_);
+    check_tfsm<float>(strsm_);
+    check_tfsm<double>(dtrsm_);
+    check_tfsm<C>(ctrsm_);
+    check_tfsm<Z>(ztrsm_);
+    check_sfmv<float>("sfmv",ssymv_);
+    check_sfmv<double>("sfmv",dsymv_);
+    check_sfmv<C>("hfmv",chemv_);
+    check_sfmv<Z>("hfmv",zhemv_);
+
+    check_tbsm<float>(sscal_,stbsv_);
+    check_tbsm<double>(dscal_,dtbsv_);
+    check_tbsm<C>(cscal_,ctbsv_);
+    check_tbsm<Z>(zscal_,ztbsv_);
+    check_gbmm<float>(sgbmv_);
+    check_gbmm<double>(dgbmv_);
+    check_gbmm<C>(cgbmv_);
+    check_gbmm<Z>(zgbmv_);
+    check_sbmm<float>("sbmm",false,ssymm_);
+    check_sbmm<double>("sbmm",false,dsymm_);
+    check_sbmm<C>("sbmm",false,csymm_);
+    check_sbmm<Z>("sbmm",false,zsymm_);
+    check_sbmm<C>("hbmm",true,chemm_);
+    check_sbmm<Z>("hbmm",true,zhemm_);
+
+    check_multi<float>("trsv_multi",true,strsv_);
+    check_multi<double>("trsv_multi",true,dtrsv_);
+    check_multi<C>("trsv_multi",true,ctrsv_);
+    check_multi<Z>("trsv_multi",true,ztrsv_);
+    check_multi<float>("trmv_multi",false,strmv_);
+    check_multi<double>("trmv_multi",false,dtrmv_);
+    check_multi<C>("trmv_multi",false,ctrmv_);
+    check_multi<Z>("trmv_multi",false,ztrmv_);
+
+    check_rot_sequence<float>(srot_);
+    check_rot_sequence<double>(drot_);
+    check_rot_sequence<C>(csrot_);
+    check_rot_sequence<Z>(zdrot_);
+    check_rotg_batch<float>(srotg_);
+    check_rotg_batch<double>(drotg_);
+    check_rotg_batch<C>(crotg_);
+    check_rotg_batch<Z>(zrotg_);
+    check_rotmg_batch<float>(srotmg_);
+    check_rotmg_batch<double>(drotmg_);
+
+    check_async<float>(sgemm_,sgemv_,strsm_,strmm_,ssymm_,ssyrk_,ssyr2k_);
+    check_async<double>(dgemm_,dgemv_,dtrsm_,dtrmm_,dsymm_,dsyrk_,dsyr2k_);
+    check_async<C>(cgemm_,cgemv_,ctrsm_,ctrmm_,csymm_,csyrk_,csyr2k_);
+    check_async<Z>(zgemm_,zgemv_,ztrsm_,ztrmm_,zsymm_,zsyrk_,zsyr2k_);
+    check_async_hermitian<C>(chemm_,cherk_,cher2k_);
+    check_async_hermitian<Z>(zhemm_,zherk_,zher2k_);
+    check_async_many<float>(sgemv_);
+    check_async_many<double>(dgemv_);
+    check_async_many<C>(cgemv_);
+    check_async_many<Z>(zgemv_);
+
+    check_dag<float>(sgemm_,strsm_,strmm_,ssyrk_,ssyr2k_);
+    check_dag<double>(dgemm_,dtrsm_,dtrmm_,dsyrk_,dsyr2k_);
+    check_dag<C>(cgemm_,ctrsm_,ctrmm_,csyrk_,csyr2k_);
+    check_dag<Z>(zgemm_,ztrsm_,ztrmm_,zsyrk_,zsyr2k_);
+    check_dag_overlap<float>(sgemm_,strsm_);
+    check_dag_overlap<double>(dgemm_,dtrsm_);
+    check_dag_overlap<C>(cgemm_,ctrsm_);
+    check_dag_overlap<Z>(zgemm_,ztrsm_);
+    check_dag_hermitian<C>(cherk_);
+    check_dag_hermitian<Z>(zherk_);
+
+    std::printf("%d failures\n",failures);
+    return (failures==0)?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,943 @@
+//
+//  stress.cpp
+//
+//  Purpose
+//  =======
+//
+//  Calls every routine of the legacy interface concurrently from many
+//  threads, each with a context of its own, and checks the results.  Each
+//  routine is run once on the main thread, serially, for a reference; the
+//  threads then run all the routines, starting at different ones, with
+//  the same operands, and compare their results with the reference to a
+//  tolerance of the precision.  The contexts of the threads differ in the
+//  thread cap, the deterministic reductions, the error handler and the
+//  counters, and each thread also makes illegal calls, which are checked
+//  against the error counters and the handler.  Setting TBLAS_NUM_THREADS
+//  above 1 makes the larger operations share the pool.
+//
+//  Usage
+//  =====
+//
+//      tblas-stress [threads] [rounds]
+//
+//  threads number of calling threads, default 64
+//  rounds  number of times each thread runs every routine, default 2
+//
+
+#include "blas.h"
+#include "context.h"
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using std::complex;
+using std::vector;
+
+//  Results of a routine as a list of reals, complex values split in two.
+
+typedef vector<double> result;
+
+struct test
+{
+    const char *name;
+    double tolerance;
+    std::function<result()> run;
+};
+
+const int n1=3000;          // length of the Level-1 vectors
+const int n2=83;            // order of the Level-2 matrices
+const int n3=37;            // order of the Level-3 matrices
+const int nb=5;             // bandwidth of the band matrices
+const int nbig=256;         // order of the Level-3 cases that can use the pool
+
+template <typename T>
+struct real_part
+{
+    typedef T type;
+};
+
+template <typename T>
+struct real_part<complex<T> >
+{
+    typedef T type;
+};
+
+template <typename T>
+struct make
+{
+    static T value(double re, double im)
+    {
+        return T(re);
+    }
+};
+
+template <typename T>
+struct make<complex<T> >
+{
+    static complex<T> value(double re, double im)
+    {
+        return complex<T>(re,im);
+    }
+};
+
+template <typename T>
+double tolerance()
+{
+    return (sizeof(typename real_part<T>::type)==sizeof(float))?1e-3:1e-9;
+}
+
+template <typename T>
+T alpha()
+{
+    return make<T>::value(0.5,0.25);
+}
+
+template <typename T>
+T beta()
+{
+    return make<T>::value(0.25,-0.5);
+}
+
+template <typename T>
+void fill(vector<T> &a, int seed)
+{
+    for(size_t i=0;i<a.size();i++)
+        a[i]=make<T>::value(((i*7919+seed*104729)%2003)/2003.0-0.5,((i*6007+seed*7177)%1999)/1999.0-0.5);
+}
+
+//  Scales the elements of a to at most 0.5/n and sets the diagonal
+//  elements a[first+k*step], k=0..n-1, to 2, so that triangular solves
+//  with a are well conditioned.
+
+template <typename T>
+void dominant(vector<T> &a, int n, int scale, size_t first, size_t step)
+{
+    for(size_t i=0;i<a.size();i++)
+        a[i]*=typename real_part<T>::type(1.0/scale);
+    for(int k=0;k<n;k++)
+        a[first+k*step]=make<T>::value(2.0,0.0);
+}
+
+//  Diagonal of a packed triangular matrix of order n.
+
+template <typename T>
+void dominant_packed(vector<T> &a, int n, char uplo)
+{
+    for(size_t i=0;i<a.size();i++)
+        a[i]*=typename real_part<T>::type(1.0/n);
+    for(int j=0;j<n;j++)
+        a[(uplo=='U')?j*(j+1)/2+j:j*n-j*(j-1)/2]=make<T>::value(2.0,0.0);
+}
+
+void put(result &r, float a) { r.push_back(a); }
+void put(result &r, double a) { r.push_back(a); }
+void put(result &r, complex<float> a) { r.push_back(a.real()); r.push_back(a.imag()); }
+void put(result &r, complex<double> a) { r.push_back(a.real()); r.push_back(a.imag()); }
+
+template <typename T>
+void put(result &r, const vector<T> &a)
+{
+    for(size_t i=0;i<a.size();i++)
+        put(r,a[i]);
+}
+
+//  The complex dot products return their value through the first argument
+//  when built with the Intel compiler.
+
+#ifdef __INTEL_COMPILER
+complex<float> cdotc(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { complex<float> d; cdotc_(d,n,x,incx,y,incy); return d; }
+complex<float> cdotu(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { complex<float> d; cdotu_(d,n,x,incx,y,incy); return d; }
+complex<double> zdotc(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { complex<double> d; zdotc_(d,n,x,incx,y,incy); return d; }
+complex<double> zdotu(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { complex<double> d; zdotu_(d,n,x,incx,y,incy); return d; }
+#else
+complex<float> cdotc(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { return cdotc_(n,x,incx,y,incy); }
+complex<float> cdotu(const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy) { return cdotu_(n,x,incx,y,incy); }
+complex<double> zdotc(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { return zdotc_(n,x,incx,y,incy); }
+complex<double> zdotu(const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy) { return zdotu_(n,x,incx,y,incy); }
+#endif
+
+//  Level 1
+
+template <typename T, typename F>
+result axpy_case(F f)
+{
+    vector<T> x(n1),y(n1);
+    fill(x,1);
+    fill(y,2);
+    f(n1,alpha<T>(),x.data(),1,y.data(),1);
+    f(n1/3,alpha<T>(),x.data(),3,y.data(),-2);
+    result r;
+    put(r,y);
+    return r;
+}
+
+template <typename T, typename F>
+result copy_case(F f)
+{
+    vector<T> x(n1),y(n1);
+    fill(x,1);
+    fill(y,2);
+    f(n1/2,x.data(),1,y.data(),2);
+    f(n1/3,x.data(),-3,y.data()+1,1);
+    result r;
+    put(r,y);
+    return r;
+}
+
+template <typename T, typename F>
+result swap_case(F f)
+{
+    vector<T> x(n1),y(n1);
+    fill(x,1);
+    fill(y,2);
+    f(n1,x.data(),1,y.data(),1);
+    f(n1/3,x.data(),3,y.data(),-2);
+    result r;
+    put(r,x);
+    put(r,y);
+    return r;
+}
+
+template <typename T, typename S, typename F>
+result scal_case(F f, S a)
+{
+    vector<T> x(n1);
+    fill(x,1);
+    f(n1,a,x.data(),1);
+    f(n1/3,a,x.data()+1,3);
+    result r;
+    put(r,x);
+    return r;
+}
+
+template <typename T, typename S, typename F>
+result rot_case(F f)
+{
+    vector<T> x(n1),y(n1);
+    fill(x,1);
+    fill(y,2);
+    f(n1,x.data(),1,y.data(),1,S(0.6),S(0.8));
+    f(n1/3,x.data(),3,y.data(),-2,S(0.28),S(-0.96));
+    result r;
+    put(r,x);
+    put(r,y);
+    return r;
+}
+
+template <typename T, typename F>
+result dot_case(F f)
+{
+    vector<T> x(n1),y(n1);
+    fill(x,1);
+    fill(y,2);
+    result r;
+    put(r,f(n1,x.data(),1,y.data(),1));
+    put(r,f(n1/3,x.data(),3,y.data(),-2));
+    return r;
+}
+
+template <typename T, typename F>
+result norm_case(F f)
+{
+    vector<T> x(n1);
+    fill(x,1);
+    result r;
+    put(r,f(n1,x.data(),1));
+    put(r,f(n1/3,x.data(),3));
+    return r;
+}
+
+template <typename T, typename F>
+result amax_case(F f)
+{
+    vector<T> x(n1);
+    fill(x,1);
+    result r;
+    put(r,double(f(n1,x.data(),1)));
+    put(r,double(f(n1/3,x.data(),3)));
+    return r;
+}
+
+template <typename T, typename F>
+result rotg_case(F f)
+{
+    const T a[]={3.0,0.0,-2.5,1e-3,7.0};
+    const T b[]={4.0,2.0,1.5,-5.0,0.0};
+    result r;
+    for(int i=0;i<5;i++)
+    {
+        T u=a[i],v=b[i],c,s;
+        f(u,v,c,s);
+        put(r,u);
+        put(r,v);
+        put(r,c);
+        put(r,s);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result crotg_case(F f)
+{
+    typedef typename real_part<T>::type R;
+    const T a[]={T(3.0,1.0),T(0.0,0.0),T(-2.5,0.5),T(1e-3,-2.0)};
+    const T b[]={T(4.0,-1.0),T(2.0,2.0),T(0.0,0.0),T(-5.0,0.25)};
+    result r;
+    for(int i=0;i<4;i++)
+    {
+        T u=a[i],s;
+        R c;
+        f(u,b[i],c,s);
+        put(r,u);
+        put(r,c);
+        put(r,s);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result rotmg_case(F f)
+{
+    const T d1[]={1.0,2.0,0.5,4.0,1e-4};
+    const T d2[]={1.0,0.5,3.0,-1.0,2e4};
+    const T x1[]={1.0,2.0,-0.5,1.0,3.0};
+    const T y1[]={2.0,0.25,1.5,1.0,1e-2};
+    result r;
+    for(int i=0;i<5;i++)
+    {
+        T a=d1[i],b=d2[i],x=x1[i],y=y1[i],param[5]={0.0,0.0,0.0,0.0,0.0};
+        f(a,b,x,y,param);
+        put(r,a);
+        put(r,b);
+        put(r,x);
+        for(int k=0;k<5;k++)
+            put(r,param[k]);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result rotm_case(F f)
+{
+    vector<T> x(n1),y(n1);
+    fill(x,1);
+    fill(y,2);
+    for(int flag=-2;flag<=1;flag++)
+    {
+        T param[5]={T(flag),T(0.75),T(-0.5),T(0.25),T(1.25)};
+        f(n1,x.data(),1,y.data(),1,param);
+        f(n1/3,x.data(),3,y.data(),-2,param);
+    }
+    result r;
+    put(r,x);
+    put(r,y);
+    return r;
+}
+
+//  Level 2
+
+template <typename T, typename F>
+result gemv_case(F f)
+{
+    const int m=n2+7;
+    vector<T> A(m*n2),x(m),y(m);
+    fill(A,1);
+    fill(x,2);
+    result r;
+    for(const char *trans="NTC";*trans;trans++)
+    {
+        fill(y,3);
+        f(*trans,m,n2,alpha<T>(),A.data(),m,x.data(),1,beta<T>(),y.data(),1);
+        f(*trans,m/2,n2/2,alpha<T>(),A.data(),m,x.data(),2,beta<T>(),y.data(),-1);
+        put(r,y);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result gbmv_case(F f)
+{
+    const int m=n2+7,kl=nb-2,ku=nb;
+    const int ldA=kl+ku+1;
+    vector<T> A(ldA*n2),x(m),y(m);
+    fill(A,1);
+    fill(x,2);
+    result r;
+    for(const char *trans="NTC";*trans;trans++)
+    {
+        fill(y,3);
+        f(*trans,m,n2,kl,ku,alpha<T>(),A.data(),ldA,x.data(),1,beta<T>(),y.data(),1);
+        f(*trans,m/2,n2/2,kl,ku,alpha<T>(),A.data(),ldA,x.data(),2,beta<T>(),y.data(),-1);
+        put(r,y);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result symv_case(F f)
+{
+    vector<T> A(n2*n2),x(n2),y(n2);
+    fill(A,1);
+    fill(x,2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(y,3);
+        f(*uplo,n2,alpha<T>(),A.data(),n2,x.data(),1,beta<T>(),y.data(),1);
+        f(*uplo,n2/2,alpha<T>(),A.data(),n2,x.data(),2,beta<T>(),y.data(),-1);
+        put(r,y);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result sbmv_case(F f)
+{
+    const int ldA=nb+1;
+    vector<T> A(ldA*n2),x(n2),y(n2);
+    fill(A,1);
+    fill(x,2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(y,3);
+        f(*uplo,n2,nb,alpha<T>(),A.data(),ldA,x.data(),1,beta<T>(),y.data(),1);
+        f(*uplo,n2/2,nb,alpha<T>(),A.data(),ldA,x.data(),2,beta<T>(),y.data(),-1);
+        put(r,y);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result spmv_case(F f)
+{
+    vector<T> A(n2*(n2+1)/2),x(n2),y(n2);
+    fill(A,1);
+    fill(x,2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(y,3);
+        f(*uplo,n2,alpha<T>(),A.data(),x.data(),1,beta<T>(),y.data(),1);
+        f(*uplo,n2/2,alpha<T>(),A.data(),x.data(),2,beta<T>(),y.data(),-1);
+        put(r,y);
+    }
+    return r;
+}
+
+//  trmv and trsv; the matrix is made well conditioned for the solves.
+
+template <typename T, typename F>
+result trmv_case(F f)
+{
+    vector<T> A(n2*n2),x(2*n2);
+    fill(A,1);
+    dominant(A,n2,n2,0,n2+1);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+        for(const char *trans="NTC";*trans;trans++)
+            for(const char *diag="NU";*diag;diag++)
+            {
+                fill(x,2);
+                f(*uplo,*trans,*diag,n2,A.data(),n2,x.data(),1);
+                f(*uplo,*trans,*diag,n2/2,A.data(),n2,x.data(),-3);
+                put(r,x);
+            }
+    return r;
+}
+
+template <typename T, typename F>
+result tbmv_case(F f)
+{
+    const int ldA=nb+1;
+    vector<T> A(ldA*n2),x(2*n2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(A,1);
+        dominant(A,n2,nb+1,(*uplo=='U')?nb:0,ldA);
+        for(const char *trans="NTC";*trans;trans++)
+            for(const char *diag="NU";*diag;diag++)
+            {
+                fill(x,2);
+                f(*uplo,*trans,*diag,n2,nb,A.data(),ldA,x.data(),1);
+                f(*uplo,*trans,*diag,n2/2,nb,A.data(),ldA,x.data(),-3);
+                put(r,x);
+            }
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result tpmv_case(F f)
+{
+    vector<T> A(n2*(n2+1)/2),x(2*n2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(A,1);
+        dominant_packed(A,n2,*uplo);
+        for(const char *trans="NTC";*trans;trans++)
+            for(const char *diag="NU";*diag;diag++)
+            {
+                fill(x,2);
+                f(*uplo,*trans,*diag,n2,A.data(),x.data(),1);
+                f(*uplo,*trans,*diag,n2,A.data(),x.data(),-2);
+                put(r,x);
+            }
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result ger_case(F f)
+{
+    const int m=n2+7;
+    vector<T> A(m*n2),x(m),y(n2);
+    fill(A,1);
+    fill(x,2);
+    fill(y,3);
+    f(m,n2,alpha<T>(),x.data(),1,y.data(),1,A.data(),m);
+    f(m/2,n2/3,alpha<T>(),x.data(),2,y.data(),-3,A.data(),m);
+    result r;
+    put(r,A);
+    return r;
+}
+
+template <typename T, typename S, typename F>
+result syr_case(F f)
+{
+    vector<T> A(n2*n2),x(2*n2);
+    fill(x,2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(A,1);
+        f(*uplo,n2,S(0.75),x.data(),1,A.data(),n2);
+        f(*uplo,n2/2,S(-0.5),x.data(),-3,A.data(),n2);
+        put(r,A);
+    }
+    return r;
+}
+
+template <typename T, typename S, typename F>
+result spr_case(F f)
+{
+    vector<T> A(n2*(n2+1)/2),x(2*n2);
+    fill(x,2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(A,1);
+        f(*uplo,n2,S(0.75),x.data(),1,A.data());
+        f(*uplo,n2,S(-0.5),x.data(),-2,A.data());
+        put(r,A);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result syr2_case(F f)
+{
+    vector<T> A(n2*n2),x(2*n2),y(2*n2);
+    fill(x,2);
+    fill(y,3);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(A,1);
+        f(*uplo,n2,alpha<T>(),x.data(),1,y.data(),1,A.data(),n2);
+        f(*uplo,n2/2,alpha<T>(),x.data(),-3,y.data(),2,A.data(),n2);
+        put(r,A);
+    }
+    return r;
+}
+
+template <typename T, typename F>
+result spr2_case(F f)
+{
+    vector<T> A(n2*(n2+1)/2),x(2*n2),y(2*n2);
+    fill(x,2);
+    fill(y,3);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+    {
+        fill(A,1);
+        f(*uplo,n2,alpha<T>(),x.data(),1,y.data(),1,A.data());
+        f(*uplo,n2,alpha<T>(),x.data(),-2,y.data(),2,A.data());
+        put(r,A);
+    }
+    return r;
+}
+
+//  Level 3
+
+template <typename T, typename F>
+result gemm_case(F f, int n, const char *transA, const char *transB)
+{
+    const int m=n+5,k=n-3;
+    vector<T> A(m*m),B(m*m),C(m*n);
+    fill(A,1);
+    fill(B,2);
+    result r;
+    for(const char *ta=transA;*ta;ta++)
+        for(const char *tb=transB;*tb;tb++)
+        {
+            fill(C,3);
+            f(*ta,*tb,m,n,k,alpha<T>(),A.data(),m,B.data(),m,beta<T>(),C.data(),m);
+            put(r,C);
+        }
+    return r;
+}
+
+template <typename T, typename F>
+result symm_case(F f)
+{
+    const int m=n3+5;
+    vector<T> A(m*m),B(m*n3),C(m*n3);
+    fill(A,1);
+    fill(B,2);
+    result r;
+    for(const char *side="LR";*side;side++)
+        for(const char *uplo="UL";*uplo;uplo++)
+        {
+            const int na=(*side=='L')?m:n3;
+            fill(C,3);
+            f(*side,*uplo,m,n3,alpha<T>(),A.data(),na,B.data(),m,beta<T>(),C.data(),m);
+            put(r,C);
+        }
+    return r;
+}
+
+template <typename T, typename S, typename F>
+result syrk_case(F f, S a, S b, const char *transes)
+{
+    const int k=n3+4;
+    vector<T> A(k*k),C(n3*n3);
+    fill(A,1);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+        for(const char *trans=transes;*trans;trans++)
+        {
+            fill(C,3);
+            f(*uplo,*trans,n3,k,a,A.data(),k,b,C.data(),n3);
+            put(r,C);
+        }
+    return r;
+}
+
+template <typename T, typename S, typename F>
+result syr2k_case(F f, S b, const char *transes)
+{
+    const int k=n3+4;
+    vector<T> A(k*k),B(k*k),C(n3*n3);
+    fill(A,1);
+    fill(B,2);
+    result r;
+    for(const char *uplo="UL";*uplo;uplo++)
+        for(const char *trans=transes;*trans;trans++)
+        {
+            fill(C,3);
+            f(*uplo,*trans,n3,k,alpha<T>(),A.data(),k,B.data(),k,b,C.data(),n3);
+            put(r,C);
+        }
+    return r;
+}
+
+//  trmm and trsm; the matrix is made well conditioned for the solves.
+
+template <typename T, typename F>
+result trmm_case(F f, int n, const char *sides, const char *uplos, const char *transes, const char *diags)
+{
+    const int m=n+5;
+    vector<T> A(m*m),B(m*n);
+    fill(A,1);
+    dominant(A,m,m,0,m+1);
+    result r;
+    for(const char *side=sides;*side;side++)
+        for(const char *uplo=uplos;*uplo;uplo++)
+            for(const char *trans=transes;*trans;trans++)
+                for(const char *diag=diags;*diag;diag++)
+                {
+                    fill(B,2);
+                    f(*side,*uplo,*trans,*diag,m,n,alpha<T>(),A.data(),m,B.data(),m);
+                    put(r,B);
+                }
+    return r;
+}
+
+//  Threads calling the library and the illegal calls they make.
+
+std::atomic<size_t> handled(0);
+
+void handler(const char *name, int info)
+{
+    handled++;
+}
+
+void illegal_calls()
+{
+    double a=0.0;
+    dgemm_('X','N',1,1,1,1.0,&a,1,&a,1,0.0,&a,1);
+    xerbla_("STRESS",1);
+}
+
+template <typename T>
+void add(vector<test> &tests, const char *name, std::function<result()> run)
+{
+    test t={name,tolerance<T>(),run};
+    tests.push_back(t);
+}
+
+vector<test> all_tests()
+{
+    typedef complex<float> C;
+    typedef complex<double> Z;
+    vector<test> t;
+
+    add<float>(t,"saxpy",[]{ return axpy_case<float>(saxpy_); });
+    add<double>(t,"daxpy",[]{ return axpy_case<double>(daxpy_); });
+    add<C>(t,"caxpy",[]{ return axpy_case<C>(caxpy_); });
+    add<Z>(t,"zaxpy",[]{ return axpy_case<Z>(zaxpy_); });
+    add<float>(t,"scopy",[]{ return copy_case<float>(scopy_); });
+    add<double>(t,"dcopy",[]{ return copy_case<double>(dcopy_); });
+    add<C>(t,"ccopy",[]{ return copy_case<C>(ccopy_); });
+    add<Z>(t,"zcopy",[]{ return copy_case<Z>(zcopy_); });
+    add<float>(t,"sswap",[]{ return swap_case<float>(sswap_); });
+    add<double>(t,"dswap",[]{ return swap_case<double>(dswap_); });
+    add<C>(t,"cswap",[]{ return swap_case<C>(cswap_); });
+    add<Z>(t,"zswap",[]{ return swap_case<Z>(zswap_); });
+    add<float>(t,"sscal",[]{ return scal_case<float>(sscal_,alpha<float>()); });
+    add<double>(t,"dscal",[]{ return scal_case<double>(dscal_,alpha<double>()); });
+    add<C>(t,"cscal",[]{ return scal_case<C>(cscal_,alpha<C>()); });
+    add<Z>(t,"zscal",[]{ return scal_case<Z>(zscal_,alpha<Z>()); });
+    add<C>(t,"csscal",[]{ return scal_case<C>(csscal_,0.75f); });
+    add<Z>(t,"zdscal",[]{ return scal_case<Z>(zdscal_,0.75); });
+    add<float>(t,"srot",[]{ return rot_case<float,float>(srot_); });
+    add<double>(t,"drot",[]{ return rot_case<double,double>(drot_); });
+    add<C>(t,"csrot",[]{ return rot_case<C,float>(csrot_); });
+    add<Z>(t,"zdrot",[]{ return rot_case<Z,double>(zdrot_); });
+    add<float>(t,"sdot",[]{ return dot_case<float>(sdot_); });
+    add<double>(t,"ddot",[]{ return dot_case<double>(ddot_); });
+    add<C>(t,"cdotc",[]{ return dot_case<C>(cdotc); });
+    add<C>(t,"cdotu",[]{ return dot_case<C>(cdotu); });
+    add<Z>(t,"zdotc",[]{ return dot_case<Z>(zdotc); });
+    add<Z>(t,"zdotu",[]{ return dot_case<Z>(zdotu); });
+    add<float>(t,"sdsdot",[]{ return dot_case<float>([](int n, float *x, int incx, float *y, int incy) { return sdsdot_(n,0.125f,x,incx,y,incy); }); });
+    add<double>(t,"dsdot",[]{ return dot_case<float>(dsdot_); });
+    add<float>(t,"sasum",[]{ return norm_case<float>(sasum_); });
+    add<double>(t,"dasum",[]{ return norm_case<double>(dasum_); });
+    add<C>(t,"scasum",[]{ return norm_case<C>(scasum_); });
+    add<Z>(t,"dzasum",[]{ return norm_case<Z>(dzasum_); });
+    add<float>(t,"snrm2",[]{ return norm_case<float>(snrm2_); });
+    add<double>(t,"dnrm2",[]{ return norm_case<double>(dnrm2_); });
+    add<C>(t,"scnrm2",[]{ return norm_case<C>(scnrm2_); });
+    add<Z>(t,"dznrm2",[]{ return norm_case<Z>(dznrm2_); });
+    add<float>(t,"isamax",[]{ return amax_case<float>(isamax_); });
+    add<double>(t,"idamax",[]{ return amax_case<double>(idamax_); });
+    add<C>(t,"icamax",[]{ return amax_case<C>(icamax_); });
+    add<Z>(t,"izamax",[]{ return amax_case<Z>(izamax_); });
+    add<float>(t,"srotg",[]{ return rotg_case<float>(srotg_); });
+    add<double>(t,"drotg",[]{ return rotg_case<double>(drotg_); });
+    add<C>(t,"crotg",[]{ return crotg_case<C>(crotg_); });
+    add<Z>(t,"zrotg",[]{ return crotg_case<Z>(zrotg_); });
+    add<float>(t,"srotmg",[]{ return rotmg_case<float>(srotmg_); });
+    add<double>(t,"drotmg",[]{ return rotmg_case<double>(drotmg_); });
+    add<float>(t,"srotm",[]{ return rotm_case<float>(srotm_); });
+    add<double>(t,"drotm",[]{ return rotm_case<double>(drotm_); });
+
+    add<float>(t,"sgemv",[]{ return gemv_case<float>(sgemv_); });
+    add<double>(t,"dgemv",[]{ return gemv_case<double>(dgemv_); });
+    add<C>(t,"cgemv",[]{ return gemv_case<C>(cgemv_); });
+    add<Z>(t,"zgemv",[]{ return gemv_case<Z>(zgemv_); });
+    add<float>(t,"sgbmv",[]{ return gbmv_case<float>(sgbmv_); });
+    add<double>(t,"dgbmv",[]{ return gbmv_case<double>(dgbmv_); });
+    add<C>(t,"cgbmv",[]{ return gbmv_case<C>(cgbmv_); });
+    add<Z>(t,"zgbmv",[]{ return gbmv_case<Z>(zgbmv_); });
+    add<float>(t,"ssymv",[]{ return symv_case<float>(ssymv_); });
+    add<double>(t,"dsymv",[]{ return symv_case<double>(dsymv_); });
+    add<C>(t,"chemv",[]{ return symv_case<C>(chemv_); });
+    add<Z>(t,"zhemv",[]{ return symv_case<Z>(zhemv_); });
+    add<float>(t,"ssbmv",[]{ return sbmv_case<float>(ssbmv_); });
+    add<double>(t,"dsbmv",[]{ return sbmv_case<double>(dsbmv_); });
+    add<C>(t,"chbmv",[]{ return sbmv_case<C>(chbmv_); });
+    add<Z>(t,"zhbmv",[]{ return sbmv_case<Z>(zhbmv_); });
+    add<float>(t,"sspmv",[]{ return spmv_case<float>(sspmv_); });
+    add<double>(t,"dspmv",[]{ return spmv_case<double>(dspmv_); });
+    add<C>(t,"chpmv",[]{ return spmv_case<C>(chpmv_); });
+    add<Z>(t,"zhpmv",[]{ return spmv_case<Z>(zhpmv_); });
+    add<float>(t,"strmv",[]{ return trmv_case<float>(strmv_); });
+    add<double>(t,"dtrmv",[]{ return trmv_case<double>(dtrmv_); });
+    add<C>(t,"ctrmv",[]{ return trmv_case<C>(ctrmv_); });
+    add<Z>(t,"ztrmv",[]{ return trmv_case<Z>(ztrmv_); });
+    add<float>(t,"stbmv",[]{ return tbmv_case<float>(stbmv_); });
+    add<double>(t,"dtbmv",[]{ return tbmv_case<double>(dtbmv_); });
+    add<C>(t,"ctbmv",[]{ return tbmv_case<C>(ctbmv_); });
+    add<Z>(t,"ztbmv",[]{ return tbmv_case<Z>(ztbmv_); });
+    add<float>(t,"stpmv",[]{ return tpmv_case<float>(stpmv_); });
+    add<double>(t,"dtpmv",[]{ return tpmv_case<double>(dtpmv_); });
+    add<C>(t,"ctpmv",[]{ return tpmv_case<C>(ctpmv_); });
+    add<Z>(t,"ztpmv",[]{ return tpmv_case<Z>(ztpmv_); });
+    add<float>(t,"strsv",[]{ return trmv_case<float>(strsv_); });
+    add<double>(t,"dtrsv",[]{ return trmv_case<double>(dtrsv_); });
+    add<C>(t,"ctrsv",[]{ return trmv_case<C>(ctrsv_); });
+    add<Z>(t,"ztrsv",[]{ return trmv_case<Z>(ztrsv_); });
+    add<float>(t,"stbsv",[]{ return tbmv_case<float>(stbsv_); });
+    add<double>(t,"dtbsv",[]{ return tbmv_case<double>(dtbsv_); });
+    add<C>(t,"ctbsv",[]{ return tbmv_case<C>(ctbsv_); });
+    add<Z>(t,"ztbsv",[]{ return tbmv_case<Z>(ztbsv_); });
+    add<float>(t,"stpsv",[]{ return tpmv_case<float>(stpsv_); });
+    add<double>(t,"dtpsv",[]{ return tpmv_case<double>(dtpsv_); });
+    add<C>(t,"ctpsv",[]{ return tpmv_case<C>(ctpsv_); });
+    add<Z>(t,"ztpsv",[]{ return tpmv_case<Z>(ztpsv_); });
+    add<float>(t,"sger",[]{ return ger_case<float>(sger_); });
+    add<double>(t,"dger",[]{ return ger_case<double>(dger_); });
+    add<C>(t,"cgerc",[]{ return ger_case<C>(cgerc_); });
+    add<Z>(t,"zgerc",[]{ return ger_case<Z>(zgerc_); });
+    add<C>(t,"cgeru",[]{ return ger_case<C>(cgeru_); });
+    add<Z>(t,"zgeru",[]{ return ger_case<Z>(zgeru_); });
+    add<float>(t,"ssyr",[]{ return syr_case<float,float>(ssyr_); });
+    add<double>(t,"dsyr",[]{ return syr_case<double,double>(dsyr_); });
+    add<C>(t,"cher",[]{ return syr_case<C,float>(cher_); });
+    add<Z>(t,"zher",[]{ return syr_case<Z,double>(zher_); });
+    add<float>(t,"sspr",[]{ return spr_case<float,float>(sspr_); });
+    add<double>(t,"dspr",[]{ return spr_case<double,double>(dspr_); });
+    add<C>(t,"chpr",[]{ return spr_case<C,float>(chpr_); });
+    add<Z>(t,"zhpr",[]{ return spr_case<Z,double>(zhpr_); });
+    add<float>(t,"ssyr2",[]{ return syr2_case<float>(ssyr2_); });
+    add<double>(t,"dsyr2",[]{ return syr2_case<double>(dsyr2_); });
+    add<C>(t,"cher2",[]{ return syr2_case<C>(cher2_); });
+    add<Z>(t,"zher2",[]{ return syr2_case<Z>(zher2_); });
+    add<float>(t,"sspr2",[]{ return spr2_case<float>(sspr2_); });
+    add<double>(t,"dspr2",[]{ return spr2_case<double>(dspr2_); });
+    add<C>(t,"chpr2",[]{ return spr2_case<C>(chpr2_); });
+    add<Z>(t,"zhpr2",[]{ return spr2_case<Z>(zhpr2_); });
+
+    add<float>(t,"sgemm",[]{ return gemm_case<float>(sgemm_,n3,"NTC","NTC"); });
+    add<double>(t,"dgemm",[]{ return gemm_case<double>(dgemm_,n3,"NTC","NTC"); });
+    add<C>(t,"cgemm",[]{ return gemm_case<C>(cgemm_,n3,"NTC","NTC"); });
+    add<Z>(t,"zgemm",[]{ return gemm_case<Z>(zgemm_,n3,"NTC","NTC"); });
+    add<double>(t,"dgemm large",[]{ return gemm_case<double>(dgemm_,nbig,"N","T"); });
+    add<Z>(t,"zgemm large",[]{ return gemm_case<Z>(zgemm_,nbig,"C","N"); });
+    add<float>(t,"ssymm",[]{ return symm_case<float>(ssymm_); });
+    add<double>(t,"dsymm",[]{ return symm_case<double>(dsymm_); });
+    add<C>(t,"csymm",[]{ return symm_case<C>(csymm_); });
+    add<Z>(t,"zsymm",[]{ return symm_case<Z>(zsymm_); });
+    add<C>(t,"chemm",[]{ return symm_case<C>(chemm_); });
+    add<Z>(t,"zhemm",[]{ return symm_case<Z>(zhemm_); });
+    add<float>(t,"ssyrk",[]{ return syrk_case<float>(ssyrk_,alpha<float>(),beta<float>(),"NT"); });
+    add<double>(t,"dsyrk",[]{ return syrk_case<double>(dsyrk_,alpha<double>(),beta<double>(),"NT"); });
+    add<C>(t,"csyrk",[]{ return syrk_case<C>(csyrk_,alpha<C>(),beta<C>(),"NT"); });
+    add<Z>(t,"zsyrk",[]{ return syrk_case<Z>(zsyrk_,alpha<Z>(),beta<Z>(),"NT"); });
+    add<C>(t,"cherk",[]{ return syrk_case<C>(cherk_,0.5f,0.25f,"NC"); });
+    add<Z>(t,"zherk",[]{ return syrk_case<Z>(zherk_,0.5,0.25,"NC"); });
+    add<float>(t,"ssyr2k",[]{ return syr2k_case<float>(ssyr2k_,beta<float>(),"NT"); });
+    add<double>(t,"dsyr2k",[]{ return syr2k_case<double>(dsyr2k_,beta<double>(),"NT"); });
+    add<C>(t,"csyr2k",[]{ return syr2k_case<C>(csyr2k_,beta<C>(),"NT"); });
+    add<Z>(t,"zsyr2k",[]{ return syr2k_case<Z>(zsyr2k_,beta<Z>(),"NT"); });
+    add<C>(t,"cher2k",[]{ return syr2k_case<C>(cher2k_,0.25f,"NC"); });
+    add<Z>(t,"zher2k",[]{ return syr2k_case<Z>(zher2k_,0.25,"NC"); });
+    add<float>(t,"strmm",[]{ return trmm_case<float>(strmm_,n3,"LR","UL","NTC","NU"); });
+    add<double>(t,"dtrmm",[]{ return trmm_case<double>(dtrmm_,n3,"LR","UL","NTC","NU"); });
+    add<C>(t,"ctrmm",[]{ return trmm_case<C>(ctrmm_,n3,"LR","UL","NTC","NU"); });
+    add<Z>(t,"ztrmm",[]{ return trmm_case<Z>(ztrmm_,n3,"LR","UL","NTC","NU"); });
+    add<float>(t,"strsm",[]{ return trmm_case<float>(strsm_,n3,"LR","UL","NTC","NU"); });
+    add<double>(t,"dtrsm",[]{ return trmm_case<double>(dtrsm_,n3,"LR","UL","NTC","NU"); });
+    add<C>(t,"ctrsm",[]{ return trmm_case<C>(ctrsm_,n3,"LR","UL","NTC","NU"); });
+    add<Z>(t,"ztrsm",[]{ return trmm_case<Z>(ztrsm_,n3,"LR","UL","NTC","NU"); });
+    add<double>(t,"dtrsm large",[]{ return trmm_case<double>(dtrsm_,nbig,"L","L","N","N"); });
+    add<Z>(t,"ztrsm large",[]{ return trmm_case<Z>(ztrsm_,nbig,"R","U","C","N"); });
+    return t;
+}
+
+//  Largest difference between a and b relative to the largest element of
+//  b, or a large value if they differ in length.
+
+double error(const result &a, const result &b)
+{
+    if(a.size()!=b.size())
+        return 1e30;
+    double diff=0.0,size=1e-30;
+    for(size_t i=0;i<a.size();i++)
+    {
+        diff=std::max(diff,std::fabs(a[i]-b[i]));
+        size=std::max(size,std::fabs(b[i]));
+    }
+    return (diff==diff)?diff/size:1e30;
+}
+
+int main(int argc, char **argv)
+{
+    const int nthreads=(argc>1)?std::atoi(argv[1]):64;
+    const int rounds=(argc>2)?std::atoi(argv[2]):2;
+    const vector<test> tests=all_tests();
+
+    tblas::context serial;
+    serial.threads=1;
+    serial.errors=tblas::error_quiet;
+    vector<result> reference(tests.size());
+    {
+        tblas::context_scope scope(serial);
+        for(size_t i=0;i<tests.size();i++)
+            reference[i]=tests[i].run();
+    }
+
+    tblas::counters stats;
+    std::atomic<size_t> failures(0),counted(0),reported(0);
+    vector<std::thread> threads;
+    for(int t=0;t<nthreads;t++)
+        threads.push_back(std::thread([&,t]{
+            tblas::context c;
+            c.threads=t%4;
+            c.deterministic=(t%3==0);
+            c.errors=tblas::error_quiet;
+            c.handler=(t%2)?handler:0;
+            c.stats=(t%5==4)?0:&stats;
+            tblas::this_context()=c;
+            for(int round=0;round<rounds;round++)
+            {
+                for(size_t k=0;k<tests.size();k++)
+                {
+                    const size_t i=(k+t*7)%tests.size();
+                    const double e=error(tests[i].run(),reference[i]);
+                    if(e>tests[i].tolerance)
+                    {
+                        std::printf("thread %d: %s differs by %.2e\n",t,tests[i].name,e);
+                        failures++;
+                    }
+                }
+                illegal_calls();
+                if(c.stats)
+                    counted+=2;
+                if(c.handler)
+                    reported+=2;
+            }
+            const tblas::context &d=tblas::this_context();
+            if((d.threads!=c.threads)||(d.deterministic!=c.deterministic)||(d.errors!=c.errors)||(d.handler!=c.handler)||(d.stats!=c.stats))
+            {
+                std::printf("thread %d: context changed\n",t);
+                failures++;
+            }
+        }));
+    for(size_t t=0;t<threads.size();t++)
+        threads[t].join();
+
+    if(stats.errors!=counted)
+    {
+        std::printf("%zu errors counted, expected %zu\n",size_t(stats.errors),size_t(counted));
+        failures++;
+    }
+    if(handled!=reported)
+    {
+        std::printf("%zu errors handled, expected %zu\n",size_t(handled),size_t(reported));
+        failures++;
+    }
+    std::printf("%zu routines, %d threads, %d rounds: %zu parallel calls, %zu pool tasks, %zu graph tasks, %zu failures\n",
+        tests.size(),nthreads,rounds,size_t(stats.parallel),size_t(stats.tasks),size_t(stats.graph_tasks),size_t(failures));
+    return (failures==0)?EXIT_SUCCESS:EXIT_FAILURE;
+}
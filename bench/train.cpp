@@ -0,0 +1,121 @@
+//
+//  train.cpp
+//
+//  Purpose
+//  =======
+//
+//  Training workload for the profile-guided build of the library.  Runs a
+//  mix of GEMM, GEMV and TRSM calls through the legacy interface over all
+//  transpose, side, uplo and diag options, with sizes ranging from a few
+//  rows to a few hundred so that both the dispatch and the blocked kernels
+//  are exercised.
+//
+//  Usage
+//  =====
+//
+//      tblas-train [repeat]
+//
+//  repeat  number of passes over the workload, default 1
+//
+
+#include "blas.h"
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using std::complex;
+using std::vector;
+
+template <typename T>
+struct legacy
+{
+    typedef void (*gemm_t)(const char &, const char &, const int &, const int &, const int &, const T &, T *, const int &, T *, const int &, const T &, T *, const int &);
+    typedef void (*gemv_t)(const char &, const int &, const int &, const T &, T *, const int &, T *, const int &, const T &, T *, const int &);
+    typedef void (*trsm_t)(const char &, const char &, const char &, const char &, const int &, const int &, const T &, T *, const int &, T *, const int &);
+
+    gemm_t gemm;
+    gemv_t gemv;
+    trsm_t trsm;
+};
+
+template <typename T>
+void fill(vector<T> &a, int seed)
+{
+    for(size_t i=0;i<a.size();i++)
+        a[i]=T(((i*7919+seed*104729)%2003)/2003.0-0.5);
+}
+
+template <typename T>
+void train(const legacy<T> &blas, const char *trans)
+{
+    const int gemm_sizes[]={2,7,16,33,64,100,128,256,384};
+    const int gemv_sizes[]={3,16,100,500,1000,2000};
+    const int trsm_sizes[]={4,17,64,150,300};
+    const T alpha(0.5);
+    const T beta(0.25);
+    const T one(1.0);
+
+    for(int n:gemm_sizes)
+    {
+        vector<T> A(n*n),B(n*n),C(n*n);
+        fill(A,1);
+        fill(B,2);
+        fill(C,3);
+        for(const char *a=trans;*a;a++)
+            for(const char *b=trans;*b;b++)
+                blas.gemm(*a,*b,n,n,n,alpha,A.data(),n,B.data(),n,beta,C.data(),n);
+        blas.gemm('N','N',n,n/2+1,n,alpha,A.data(),n,B.data(),n,one,C.data(),n);
+    }
+
+    for(int n:gemv_sizes)
+    {
+        vector<T> A(n*n),x(2*n),y(2*n);
+        fill(A,4);
+        fill(x,5);
+        fill(y,6);
+        for(const char *a=trans;*a;a++)
+        {
+            blas.gemv(*a,n,n,alpha,A.data(),n,x.data(),1,beta,y.data(),1);
+            blas.gemv(*a,n,n,alpha,A.data(),n,x.data(),2,one,y.data(),2);
+        }
+    }
+
+    const char sides[]="LR";
+    const char uplos[]="UL";
+    const char diags[]="NU";
+    for(int n:trsm_sizes)
+    {
+        vector<T> A(n*n),B(n*n);
+        fill(A,7);
+        for(int i=0;i<n;i++)
+            A[i+i*n]=T(n);
+        for(const char *s=sides;*s;s++)
+            for(const char *u=uplos;*u;u++)
+                for(const char *a=trans;*a;a++)
+                    for(const char *d=diags;*d;d++)
+                    {
+                        fill(B,8);
+                        blas.trsm(*s,*u,*a,*d,n,n,alpha,A.data(),n,B.data(),n);
+                    }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int repeat=(argc>1)?std::atoi(argv[1]):1;
+
+    legacy<float> s={sgemm_,sgemv_,strsm_};
+    legacy<double> d={dgemm_,dgemv_,dtrsm_};
+    legacy<complex<float> > c={cgemm_,cgemv_,ctrsm_};
+    legacy<complex<double> > z={zgemm_,zgemv_,ztrsm_};
+
+    for(int r=0;r<repeat;r++)
+    {
+        train(s,"NT");
+        train(d,"NT");
+        train(c,"NTC");
+        train(z,"NTC");
+    }
+    return EXIT_SUCCESS;
+}
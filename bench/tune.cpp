@@ -0,0 +1,259 @@
+//
+//  tune.cpp
+//
+//  Purpose
+//  =======
+//
+//  Searches the tuning parameters of the library kernels on the current
+//  machine and writes them to the tblas profile (see tune.h).  For each
+//  precision the micro-kernel shape is chosen first, followed by kc, mc
+//  and nc, each by timing square matrix products of order size.  The
+//  Level-1 threading threshold is the smallest per-thread length at which
+//  a threaded vector update beats a serial one by 20 percent, and the
+//  Level-2 threshold likewise the smallest per-thread number of entries
+//  at which a threaded rank-1 update does.  The streaming threshold is
+//  written with its default, 8 MB of elements.
+//
+//  Usage
+//  =====
+//
+//      tblas-tune [-n size] [profile]
+//
+//  size    order of the timed products, default 512
+//
+//  profile file to write, default is the path the library reads
+//
+
+#include "gemm.h"
+#include "rank.h"
+#include "thread.h"
+#include "tune.h"
+#include <chrono>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::complex;
+using std::size_t;
+using std::vector;
+using tblas::tuning;
+
+template <typename T>
+double seconds(const tuning &b, size_t n, vector<T> &A, vector<T> &B, vector<T> &C)
+{
+    const T alpha(1.0);
+    const T beta(0.0);
+    double best=1e30;
+    for(int r=0;r<3;r++)
+    {
+        auto start=std::chrono::steady_clock::now();
+        tblas::gemm_blocked('N','N',n,n,n,alpha,A.data(),n,B.data(),n,beta,C.data(),n,b);
+        std::chrono::duration<double> t=std::chrono::steady_clock::now()-start;
+        if(t.count()<best)
+            best=t.count();
+    }
+    return best;
+}
+
+template <typename T>
+double seconds(size_t grain, vector<T> &x, vector<T> &y)
+{
+    const T alpha(0.5);
+    const T beta(0.25);
+    T *u=x.data();
+    T *v=y.data();
+    double best=1e30;
+    for(int r=0;r<5;r++)
+    {
+        auto start=std::chrono::steady_clock::now();
+        tblas::parallel_for(x.size(),grain,[=](size_t begin, size_t end)
+        {
+            for(size_t i=begin;i<end;i++)
+                v[i]=alpha*u[i]+beta*v[i];
+        });
+        std::chrono::duration<double> t=std::chrono::steady_clock::now()-start;
+        if(t.count()<best)
+            best=t.count();
+    }
+    return best;
+}
+
+template <typename T>
+double seconds(size_t grain, size_t m, vector<T> &x, vector<T> &t, vector<T> &A)
+{
+    const size_t n=t.size();
+    const T *u=x.data();
+    const T *v=t.data();
+    T *a=A.data();
+    double best=1e30;
+    for(int r=0;r<5;r++)
+    {
+        auto start=std::chrono::steady_clock::now();
+        tblas::parallel_columns(m,n,grain,[=](size_t j0, size_t j1)
+        {
+            tblas::rank1_block(m,j1-j0,u,v+j0,a+j0*m,m);
+        });
+        std::chrono::duration<double> t=std::chrono::steady_clock::now()-start;
+        if(t.count()<best)
+            best=t.count();
+    }
+    return best;
+}
+
+template <typename T>
+size_t search_l1(size_t fallback)
+{
+    const size_t p=tblas::threads();
+    if(p<2)
+        return fallback;
+    for(size_t grain=1024;grain<=(size_t(1)<<20);grain*=2)
+    {
+        vector<T> x(grain*p,T(0.5)),y(grain*p,T(0.25));
+        double serial=seconds(x.size()+1,x,y);
+        double threaded=seconds(grain,x,y);
+        if(threaded*1.2<serial)
+            return grain;
+    }
+    return size_t(1)<<20;
+}
+
+template <typename T>
+size_t search_l2(size_t fallback)
+{
+    const size_t p=tblas::threads();
+    if(p<2)
+        return fallback;
+    for(size_t grain=4096;grain<=(size_t(1)<<22);grain*=2)
+    {
+        const size_t m=64;
+        vector<T> x(m,T(0.5)),t(grain*p/m,T(0.25)),A(grain*p,T(0.0));
+        double serial=seconds(A.size()+1,m,x,t,A);
+        double threaded=seconds(grain,m,x,t,A);
+        if(threaded*1.2<serial)
+            return grain;
+    }
+    return size_t(1)<<22;
+}
+
+template <typename T>
+tuning search(size_t n)
+{
+    vector<T> A(n*n,T(0.5)),B(n*n,T(0.25)),C(n*n,T(0.0));
+
+    const size_t shapes[][2]={{4,4},{8,4},{16,4},{4,6},{8,6},{16,6}};
+    const size_t kcs[]={64,128,192,256,384,512};
+    const size_t mcs[]={32,64,96,128,192,256,384};
+    const size_t ncs[]={512,1024,2048,4096,8192};
+
+    tuning best=tblas::default_tuning<T>();
+    double t=seconds(best,n,A,B,C);
+
+    for(auto &s:shapes)
+    {
+        tuning b=best;
+        b.mr=s[0];
+        b.nr=s[1];
+        b=tblas::validate(b,best);
+        double u=seconds(b,n,A,B,C);
+        if(u<t)
+        {
+            t=u;
+            best=b;
+        }
+    }
+    for(size_t kc:kcs)
+    {
+        tuning b=best;
+        b.kc=kc;
+        double u=seconds(b,n,A,B,C);
+        if(u<t)
+        {
+            t=u;
+            best=b;
+        }
+    }
+    for(size_t mc:mcs)
+    {
+        tuning b=best;
+        b.mc=mc;
+        b=tblas::validate(b,best);
+        double u=seconds(b,n,A,B,C);
+        if(u<t)
+        {
+            t=u;
+            best=b;
+        }
+    }
+    for(size_t nc:ncs)
+    {
+        tuning b=best;
+        b.nc=nc;
+        b=tblas::validate(b,best);
+        double u=seconds(b,n,A,B,C);
+        if(u<t)
+        {
+            t=u;
+            best=b;
+        }
+    }
+
+    best.l1=search_l1<T>(best.l1);
+    best.l2=search_l2<T>(best.l2);
+
+    const double flops=(tblas::precision<T>::letter=='c'||tblas::precision<T>::letter=='z')?8.0:2.0;
+    std::printf("%cgemm  mc=%-4zu kc=%-4zu nc=%-5zu mr=%-2zu nr=%zu  %8.2f Gflop/s  l1=%zu l2=%zu\n",tblas::precision<T>::letter,best.mc,best.kc,best.nc,best.mr,best.nr,flops*n*n*n/t*1e-9,best.l1,best.l2);
+    return best;
+}
+
+void write(std::ofstream &out, char p, const tuning &b)
+{
+    out << p << ".mc " << b.mc << "\n";
+    out << p << ".kc " << b.kc << "\n";
+    out << p << ".nc " << b.nc << "\n";
+    out << p << ".mr " << b.mr << "\n";
+    out << p << ".nr " << b.nr << "\n";
+    out << p << ".l1 " << b.l1 << "\n";
+    out << p << ".l2 " << b.l2 << "\n";
+    out << p << ".stream " << b.stream << "\n";
+}
+
+int main(int argc, char **argv)
+{
+    size_t n=512;
+    std::string path=tblas::profile_path();
+    for(int i=1;i<argc;i++)
+    {
+        if((std::strcmp(argv[i],"-n")==0)&&(i+1<argc))
+            n=std::strtoul(argv[++i],0,10);
+        else
+            path=argv[i];
+    }
+    if(n==0)
+    {
+        std::fprintf(stderr,"usage: tblas-tune [-n size] [profile]\n");
+        return EXIT_FAILURE;
+    }
+
+    tuning s=search<float>(n);
+    tuning d=search<double>(n);
+    tuning c=search<complex<float> >(n);
+    tuning z=search<complex<double> >(n);
+
+    std::ofstream out(path.c_str());
+    if(!out)
+    {
+        std::fprintf(stderr,"tblas-tune: cannot write %s\n",path.c_str());
+        return EXIT_FAILURE;
+    }
+    out << "# tblas profile written by tblas-tune\n";
+    write(out,'s',s);
+    write(out,'d',d);
+    write(out,'c',c);
+    write(out,'z',z);
+    std::printf("profile written to %s\n",path.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+//
+//  affinity.h
+//
+//  Purpose
+//  =======
+//
+//  Placement of the threads of the pool in thread.h on the NUMA nodes of
+//  the machine, chosen by the environment variable TBLAS_AFFINITY:
+//
+//      none    threads are left to the operating system (default)
+//
+//      node    each thread is bound to all processors of one node
+//
+//      core    each thread is bound to a single processor
+//
+//  The threads are laid out in node order, the first threads()/nodes on
+//  the first node and so on, with the calling thread counted as thread 0
+//  on the first node; the calling thread itself is never bound.  Once the
+//  threads are placed the pool runs the tasks of each call in contiguous
+//  runs, one run per thread in thread order, so the leading chunks of a
+//  parallel_for land on the first node, the next on the second, and a
+//  matrix whose columns were first touched with the same split (see
+//  touch.h) is mostly read by the node that holds it.
+//
+//  The nodes and their processors are read from
+//  /sys/devices/system/node, restricted to the processors the process may
+//  run on, or may be given in TBLAS_TOPOLOGY as a list of processor sets,
+//  one per node, separated by semicolons, e.g. "0-7,16-23;8-15,24-31".
+//  Without either the whole machine is one node.  Binding uses
+//  sched_setaffinity and is only done on Linux.
+//
+
+#ifndef __affinity__
+#define __affinity__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using std::size_t;
+
+namespace tblas
+{
+    enum placement { place_none, place_node, place_core };
+
+    struct topology
+    {
+        std::vector<std::vector<int> > nodes;
+    };
+
+    //  Parses a processor list such as "0-3,8,10-11".
+
+    inline std::vector<int> parse_cpus(const std::string &list)
+    {
+        std::vector<int> cpus;
+        std::istringstream in(list);
+        std::string range;
+        while(std::getline(in,range,','))
+        {
+            if(range.find_first_of("0123456789")==std::string::npos)
+                continue;
+            const size_t dash=range.find('-');
+            const int first=std::atoi(range.c_str());
+            const int last=(dash==std::string::npos)?first:std::atoi(range.c_str()+dash+1);
+            for(int c=first;c<=last;c++)
+                cpus.push_back(c);
+        }
+        return cpus;
+    }
+
+    //  Processors the process may run on, or none if unknown.
+
+    inline std::vector<int> allowed_cpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(sched_getaffinity(0,sizeof(set),&set)==0)
+        {
+            for(int c=0;c<CPU_SETSIZE;c++)
+                if(CPU_ISSET(c,&set))
+                    cpus.push_back(c);
+        }
+#endif
+        return cpus;
+    }
+
+    inline topology read_topology()
+    {
+        topology top;
+        const char *env=std::getenv("TBLAS_TOPOLOGY");
+        if(env&&*env)
+        {
+            std::istringstream in(env);
+            std::string node;
+            while(std::getline(in,node,';'))
+            {
+                const std::vector<int> cpus=parse_cpus(node);
+                if(!cpus.empty())
+                    top.nodes.push_back(cpus);
+            }
+            return top;
+        }
+        const std::vector<int> allowed=allowed_cpus();
+        std::vector<bool> ok;
+        for(size_t i=0;i<allowed.size();i++)
+        {
+            if(ok.size()<=static_cast<size_t>(allowed[i]))
+                ok.resize(allowed[i]+1,false);
+            ok[allowed[i]]=true;
+        }
+        for(int n=0;;n++)
+        {
+            std::ostringstream path;
+            path << "/sys/devices/system/node/node" << n << "/cpulist";
+            std::ifstream in(path.str().c_str());
+            std::string list;
+            if(!in||!std::getline(in,list))
+                break;
+            const std::vector<int> cpus=parse_cpus(list);
+            std::vector<int> usable;
+            for(size_t i=0;i<cpus.size();i++)
+                if(ok.empty()||((static_cast<size_t>(cpus[i])<ok.size())&&ok[cpus[i]]))
+                    usable.push_back(cpus[i]);
+            if(!usable.empty())
+                top.nodes.push_back(usable);
+        }
+        if(top.nodes.empty()&&!allowed.empty())
+            top.nodes.push_back(allowed);
+        return top;
+    }
+
+    inline placement read_placement()
+    {
+        const char *env=std::getenv("TBLAS_AFFINITY");
+        const std::string mode=env?env:"";
+        if(mode=="node")
+            return place_node;
+        if(mode=="core")
+            return place_core;
+        return place_none;
+    }
+
+    //  Node of thread t of nthreads, with the threads laid out in node
+    //  order.
+
+    inline size_t thread_node(const topology &top, size_t t, size_t nthreads)
+    {
+        const size_t nodes=top.nodes.size();
+        return (nodes>0)?t*std::min(nodes,nthreads)/nthreads:0;
+    }
+
+    //  Binds the calling thread, thread t of nthreads, as chosen by mode.
+    //  Threads beyond the processors of their node share them round robin.
+
+    inline void bind_thread(const topology &top, placement mode, size_t t, size_t nthreads)
+    {
+#ifdef __linux__
+        if((mode==place_none)||top.nodes.empty())
+            return;
+        const size_t node=thread_node(top,t,nthreads);
+        const std::vector<int> &cpus=top.nodes[node];
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(mode==place_node)
+        {
+            for(size_t i=0;i<cpus.size();i++)
+                CPU_SET(cpus[i],&set);
+        }
+        else
+        {
+            size_t first=0;
+            while((first<t)&&(thread_node(top,first,nthreads)!=node))
+                first++;
+            CPU_SET(cpus[(t-first)%cpus.size()],&set);
+        }
+        sched_setaffinity(0,sizeof(set),&set);
+#endif
+    }
+}
+#endif
@@ -0,0 +1,347 @@
+//
+//  async.h
+//
+//  Purpose
+//  =======
+//
+//  Asynchronous execution of the library routines, for callers that want
+//  to go on with other work while an operation runs.  Each routine of
+//  tblas::async takes the same arguments as the routine of the same name
+//  in tblas and returns a std::future<void> that becomes ready when the
+//  operation has finished, rethrowing from get() anything it threw:
+//
+//      gemm, gemv, symm, hemm, syrk, herk, syr2k, her2k, trmm, trsm
+//
+//  Called with a stream as the first argument, the operation is queued on
+//  the stream, whose operations run one after the other in the order they
+//  were queued, each seeing the results of those before it.  Called
+//  without, the operation is queued on its own.  Operations are run by an
+//  executor of as many threads as the thread pool has, started on first
+//  use, so at most that many run at once however many are queued; streams
+//  take turns on it one operation at a time.  Whichever running operation
+//  finds the thread pool idle splits its work over the pool, and the
+//  others run serially on their executor threads, so the threads busy at
+//  any time are at most the executor's and the pool's together.
+//
+//  The arguments are copied when the operation is queued, but the arrays
+//  they point to are not: they must stay alive, and must not be written
+//  by the caller, until the operation is done.  A stream finishes all its
+//  queued operations before it is destroyed.  Each operation runs with the
+//  context (see context.h) the queuing thread had when it queued it.
+//
+
+#ifndef __async__
+#define __async__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "context.h"
+#include "gemm.h"
+#include "gemv.h"
+#include "hemm.h"
+#include "her2k.h"
+#include "herk.h"
+#include "symm.h"
+#include "syr2k.h"
+#include "syrk.h"
+#include "thread.h"
+#include "trmm.h"
+#include "trsm.h"
+
+namespace tblas
+{
+    namespace async
+    {
+        //  Wraps f() to run in the context of the calling thread, setting
+        //  done to the future of its completion.
+
+        template <typename F>
+        std::function<void()> package(F f, std::future<void> &done)
+        {
+            const context c=this_context();
+            std::shared_ptr<std::packaged_task<void()> > task=std::make_shared<std::packaged_task<void()> >([=]{ context_scope scope(c); f(); });
+            done=task->get_future();
+            return [task]{ (*task)(); };
+        }
+
+        //  Fixed set of threads running queued operations first come first
+        //  served, one per thread of the pool.
+
+        class executor
+        {
+        public:
+            static executor &instance()
+            {
+                static executor e(thread_pool::instance().size());
+                return e;
+            }
+
+            void post(const std::function<void()> &f)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.push_back(f);
+                }
+                wake.notify_one();
+            }
+
+            ~executor()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stop=true;
+                }
+                wake.notify_all();
+                for(size_t i=0;i<workers.size();i++)
+                    workers[i].join();
+            }
+
+        private:
+            explicit executor(size_t nthreads) : stop(false)
+            {
+                for(size_t i=0;i<nthreads;i++)
+                    workers.push_back(std::thread(&executor::loop,this));
+            }
+
+            executor(const executor &);
+            executor &operator=(const executor &);
+
+            void loop()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                for(;;)
+                {
+                    wake.wait(lock,[this]{ return stop||!queue.empty(); });
+                    if(queue.empty())
+                        return;
+                    std::function<void()> f=queue.front();
+                    queue.pop_front();
+                    lock.unlock();
+                    f();
+                    lock.lock();
+                }
+            }
+
+            std::deque<std::function<void()> > queue;
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::vector<std::thread> workers;
+            bool stop;
+        };
+
+        //  In-order queue of operations.  While it has operations queued,
+        //  the stream has one job on the executor, which runs the first of
+        //  them and queues itself again behind the jobs of other streams.
+
+        class stream
+        {
+        public:
+            stream() : busy(false)
+            {
+            }
+
+            ~stream()
+            {
+                synchronize();
+            }
+
+            //  Queues f() behind the operations already on the stream.
+
+            template <typename F>
+            std::future<void> enqueue(F f)
+            {
+                std::future<void> done;
+                std::function<void()> task=package(f,done);
+                bool start;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.push_back(task);
+                    start=!busy;
+                    busy=true;
+                }
+                if(start)
+                    executor::instance().post([this]{ step(); });
+                return done;
+            }
+
+            //  Waits until every operation queued so far has finished.
+
+            void synchronize()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                idle.wait(lock,[this]{ return !busy; });
+            }
+
+            //  True if every operation queued so far has finished.
+
+            bool query()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return !busy;
+            }
+
+        private:
+            stream(const stream &);
+            stream &operator=(const stream &);
+
+            void step()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                std::function<void()> f=queue.front();
+                queue.pop_front();
+                lock.unlock();
+                f();
+                lock.lock();
+                if(queue.empty())
+                {
+                    busy=false;
+                    idle.notify_all();
+                }
+                else
+                    executor::instance().post([this]{ step(); });
+            }
+
+            std::deque<std::function<void()> > queue;
+            std::mutex mutex;
+            std::condition_variable idle;
+            bool busy;
+        };
+
+        //  Queues f() on the executor.
+
+        template <typename F>
+        std::future<void> launch(F f)
+        {
+            std::future<void> done;
+            executor::instance().post(package(f,done));
+            return done;
+        }
+
+        template <typename... A>
+        std::future<void> gemm(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::gemm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> gemm(A... args)
+        {
+            return launch([=]{ tblas::gemm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> gemv(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::gemv(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> gemv(A... args)
+        {
+            return launch([=]{ tblas::gemv(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> symm(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::symm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> symm(A... args)
+        {
+            return launch([=]{ tblas::symm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> hemm(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::hemm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> hemm(A... args)
+        {
+            return launch([=]{ tblas::hemm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> syrk(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::syrk(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> syrk(A... args)
+        {
+            return launch([=]{ tblas::syrk(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> herk(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::herk(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> herk(A... args)
+        {
+            return launch([=]{ tblas::herk(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> syr2k(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::syr2k(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> syr2k(A... args)
+        {
+            return launch([=]{ tblas::syr2k(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> her2k(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::her2k(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> her2k(A... args)
+        {
+            return launch([=]{ tblas::her2k(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> trmm(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::trmm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> trmm(A... args)
+        {
+            return launch([=]{ tblas::trmm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> trsm(stream &s, A... args)
+        {
+            return s.enqueue([=]{ tblas::trsm(args...); });
+        }
+
+        template <typename... A>
+        std::future<void> trsm(A... args)
+        {
+            return launch([=]{ tblas::trsm(args...); });
+        }
+    }
+}
+#endif
@@ -23,12 +23,21 @@
 //
 //  incy    stride of vector y; if negative, y is stored in reverse order
 //
+//  For complex vectors the products are formed from the real and
+//  imaginary parts (see cplx.h) and long vectors are split over the
+//  thread pool.
+//
 
 #ifndef __axpy__
 #define __axpy__
 
+#include <complex>
 #include <cstddef>
+#include "cplx.h"
+#include "stride.h"
+#include "tune.h"
 
+using std::complex;
 using std::size_t;
 using std::ptrdiff_t;
 
@@ -37,22 +46,13 @@ namespace tblas
     template <typename T>
     void axpy(size_t n, T alpha, T *x, ptrdiff_t incx, T *y, ptrdiff_t incy)
     {
-        if((incx==1)&&(incy==1))
-        {
-            for(size_t i=0;i<n;i++)
-                y[i]+=alpha*x[i];
-        }
-        else
-        {
-            size_t ix=(incx>0)?0:(1-n)*incx;
-            size_t iy=(incy>0)?0:(1-n)*incy;
-            for(size_t i=0;i<n;i++)
-            {
-                y[iy]+=alpha*x[ix];
-                ix+=incx;
-                iy+=incy;
-            }
-        }
+        pairwise(n,x,incx,y,incy,[alpha](const T &a, T &b){ b+=alpha*a; });
+    }
+
+    template <typename T>
+    void axpy(size_t n, complex<T> alpha, complex<T> *x, ptrdiff_t incx, complex<T> *y, ptrdiff_t incy)
+    {
+        parallel_pairwise(n,x,incx,y,incy,profile<complex<T> >().l1,[alpha](const complex<T> &a, complex<T> &b){ b+=cmul(alpha,a); });
     }
 }
 #endif
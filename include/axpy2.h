@@ -0,0 +1,75 @@
+//
+//  axpy2.h
+//
+//  Purpose
+//  =======
+//
+//  Adds constant multiples of two vectors to a third (dual axpy):
+//
+//      y <- alpha1 * x1 + alpha2 * x2 + y
+//
+//  in a single pass over memory, instead of the two passes over y taken
+//  by a pair of axpy calls.  Long vectors are split across threads.
+//
+//  Arguments
+//  =========
+//
+//  n       length of vectors x1, x2 and y
+//
+//  alpha1  constant multiple of x1
+//
+//  x1      vector of length n
+//
+//  incx1   stride of vector x1; if negative, x1 is stored in reverse order
+//
+//  alpha2  constant multiple of x2
+//
+//  x2      vector of length n
+//
+//  incx2   stride of vector x2; if negative, x2 is stored in reverse order
+//
+//  y       vector of length n
+//
+//  incy    stride of vector y; if negative, y is stored in reverse order
+//
+
+#ifndef __axpy2__
+#define __axpy2__
+
+#include <cstddef>
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T>
+    void axpy2(size_t n, T alpha1, T *x1, ptrdiff_t incx1, T alpha2, T *x2, ptrdiff_t incx2, T *y, ptrdiff_t incy)
+    {
+        x1=origin(x1,n,incx1);
+        x2=origin(x2,n,incx2);
+        y=origin(y,n,incy);
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            const ptrdiff_t b=static_cast<ptrdiff_t>(begin);
+            const ptrdiff_t m=static_cast<ptrdiff_t>(end-begin);
+            T *u=x1+b*incx1;
+            T *v=x2+b*incx2;
+            T *w=y+b*incy;
+            if((incx1==1)&&(incx2==1)&&(incy==1))
+            {
+                for(ptrdiff_t i=0;i<m;i++)
+                    w[i]+=alpha1*u[i]+alpha2*v[i];
+            }
+            else
+            {
+                for(ptrdiff_t i=0;i<m;i++)
+                    w[i*incy]+=alpha1*u[i*incx1]+alpha2*v[i*incx2];
+            }
+        });
+    }
+}
+#endif
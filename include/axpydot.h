@@ -0,0 +1,133 @@
+//
+//  axpydot.h
+//
+//  Purpose
+//  =======
+//
+//  Fused vector update and dot product, as AXPY_DOT in the BLAS Technical
+//  Forum standard:
+//
+//      w <- w - alpha * v
+//
+//      r <- w^T u  [axpydot]
+//
+//      r <- w^H u  [axpydotc]
+//
+//  The updated w is used in the dot product while it is still in registers,
+//  so each vector is read once.  Long vectors are split across threads.
+//
+//  Returns
+//  =======
+//
+//  the dot product r
+//
+//  Arguments
+//  =========
+//
+//  n       length of vectors v, w and u
+//
+//  alpha   scalar multiple of v
+//
+//  v       vector of length n
+//
+//  incv    stride of vector v; if negative, v is stored in reverse order
+//
+//  w       vector of length n, updated on exit
+//
+//  incw    stride of vector w; if negative, w is stored in reverse order
+//
+//  u       vector of length n
+//
+//  incu    stride of vector u; if negative, u is stored in reverse order
+//
+
+#ifndef __axpydot__
+#define __axpydot__
+
+#include <complex>
+#include <cstddef>
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
+
+using std::complex;
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T, typename C>
+    T axpydot_kernel(ptrdiff_t m, T alpha, T *v, ptrdiff_t incv, T *w, ptrdiff_t incw, T *u, ptrdiff_t incu, C op)
+    {
+        const T zero(0.0);
+
+        if((incv==1)&&(incw==1)&&(incu==1))
+        {
+            T s0=zero;
+            T s1=zero;
+            T s2=zero;
+            T s3=zero;
+            ptrdiff_t i=0;
+            for(;i+4<=m;i+=4)
+            {
+                const T w0=w[i]-alpha*v[i];
+                const T w1=w[i+1]-alpha*v[i+1];
+                const T w2=w[i+2]-alpha*v[i+2];
+                const T w3=w[i+3]-alpha*v[i+3];
+                w[i]=w0;
+                w[i+1]=w1;
+                w[i+2]=w2;
+                w[i+3]=w3;
+                s0+=op(w0)*u[i];
+                s1+=op(w1)*u[i+1];
+                s2+=op(w2)*u[i+2];
+                s3+=op(w3)*u[i+3];
+            }
+            for(;i<m;i++)
+            {
+                const T t=w[i]-alpha*v[i];
+                w[i]=t;
+                s0+=op(t)*u[i];
+            }
+            return (s0+s1)+(s2+s3);
+        }
+        else
+        {
+            T s=zero;
+            for(ptrdiff_t i=0;i<m;i++)
+            {
+                const T t=w[i*incw]-alpha*v[i*incv];
+                w[i*incw]=t;
+                s+=op(t)*u[i*incu];
+            }
+            return s;
+        }
+    }
+
+    template <typename T, typename C>
+    T axpydot(size_t n, T alpha, T *v, ptrdiff_t incv, T *w, ptrdiff_t incw, T *u, ptrdiff_t incu, C op)
+    {
+        v=origin(v,n,incv);
+        w=origin(w,n,incw);
+        u=origin(u,n,incu);
+        return parallel_sum(n,profile<T>().l1,T(0.0),[=](size_t begin, size_t end)
+        {
+            const ptrdiff_t b=static_cast<ptrdiff_t>(begin);
+            const ptrdiff_t m=static_cast<ptrdiff_t>(end-begin);
+            return axpydot_kernel(m,alpha,v+b*incv,incv,w+b*incw,incw,u+b*incu,incu,op);
+        });
+    }
+
+    template <typename T>
+    T axpydot(size_t n, T alpha, T *v, ptrdiff_t incv, T *w, ptrdiff_t incw, T *u, ptrdiff_t incu)
+    {
+        return axpydot(n,alpha,v,incv,w,incw,u,incu,[](const T &a){ return a; });
+    }
+
+    template <typename T>
+    complex<T> axpydotc(size_t n, complex<T> alpha, complex<T> *v, ptrdiff_t incv, complex<T> *w, ptrdiff_t incw, complex<T> *u, ptrdiff_t incu)
+    {
+        return axpydot(n,alpha,v,incv,w,incw,u,incu,[](const complex<T> &a){ return conj(a); });
+    }
+}
+#endif
@@ -0,0 +1,234 @@
+//
+//  band.h
+//
+//  Purpose
+//  =======
+//
+//  Row-blocked kernels for the band matrix-vector routines in gbmv.h,
+//  sbmv.h, hbmv.h and tbmv.h, and the band matrix-matrix routines in
+//  gbmm.h, sbmm.h and hbmm.h.
+//
+//  Element (i,j) of a band matrix with ku super-diagonals is stored at
+//  A[ku+i-j+j*ldA], so the elements of each diagonal d=i-j are spaced ldA
+//  apart and can be streamed against x and y with one long loop, where a
+//  column sweep only ever has the band width to work with.  band_mv adds
+//  the products of a range of diagonals to a range of the output vector.
+//  Narrow bands are taken one diagonal at a time; wide bands keep the
+//  column loops, whose inner loops are then long enough to vectorize on
+//  their own.
+//
+//  parallel_band hands out the outputs in blocks small enough that the
+//  part of A they touch stays in cache while every diagonal, and for the
+//  symmetric routines both triangles, pass over it.  Each output element is
+//  computed entirely by the block that owns it, so the blocks are split
+//  over the thread pool without any reduction and the result does not
+//  depend on the number of threads.
+//
+//  band_mm multiplies a band matrix into band_rhs columns of B at a time.
+//  The rows of B that the band reaches from the current row of C are kept,
+//  transposed, in a window that moves down with it, so each element of A
+//  is read once per block of columns and is applied to all of them with
+//  one unit-stride vector operation.
+//
+
+#ifndef __band__
+#define __band__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    //  Bands with at most this many diagonals are taken diagonal by
+    //  diagonal.
+
+    const size_t band_narrow=8;
+
+    //  Number of outputs per block handed out by parallel_band.
+
+    const size_t band_block=256;
+
+    //  Number of columns of B taken together by band_mm and tbsm.
+
+    const size_t band_rhs=32;
+
+    //  y(0:len) <- op(a(0:len*ldA:ldA)) .* x(0:len) + y(0:len)
+
+    template <typename T, typename C>
+    inline void band_diagonal(size_t len, const T *a, size_t ldA, const T *x, T *y, C op)
+    {
+        for(size_t t=0;t<len;t++)
+            y[t]+=op(a[t*ldA])*x[t];
+    }
+
+    //  For the m-by-n band matrix A with ku super-diagonals, adds to
+    //  outputs o0 to o1-1 the products with diagonals d0 to d1 of A,
+    //  where the diagonal d holds the elements (i,j) with i-j=d:
+    //
+    //      y <- op(A) * x + y    [trans='N', y of length m]
+    //
+    //      y <- op(A)^T * x + y  [otherwise, y of length n]
+
+    template <typename T, typename C>
+    void band_mv(char trans, size_t m, size_t n, size_t ku, ptrdiff_t d0, ptrdiff_t d1, const T *A, size_t ldA, const T *x, T *y, size_t o0, size_t o1, C op)
+    {
+        if(d0>d1)
+            return;
+        const ptrdiff_t M=m;
+        const ptrdiff_t N=n;
+        const ptrdiff_t K=ku;
+        const ptrdiff_t L=ldA;
+        if(static_cast<size_t>(d1-d0)<band_narrow)
+        {
+            for(ptrdiff_t d=d0;d<=d1;d++)
+            {
+                if(trans=='N')
+                {
+                    const ptrdiff_t i0=std::max(static_cast<ptrdiff_t>(o0),d);
+                    const ptrdiff_t i1=std::min(static_cast<ptrdiff_t>(o1),N+d);
+                    if(i0<i1)
+                        band_diagonal(i1-i0,A+K+d+(i0-d)*L,ldA,x+i0-d,y+i0,op);
+                }
+                else
+                {
+                    const ptrdiff_t j0=std::max(static_cast<ptrdiff_t>(o0),-d);
+                    const ptrdiff_t j1=std::min(static_cast<ptrdiff_t>(o1),M-d);
+                    if(j0<j1)
+                        band_diagonal(j1-j0,A+K+d+j0*L,ldA,x+j0+d,y+j0,op);
+                }
+            }
+        }
+        else if(trans=='N')
+        {
+            const ptrdiff_t j0=std::max(ptrdiff_t(0),static_cast<ptrdiff_t>(o0)-d1);
+            const ptrdiff_t j1=std::min(N,static_cast<ptrdiff_t>(o1)-d0);
+            for(ptrdiff_t j=j0;j<j1;j++)
+            {
+                const ptrdiff_t i0=std::max(static_cast<ptrdiff_t>(o0),j+d0);
+                const ptrdiff_t i1=std::min(static_cast<ptrdiff_t>(o1),j+d1+1);
+                const T *a=A+K-j+j*L;
+                const T xj=x[j];
+                for(ptrdiff_t i=i0;i<i1;i++)
+                    y[i]+=op(a[i])*xj;
+            }
+        }
+        else
+        {
+            for(ptrdiff_t j=o0;j<static_cast<ptrdiff_t>(o1);j++)
+            {
+                const ptrdiff_t i0=std::max(ptrdiff_t(0),j+d0);
+                const ptrdiff_t i1=std::min(M,j+d1+1);
+                const T *a=A+K-j+j*L;
+                T sum(0);
+                for(ptrdiff_t i=i0;i<i1;i++)
+                    sum+=op(a[i])*x[i];
+                y[j]+=sum;
+            }
+        }
+    }
+
+    //  C <- beta * C for the m-by-n matrix C, where beta=0 clears C.
+
+    template <typename T>
+    void band_scale(size_t m, size_t n, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+        if(beta==one)
+            return;
+        for(size_t j=0;j<n;j++)
+        {
+            T *c=C+j*ldC;
+            for(size_t i=0;i<m;i++)
+                c[i]=(beta==zero)?zero:beta*c[i];
+        }
+    }
+
+    //  Rows o0 to o1-1 of
+    //
+    //      C <- alpha * A * B + beta * C
+    //
+    //  for nb columns of B and C, where A is m-by-k with element (i,j) given
+    //  by a(i,j) for j from i-lo to i+hi and zero elsewhere, and beta=0
+    //  clears C.  W holds lo+hi+2 rows of nb elements.
+
+    template <typename T, typename E>
+    void band_mm(size_t o0, size_t o1, size_t k, size_t lo, size_t hi, size_t nb, T alpha, const T *B, size_t ldB, T beta, T *C, size_t ldC, T *W, E a)
+    {
+        const T zero(0.0);
+        const size_t w=lo+hi+1;
+        T *s=W+w*nb;
+
+        auto load=[&](size_t j)
+        {
+            T *r=W+(j%w)*nb;
+            for(size_t c=0;c<nb;c++)
+                r[c]=B[j+c*ldB];
+        };
+
+        for(size_t j=(o0>lo)?o0-lo:0;j<std::min(k,o0+hi);j++)
+            load(j);
+        for(size_t i=o0;i<o1;i++)
+        {
+            if(i+hi<k)
+                load(i+hi);
+            for(size_t c=0;c<nb;c++)
+                s[c]=zero;
+            for(size_t j=(i>lo)?i-lo:0;j<std::min(k,i+hi+1);j++)
+            {
+                const T aij=a(i,j);
+                const T *r=W+(j%w)*nb;
+                for(size_t c=0;c<nb;c++)
+                    s[c]+=aij*r[c];
+            }
+            T *ci=C+i;
+            if(beta==zero)
+            {
+                for(size_t c=0;c<nb;c++)
+                    ci[c*ldC]=alpha*s[c];
+            }
+            else
+            {
+                for(size_t c=0;c<nb;c++)
+                    ci[c*ldC]=alpha*s[c]+beta*ci[c*ldC];
+            }
+        }
+    }
+
+    //  Splits the m rows of a band matrix-matrix product over the thread
+    //  pool and runs band_mm on each range, for band_rhs columns at a time.
+
+    template <typename T, typename E>
+    void parallel_band_mm(size_t m, size_t n, size_t k, size_t lo, size_t hi, T alpha, const T *B, size_t ldB, T beta, T *C, size_t ldC, E a)
+    {
+        const size_t width=lo+hi+1;
+        parallel_for(m,std::max(size_t(1),profile<T>().l2/(width*n)),[=](size_t begin, size_t end)
+        {
+            std::vector<T> W((width+1)*band_rhs);
+            for(size_t j=0;j<n;j+=band_rhs)
+                band_mm(begin,end,k,lo,hi,std::min(band_rhs,n-j),alpha,B+j*ldB,ldB,beta,C+j*ldC,ldC,W.data(),a);
+        });
+    }
+
+    //  Splits the len outputs of a band product with width diagonals into
+    //  ranges of about grain matrix entries each, one per thread, and calls
+    //  f(o0,o1) for consecutive blocks of at most band_block outputs of each
+    //  range.
+
+    template <typename F>
+    void parallel_band(size_t len, size_t width, size_t grain, F f)
+    {
+        parallel_for(len,std::max(size_t(1),grain/std::max(width,size_t(1))),[&](size_t begin, size_t end)
+        {
+            for(size_t b=begin;b<end;b+=band_block)
+                f(b,std::min(b+band_block,end));
+        });
+    }
+}
+#endif
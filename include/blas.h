@@ -14,6 +14,10 @@
 
 using std::complex;
 
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+
 extern "C"
 {
     void xerbla_(const char *name, const int &info);
@@ -203,4 +207,8 @@ extern "C"
     void ctrsm_(const char &side, const char &uplo, const char &trans, const char &diag, const int &m, const int &n, const complex<float> &alpha, complex<float> *A, const int &ldA, complex<float> *B, const int &ldB);
     void ztrsm_(const char &side, const char &uplo, const char &trans, const char &diag, const int &m, const int &n, const complex<double> &alpha, complex<double> *A, const int &ldA, complex<double> *B, const int &ldB);
 }
+
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
 #endif
@@ -0,0 +1,123 @@
+//
+//  context.h
+//
+//  Purpose
+//  =======
+//
+//  Per-thread configuration of the library.  Every thread has a context of
+//  its own, which the library reads on each call from thread-local storage,
+//  without a lock, so threads calling the library concurrently never wait
+//  on one another for their settings.  A thread starts with a copy of the
+//  process default, taken on its first call; set_default_context changes
+//  the default for the threads that have not called the library yet, and
+//  this_context() or a context_scope change the settings of the calling
+//  thread alone.  Operations queued through async.h run with the context
+//  of the thread that queued them.
+//
+//  The rest of the library state is set once and only read afterwards:
+//  the tuning profile of tune.h is loaded on first use, and the packing
+//  buffers of gemm are per thread.
+//
+//  Fields
+//  ======
+//
+//  threads         maximum number of threads used by a call, or 0 for
+//                  all threads of the pool (see thread_limit in thread.h)
+//
+//  deterministic   if true, reductions are split at points that depend on
+//                  the size of the problem only, so dot products, gemv
+//                  and the triangular solves give the same result whatever
+//                  the number of threads; if false, at most one part per
+//                  thread
+//
+//  errors          what xerbla does with an illegal argument: error_exit
+//                  prints a message and exits (default), error_print
+//                  prints it and returns, error_quiet only returns; the
+//                  routine then returns without doing anything
+//
+//  handler         if not null, called by xerbla with the name of the
+//                  routine and the number of the illegal argument, in
+//                  place of the message
+//
+//  stats           if not null, counters the library adds to on behalf of
+//                  the thread; may be shared by several threads
+//
+
+#ifndef __context__
+#define __context__
+
+#include <atomic>
+#include <cstddef>
+
+using std::size_t;
+
+namespace tblas
+{
+    enum error_mode { error_exit, error_print, error_quiet };
+
+    struct counters
+    {
+        counters() : parallel(0), tasks(0), graph_tasks(0), errors(0)
+        {
+        }
+
+        std::atomic<size_t> parallel;       // calls split over the pool
+        std::atomic<size_t> tasks;          // pool tasks of those calls
+        std::atomic<size_t> graph_tasks;    // tile tasks run by task graphs
+        std::atomic<size_t> errors;         // illegal arguments reported
+    };
+
+    struct context
+    {
+        context() : threads(0), deterministic(false), errors(error_exit), handler(0), stats(0)
+        {
+        }
+
+        size_t threads;
+        bool deterministic;
+        error_mode errors;
+        void (*handler)(const char *name, int info);
+        counters *stats;
+    };
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+
+    //  Process default, and the context of the calling thread.  These are
+    //  compiled into the library, in context.cpp, so that a program built
+    //  with the templates of include shares them with the shared library.
+
+    context default_context();
+
+    void set_default_context(const context &c);
+
+    context &this_context();
+
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+
+    //  Sets the context of the calling thread to c while it exists.
+
+    class context_scope
+    {
+    public:
+        explicit context_scope(const context &c) : saved(this_context())
+        {
+            this_context()=c;
+        }
+
+        ~context_scope()
+        {
+            this_context()=saved;
+        }
+
+    private:
+        context_scope(const context_scope &);
+        context_scope &operator=(const context_scope &);
+
+        context saved;
+    };
+}
+#endif
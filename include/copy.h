@@ -21,11 +21,18 @@
 //
 //  incy    stride of vector y; if negative, y is stored in reverse order
 //
+//  Unit-stride copies longer than the stream parameter of tune.h are split
+//  over the thread pool and written with non-temporal stores (see
+//  stream.h).  Copies between a contiguous and a strided vector use the
+//  strided loads and stores of stride.h.
+//
 
 #ifndef __copy__
 #define __copy__
 
 #include <cstddef>
+#include "stream.h"
+#include "stride.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -35,22 +42,14 @@ namespace tblas
     template <typename T>
     void copy(size_t n, T *x, ptrdiff_t incx, T *y, ptrdiff_t incy)
     {
-        if((incx==1)&&(incy==1))
-        {
-            for(size_t i=0;i<n;i++)
-                y[i]=x[i];
-        }
+        if((incx==1)&&(incy==1)&&streamed<T>(n))
+            parallel_copy(n,x,y);
+        else if((incy==1)&&(incx!=1)&&(incx!=0))
+            strided_load(n,origin(x,n,incx),incx,y);
+        else if((incx==1)&&(incy!=1)&&(incy!=0))
+            strided_store(n,x,origin(y,n,incy),incy);
         else
-        {
-            size_t ix=incx>0?0:(1-n)*incx;
-            size_t iy=incy>0?0:(1-n)*incy;
-            for(size_t i=0;i<n;i++)
-            {
-                y[iy]=x[ix];
-                ix+=incx;
-                iy+=incy;
-            }
-        }
+            pairwise(n,x,incx,y,incy,[](const T &a, T &b){ b=a; });
     }
 }
 #endif
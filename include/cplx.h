@@ -0,0 +1,115 @@
+//
+//  cplx.h
+//
+//  Purpose
+//  =======
+//
+//  Complex arithmetic for the complex Level-1 kernels in axpy.h, scal.h,
+//  dot.h and dotc.h.
+//
+//  A product of two std::complex values must recover infinities from NaN
+//  results, so the compiler emits a check and a call into its runtime for
+//  every product and will not vectorize the loop around it.  cmul forms
+//  the product from the real and imaginary parts directly, as the
+//  reference BLAS does, which the compiler turns into shuffles and
+//  multiply-adds on the interleaved parts of several elements at once.
+//
+//  cdot accumulates a complex dot product in cdot_lanes independent pairs
+//  of partial sums, taking cdot_lanes consecutive elements per step, so
+//  the sums vectorize without reordering any single sum; the partial sums
+//  are added pairwise at the end.
+//
+
+#ifndef __cplx__
+#define __cplx__
+
+#include <complex>
+#include <cstddef>
+
+using std::complex;
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    //  Number of elements whose products are summed separately by cdot.
+
+    const size_t cdot_lanes=4;
+
+    //  a * b
+
+    template <typename T>
+    inline complex<T> cmul(const complex<T> &a, const complex<T> &b)
+    {
+        return complex<T>(a.real()*b.real()-a.imag()*b.imag(),a.real()*b.imag()+a.imag()*b.real());
+    }
+
+    //  conj(a) * b
+
+    template <typename T>
+    inline complex<T> cmulc(const complex<T> &a, const complex<T> &b)
+    {
+        return complex<T>(a.real()*b.real()+a.imag()*b.imag(),a.real()*b.imag()-a.imag()*b.real());
+    }
+
+    //  Returns the sum of op(x[i*incx]) * y[i*incy] for i=0,...,m-1, where
+    //  op conjugates if CONJ is set.
+
+    template <bool CONJ, typename T>
+    complex<T> cdot(ptrdiff_t m, const complex<T> *x, ptrdiff_t incx, const complex<T> *y, ptrdiff_t incy)
+    {
+        const T zero(0.0);
+        const T sign=CONJ?T(-1.0):T(1.0);
+
+        if((incx==1)&&(incy==1))
+        {
+            const T *u=reinterpret_cast<const T *>(x);
+            const T *v=reinterpret_cast<const T *>(y);
+            const ptrdiff_t L=cdot_lanes;
+            T re[cdot_lanes];
+            T im[cdot_lanes];
+            for(ptrdiff_t l=0;l<L;l++)
+            {
+                re[l]=zero;
+                im[l]=zero;
+            }
+            ptrdiff_t i=0;
+            for(;i+L<=m;i+=L)
+            {
+                for(ptrdiff_t l=0;l<L;l++)
+                {
+                    const T xr=u[2*(i+l)];
+                    const T xi=sign*u[2*(i+l)+1];
+                    const T yr=v[2*(i+l)];
+                    const T yi=v[2*(i+l)+1];
+                    re[l]+=xr*yr-xi*yi;
+                    im[l]+=xr*yi+xi*yr;
+                }
+            }
+            for(;i<m;i++)
+            {
+                const T xr=u[2*i];
+                const T xi=sign*u[2*i+1];
+                re[0]+=xr*v[2*i]-xi*v[2*i+1];
+                im[0]+=xr*v[2*i+1]+xi*v[2*i];
+            }
+            for(ptrdiff_t h=L/2;h>0;h/=2)
+            {
+                for(ptrdiff_t l=0;l<h;l++)
+                {
+                    re[l]+=re[l+h];
+                    im[l]+=im[l+h];
+                }
+            }
+            return complex<T>(re[0],im[0]);
+        }
+        else
+        {
+            complex<T> sum(zero);
+            for(ptrdiff_t i=0;i<m;i++)
+                sum+=CONJ?cmulc(x[i*incx],y[i*incy]):cmul(x[i*incx],y[i*incy]);
+            return sum;
+        }
+    }
+}
+#endif
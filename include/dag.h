@@ -0,0 +1,317 @@
+//
+//  dag.h
+//
+//  Purpose
+//  =======
+//
+//  Task graph for the tiled Level-3 routines.  Large calls to gemm, trsm,
+//  trmm, syrk and syr2k are cut into square tiles of tile_order<T>() rows
+//  and columns, and each update of a tile becomes a task that names the
+//  tiles it reads and writes.  Tasks are queued on a task_graph in the
+//  order a serial code would run them, and the graph orders two tasks only
+//  if one writes a tile the other reads or writes, so a tile update may
+//  start as soon as the tiles it needs are final rather than when a whole
+//  step of the algorithm is.
+//
+//  The routines taking a task_graph as their first argument queue the
+//  tasks of one call without running them; wait runs everything queued so
+//  far and returns when it is done.  Several calls queued before one wait
+//  overlap: a trsm followed by a gemm on its solution starts the gemm on
+//  the first tiles of X while the solve is still working on the last.
+//  A tile is named by the address of its first element, its rows, columns
+//  and column length, and a task is ordered after the earlier tasks on any
+//  tile that shares an element with one of its own, so calls on views of
+//  a matrix whose tiles do not line up, at another offset or of another
+//  order, still run in the order they were queued, only with less overlap
+//  than calls on the same tiles.  Tiles with different column lengths are
+//  taken to overlap whenever the ranges of memory they span do.  The
+//  calls without a task_graph build and wait on one of their own when the
+//  matrices span more than one tile.
+//
+//  wait splits the graph over the thread pool.  Each thread keeps the
+//  tasks that became ready on it in a lock-free deque of its own (see
+//  deque.h), runs the most recent of them first, and when it has none
+//  steals the oldest task of another thread, so the threads stay busy
+//  while any task is ready however uneven the tasks are, as they are for
+//  the triangular routines, where the tiles near the diagonal do less
+//  work than the rest.
+//
+
+#ifndef __dag__
+#define __dag__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "deque.h"
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    //  Order of the square tiles for precision T.
+
+    template <typename T>
+    inline size_t tile_order()
+    {
+        const tuning &bs=profile<T>();
+        return std::max(bs.mc,bs.kc);
+    }
+
+    //  Tile accessed by a task: the address of its first element, the
+    //  length in bytes of its columns and the distance between them, its
+    //  number of columns, and whether the task writes it.
+
+    struct tile_access
+    {
+        std::uintptr_t tile;
+        size_t rows;
+        size_t ld;
+        size_t cols;
+        bool write;
+    };
+
+    template <typename T>
+    inline tile_access tile_read(const T *a, size_t rows, size_t cols, size_t ld)
+    {
+        tile_access t={reinterpret_cast<std::uintptr_t>(a),rows*sizeof(T),ld*sizeof(T),cols,false};
+        return t;
+    }
+
+    template <typename T>
+    inline tile_access tile_write(const T *a, size_t rows, size_t cols, size_t ld)
+    {
+        tile_access t={reinterpret_cast<std::uintptr_t>(a),rows*sizeof(T),ld*sizeof(T),cols,true};
+        return t;
+    }
+
+    //  Tile of op(A) with the given rows and columns, where op(A)=A if
+    //  trans='N' or A^T otherwise.
+
+    template <typename T>
+    inline tile_access tile_read(char trans, const T *a, size_t rows, size_t cols, size_t ld)
+    {
+        return (trans=='N')?tile_read(a,rows,cols,ld):tile_read(a,cols,rows,ld);
+    }
+
+    //  Adds to data the tiles of the panel of op(A) that holds its rows i0
+    //  to i0+ib-1, where op(A) has k columns and op(A)=A if trans='N' or
+    //  A^T otherwise.
+
+    template <typename T>
+    void tile_panel(char trans, size_t i0, size_t ib, size_t k, size_t nb, const T *A, size_t ldA, std::vector<tile_access> &data)
+    {
+        for(size_t l0=0;l0<k;l0+=nb)
+            data.push_back(tile_read(trans,(trans=='N')?A+i0+l0*ldA:A+l0+i0*ldA,ib,std::min(nb,k-l0),ldA));
+    }
+
+    //  Number of bytes from the first byte of tile a to its last.
+
+    inline size_t tile_span(const tile_access &a)
+    {
+        return (a.cols-1)*a.ld+a.rows;
+    }
+
+    //  True if tiles a and b, neither empty, share a byte.  With the same
+    //  column length, the columns of b start at a column offset dc and a
+    //  byte offset dr within the columns of a, and reach into the next
+    //  column of a if they run past its end.
+
+    inline bool tile_overlap(const tile_access &a, const tile_access &b)
+    {
+        if(a.tile>b.tile)
+            return tile_overlap(b,a);
+        if(b.tile>=a.tile+tile_span(a))
+            return false;
+        if((a.ld!=b.ld)||(a.rows>a.ld)||(b.rows>b.ld))
+            return true;
+        const size_t dc=(b.tile-a.tile)/a.ld;
+        const size_t dr=(b.tile-a.tile)%a.ld;
+        return ((dr<a.rows)&&(dc<a.cols))||((dr+b.rows>a.ld)&&(dc+1<a.cols));
+    }
+
+    //  Order of the tiles in a task_graph, by address first.
+
+    struct tile_before
+    {
+        bool operator()(const tile_access &a, const tile_access &b) const
+        {
+            if(a.tile!=b.tile)
+                return a.tile<b.tile;
+            if(a.rows!=b.rows)
+                return a.rows<b.rows;
+            if(a.ld!=b.ld)
+                return a.ld<b.ld;
+            return a.cols<b.cols;
+        }
+    };
+
+    class task_graph
+    {
+    public:
+        task_graph() : span(0)
+        {
+        }
+
+        ~task_graph()
+        {
+            wait();
+        }
+
+        //  Queues f(), to run after every task queued before it that
+        //  writes a tile overlapping one in data, or reads a tile that
+        //  overlaps one it writes.  A tile can only overlap the tiles that
+        //  start less than the largest span of a tile before it, so those
+        //  are the only ones compared.
+
+        template <typename F>
+        void submit(F f, const std::vector<tile_access> &data)
+        {
+            const size_t id=tasks.size();
+            tasks.push_back(std::unique_ptr<task>(new task(f)));
+            task &t=*tasks.back();
+            auto after=[&](size_t p)
+            {
+                task &q=*tasks[p];
+                if(p==id)
+                    return;
+                if(q.next.empty()||(q.next.back()!=id))
+                {
+                    q.next.push_back(id);
+                    t.deps++;
+                }
+            };
+            for(size_t i=0;i<data.size();i++)
+            {
+                const tile_access &d=data[i];
+                if((d.rows==0)||(d.cols==0))
+                    continue;
+                span=std::max(span,tile_span(d));
+                const tile_access first={(d.tile>span)?d.tile-span:0,0,0,0,false};
+                for(auto p=tiles.lower_bound(first);(p!=tiles.end())&&(p->first.tile<d.tile+tile_span(d));++p)
+                {
+                    if(!tile_overlap(p->first,d))
+                        continue;
+                    const tile_state &s=p->second;
+                    if(s.written)
+                        after(s.writer);
+                    if(d.write)
+                        for(size_t r=0;r<s.readers.size();r++)
+                            after(s.readers[r]);
+                }
+                tile_state &s=tiles[d];
+                if(d.write)
+                {
+                    s.readers.clear();
+                    s.writer=id;
+                    s.written=true;
+                }
+                else
+                    s.readers.push_back(id);
+            }
+        }
+
+        //  Runs every task queued so far.
+
+        void wait()
+        {
+            if(tasks.empty())
+                return;
+            const size_t nthreads=threads();
+            while(queues.size()<nthreads)
+                queues.push_back(std::unique_ptr<steal_deque>(new steal_deque));
+            for(size_t w=0;w<nthreads;w++)
+                queues[w]->reset(tasks.size());
+            size_t w=0;
+            for(size_t i=0;i<tasks.size();i++)
+            {
+                tasks[i]->left=tasks[i]->deps;
+                if(tasks[i]->deps==0)
+                {
+                    queues[w]->push(i);
+                    w=(w+1)%nthreads;
+                }
+            }
+            done=0;
+            if(counters *stats=this_context().stats)
+                stats->graph_tasks+=tasks.size();
+            if(nthreads==1)
+                work(0,1);
+            else
+            {
+                auto worker=[this,nthreads](size_t self){ work(self,nthreads); };
+                thread_pool::instance().run(nthreads,worker);
+            }
+            tasks.clear();
+            tiles.clear();
+            span=0;
+        }
+
+    private:
+        task_graph(const task_graph &);
+        task_graph &operator=(const task_graph &);
+
+        struct task
+        {
+            template <typename F>
+            explicit task(F f) : run(f), deps(0), left(0)
+            {
+            }
+
+            std::function<void()> run;
+            std::vector<size_t> next;
+            size_t deps;
+            std::atomic<size_t> left;
+        };
+
+        struct tile_state
+        {
+            tile_state() : writer(0), written(false)
+            {
+            }
+
+            size_t writer;
+            bool written;
+            std::vector<size_t> readers;
+        };
+
+        void work(size_t self, size_t nthreads)
+        {
+            const size_t total=tasks.size();
+            steal_deque &own=*queues[self];
+            while(done.load()<total)
+            {
+                size_t t;
+                bool found=own.pop(t);
+                for(size_t v=1;(v<nthreads)&&!found;v++)
+                    found=queues[(self+v)%nthreads]->steal(t);
+                if(!found)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                task &p=*tasks[t];
+                p.run();
+                for(size_t i=0;i<p.next.size();i++)
+                    if(tasks[p.next[i]]->left.fetch_sub(1)==1)
+                        own.push(p.next[i]);
+                done.fetch_add(1);
+            }
+        }
+
+        std::vector<std::unique_ptr<task> > tasks;
+        std::map<tile_access,tile_state,tile_before> tiles;
+        size_t span;
+        std::vector<std::unique_ptr<steal_deque> > queues;
+        std::atomic<size_t> done;
+    };
+}
+#endif
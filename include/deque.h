@@ -0,0 +1,111 @@
+//
+//  deque.h
+//
+//  Purpose
+//  =======
+//
+//  Lock-free work-stealing deque of task numbers for the scheduler of
+//  dag.h, after Chase and Lev, "Dynamic circular work-stealing deque"
+//  (SPAA 2005), in the form given for the C11 memory model by Le, Pop,
+//  Cohen and Zappa Nardelli (PPoPP 2013).
+//
+//  The thread that owns the deque pushes and pops at its bottom, so it
+//  keeps working on the tasks it made ready most recently, whose tiles are
+//  still in its cache; other threads steal from the top, taking the oldest
+//  tasks.  Neither end takes a lock: the owner and the thieves only have to
+//  agree, by one compare-and-swap on the top, when they race for the last
+//  task.  A thief that loses a race returns empty-handed and tries again.
+//
+//  The task graph knows how many tasks it will run, so the deque is given
+//  room for all of them up front and is never grown.
+//
+
+#ifndef __deque__
+#define __deque__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    class steal_deque
+    {
+    public:
+        steal_deque() : size(0), top(0), bottom(0)
+        {
+        }
+
+        //  Empties the deque and makes room for n pushes.
+
+        void reset(size_t n)
+        {
+            if(n>size)
+            {
+                items.reset(new std::atomic<size_t>[n]);
+                size=n;
+            }
+            top.store(0,std::memory_order_relaxed);
+            bottom.store(0,std::memory_order_relaxed);
+        }
+
+        //  Adds t at the bottom; owner only.
+
+        void push(size_t t)
+        {
+            const ptrdiff_t b=bottom.load(std::memory_order_relaxed);
+            items[b].store(t,std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b+1,std::memory_order_relaxed);
+        }
+
+        //  Takes the task at the bottom; owner only.
+
+        bool pop(size_t &t)
+        {
+            const ptrdiff_t b=bottom.load(std::memory_order_relaxed)-1;
+            bottom.store(b,std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            ptrdiff_t s=top.load(std::memory_order_relaxed);
+            if(s>b)
+            {
+                bottom.store(b+1,std::memory_order_relaxed);
+                return false;
+            }
+            t=items[b].load(std::memory_order_relaxed);
+            if(s==b)
+            {
+                const bool won=top.compare_exchange_strong(s,s+1,std::memory_order_seq_cst,std::memory_order_relaxed);
+                bottom.store(b+1,std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        //  Takes the task at the top; any thread.
+
+        bool steal(size_t &t)
+        {
+            ptrdiff_t s=top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const ptrdiff_t b=bottom.load(std::memory_order_acquire);
+            if(s>=b)
+                return false;
+            t=items[s].load(std::memory_order_relaxed);
+            return top.compare_exchange_strong(s,s+1,std::memory_order_seq_cst,std::memory_order_relaxed);
+        }
+
+    private:
+        steal_deque(const steal_deque &);
+        steal_deque &operator=(const steal_deque &);
+
+        std::unique_ptr<std::atomic<size_t>[]> items;
+        size_t size;
+        std::atomic<ptrdiff_t> top;
+        std::atomic<ptrdiff_t> bottom;
+    };
+}
+#endif
@@ -26,12 +26,20 @@
 //
 //  incy    stride of vector y; if negative, y is stored in reverse order
 //
+//  Complex vectors take the kernel of dotc.h without the conjugate.
+//
 
 #ifndef __dot__
 #define __dot__
 
+#include <complex>
 #include <cstddef>
+#include "cplx.h"
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
 
+using std::complex;
 using std::size_t;
 using std::ptrdiff_t;
 
@@ -58,5 +66,17 @@ namespace tblas
         }
         return sum;
     }
+
+    template <typename T>
+    complex<T> dot(size_t n, complex<T> sum, complex<T> *x, ptrdiff_t incx, complex<T> *y, ptrdiff_t incy)
+    {
+        x=origin(x,n,incx);
+        y=origin(y,n,incy);
+        return parallel_sum(n,profile<complex<T> >().l1,sum,[=](size_t begin, size_t end)
+        {
+            const ptrdiff_t b=static_cast<ptrdiff_t>(begin);
+            return cdot<false>(static_cast<ptrdiff_t>(end-begin),x+b*incx,incx,y+b*incy,incy);
+        });
+    }
 }
 #endif
@@ -26,12 +26,20 @@
 //
 //  incy    stride of vector y; if negative, y is stored in reverse order
 //
+//  The products are formed from the real and imaginary parts and summed
+//  in separate lanes (see cplx.h), and long vectors are split over the
+//  thread pool.
+//
 
 #ifndef __dotc__
 #define __dotc__
 
 #include <complex>
 #include <cstddef>
+#include "cplx.h"
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -42,23 +50,13 @@ namespace tblas
     template <typename T>
     complex<T> dotc(size_t n, complex<T> sum, complex<T> *x, ptrdiff_t incx, complex<T> *y, ptrdiff_t incy)
     {
-        if((incx==1)&&(incy==1))
-        {
-            for(size_t i=0;i<n;i++)
-                sum+=conj(x[i])*y[i];
-        }
-        else
+        x=origin(x,n,incx);
+        y=origin(y,n,incy);
+        return parallel_sum(n,profile<complex<T> >().l1,sum,[=](size_t begin, size_t end)
         {
-            size_t ix=incx>0?0:(1-n)*incx;
-            size_t iy=incy>0?0:(1-n)*incy;
-            for(size_t i=0;i<n;i++)
-            {
-                sum+=conj(x[ix])*y[iy];
-                ix+=incx;
-                iy+=incy;
-            }
-        }
-        return sum;
+            const ptrdiff_t b=static_cast<ptrdiff_t>(begin);
+            return cdot<true>(static_cast<ptrdiff_t>(end-begin),x+b*incx,incx,y+b*incy,incy);
+        });
     }
 }
 #endif
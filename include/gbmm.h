@@ -0,0 +1,99 @@
+//
+//  gbmm.h
+//
+//  Purpose
+//  =======
+//
+//  Performs one of the matrix-matrix operations:
+//
+//      C <- alpha * A   * B + beta * C  [trans='N']
+//
+//      C <- alpha * A^T * B + beta * C  [trans='T']
+//
+//      C <- alpha * A^H * B + beta * C  [trans='C']
+//
+//  where alpha and beta are scalars, B and C are dense matrices and A is a
+//  band matrix, with kl sub-diagonals and ku super-diagonals, so that op(A)
+//  is m-by-k.  The band is applied to blocks of columns of B at a time, so
+//  it is read once per block rather than once per column (see band.h).
+//
+//  Arguments
+//  ==========
+//
+//  trans   specifies the transpose operation for A as above
+//
+//  m       specifies the number of rows of op(A) and C
+//
+//  n       specifies the number of columns of B and C
+//
+//  k       specifies the number of columns of op(A) and rows of B
+//
+//  kl      specifies the number of sub-diagonals of the matrix A
+//
+//  ku      specifies the number of super-diagonals of the matrix A
+//
+//  alpha   scalar multiple of the matrix-matrix product
+//
+//  A       band matrix stored as (kl+ku+1)-by-k array if trans='N', or
+//          (kl+ku+1)-by-m array otherwise
+//
+//  ldA     specifies the column length of A, must be at least kl+ku+1
+//
+//  B       matrix of size k-by-n
+//
+//  ldB     column length of the matrix B, must be at least k
+//
+//  beta    scalar multiple of C
+//
+//  C       matrix of size m-by-n
+//
+//  ldC     column length of the matrix C, must be at least m
+//
+
+#ifndef __gbmm__
+#define __gbmm__
+
+#include <complex>
+#include <cstddef>
+#include "band.h"
+
+using std::complex;
+using std::size_t;
+
+namespace tblas
+{
+    template <typename T>
+    void gbmm(char trans, size_t m, size_t n, size_t k, size_t kl, size_t ku, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+
+        if((m==0)||(n==0))
+            return;
+
+        if((alpha==zero)||(k==0))
+            band_scale(m,n,beta,C,ldC);
+        else if(trans=='N')
+            parallel_band_mm(m,n,k,kl,ku,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return A[ku+i-j+j*ldA]; });
+        else
+            parallel_band_mm(m,n,k,ku,kl,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return A[ku+j-i+i*ldA]; });
+    }
+
+    template <typename T>
+    void gbmm(char trans, size_t m, size_t n, size_t k, size_t kl, size_t ku, complex<T> alpha, complex<T> *A, size_t ldA, complex<T> *B, size_t ldB, complex<T> beta, complex<T> *C, size_t ldC)
+    {
+        const complex<T> zero(0.0);
+
+        if((m==0)||(n==0))
+            return;
+
+        if((alpha==zero)||(k==0))
+            band_scale(m,n,beta,C,ldC);
+        else if(trans=='N')
+            parallel_band_mm(m,n,k,kl,ku,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return A[ku+i-j+j*ldA]; });
+        else if(trans=='T')
+            parallel_band_mm(m,n,k,ku,kl,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return A[ku+j-i+i*ldA]; });
+        else
+            parallel_band_mm(m,n,k,ku,kl,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return conj(A[ku+j-i+i*ldA]); });
+    }
+}
+#endif
@@ -48,8 +48,12 @@
 #ifndef __gbmv__
 #define __gbmv__
 
-#include <cstddef>
 #include <complex>
+#include <cstddef>
+#include <vector>
+#include "band.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -67,7 +71,6 @@ namespace tblas
 
         size_t lenx=(trans=='N')?n:m;
         size_t leny=(trans=='N')?m:n;
-        size_t kx=(incx>0)?0:(1-lenx)*incx;
         size_t ky=(incy>0)?0:(1-leny)*incy;
         
         if(beta==zero)
@@ -108,84 +111,28 @@ namespace tblas
         
         if(alpha!=zero)
         {
-            if(trans=='N')
+            std::vector<T> t;
+            std::vector<T> v;
+            const T *u=x;
+            if((incx!=1)||(alpha!=one))
             {
-                size_t jx=kx;
-                if(incy==1)
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[jx];
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                            y[i]+=temp*A[k+i];
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[jx];
-                        size_t iy=ky;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                        {
-                            y[iy]+=temp*A[k+i];
-                            iy+=incy;
-                        }
-                        A+=ldA;
-                        jx+=incx;
-                        if(j>=ku)
-                            ky+=incy;
-                    }
-                }
+                gather(lenx,x,incx,t);
+                for(size_t j=0;j<lenx;j++)
+                    t[j]*=alpha;
+                u=t.data();
             }
-            else
+            T *w=y;
+            if(incy!=1)
             {
-                size_t jy=ky;
-                if(incx==1)
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=zero;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                            temp+=A[k+i]*x[i];
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                    }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=zero;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        size_t ix=kx;
-                        for(size_t i=i0;i<im;i++)
-                        {
-                            temp+=A[k+i]*x[ix];
-                            ix+=incx;
-                        }
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                        if(j>=ku)
-                            kx+=incx;
-                    }
-                }
+                gather(leny,y,incy,v);
+                w=v.data();
             }
+            parallel_band(leny,kl+ku+1,profile<T>().l2,[=](size_t o0, size_t o1)
+            {
+                band_mv(trans,m,n,ku,-static_cast<ptrdiff_t>(ku),kl,A,ldA,u,w,o0,o1,[](T a){ return a; });
+            });
+            if(incy!=1)
+                scatter(leny,w,y,incy);
         }
     }
     
@@ -199,7 +146,6 @@ namespace tblas
 
         size_t lenx=(trans=='N')?n:m;
         size_t leny=(trans=='N')?m:n;
-        size_t kx=(incx>0)?0:(1-lenx)*incx;
         size_t ky=(incy>0)?0:(1-leny)*incy;
         
         if(beta==zero)
@@ -240,124 +186,31 @@ namespace tblas
         
         if(alpha!=zero)
         {
-            if(trans=='N')
+            std::vector<complex<T> > t;
+            std::vector<complex<T> > v;
+            const complex<T> *u=x;
+            if((incx!=1)||(alpha!=one))
             {
-                size_t jx=kx;
-                if(incy==1)
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[jx];
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                            y[i]+=temp*A[k+i];
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[jx];
-                        size_t iy=ky;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                        {
-                            y[iy]+=temp*A[k+i];
-                            iy+=incy;
-                        }
-                        A+=ldA;
-                        jx+=incx;
-                        if(j>=ku)
-                            ky+=incy;
-                    }
-                }
+                gather(lenx,x,incx,t);
+                for(size_t j=0;j<lenx;j++)
+                    t[j]*=alpha;
+                u=t.data();
             }
-            else if(trans=='T')
+            complex<T> *w=y;
+            if(incy!=1)
             {
-                size_t jy=ky;
-                if(incx==1)
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=zero;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                            temp+=A[k+i]*x[i];
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                    }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=zero;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        size_t ix=kx;
-                        for(size_t i=i0;i<im;i++)
-                        {
-                            temp+=A[k+i]*x[ix];
-                            ix+=incx;
-                        }
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                        if(j>=ku)
-                            kx+=incx;
-                    }
-                }
+                gather(leny,y,incy,v);
+                w=v.data();
             }
-            else if(trans=='C')
+            parallel_band(leny,kl+ku+1,profile<complex<T> >().l2,[=](size_t o0, size_t o1)
             {
-                size_t jy=ky;
-                if(incx==1)
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=zero;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        for(size_t i=i0;i<im;i++)
-                            temp+=conj(A[k+i])*x[i];
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                    }
-                }
+                if(trans=='C')
+                    band_mv(trans,m,n,ku,-static_cast<ptrdiff_t>(ku),kl,A,ldA,u,w,o0,o1,[](complex<T> a){ return conj(a); });
                 else
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=zero;
-                        size_t k=ku-j;
-                        size_t i0=(j>ku)?j-ku:0;
-                        size_t im=(j+kl<m)?j+kl+1:m;
-                        size_t ix=kx;
-                        for(size_t i=i0;i<im;i++)
-                        {
-                            temp+=conj(A[k+i])*x[ix];
-                            ix+=incx;
-                        }
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                        if(j>=ku)
-                            kx+=incx;
-                    }
-                }
-            }
+                    band_mv(trans,m,n,ku,-static_cast<ptrdiff_t>(ku),kl,A,ldA,u,w,o0,o1,[](complex<T> a){ return a; });
+            });
+            if(incy!=1)
+                scatter(leny,w,y,incy);
         }
     }
 
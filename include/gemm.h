@@ -52,18 +52,36 @@
 //  ldB     column length of the matrix B, must be ast least k if transB='N',
 //          or at least n otherwise
 //
-//  beta    scalar multiple of C
+//  beta    scalar multiple of C; if zero, C need not be set on entry
 //
 //  C       matrix of size m-by-n
 //
 //  ldC     column length of the matrix C, must be at least m
 //
+//  If C has more entries than the stream parameter of tune.h, the scaling
+//  by beta is split over the thread pool, and for beta=0 C is cleared
+//  with non-temporal stores (see stream.h).
+//
+//  The columns of C, and with them those of op(B), are split over the
+//  thread pool in contiguous ranges that follow the placement of the
+//  threads on the NUMA nodes (see affinity.h), so with TBLAS_AFFINITY set
+//  each node mostly works on columns that were first touched there.
+//
+//  gemm(g,...) queues the product on the task graph g as tile tasks
+//  instead of computing it (see dag.h).
+//
 
 #ifndef __gemm__
 #define __gemm__
 
-#include <cstddef>
+#include <algorithm>
 #include <complex>
+#include <cstddef>
+#include <vector>
+#include "dag.h"
+#include "stream.h"
+#include "thread.h"
+#include "tune.h"
 
 using std::size_t;
 using std::complex;
@@ -71,344 +89,382 @@ using std::complex;
 namespace tblas
 {
     template <typename T>
-    void gemm(char transA, char transB, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
+    inline T conjugate(T a)
+    {
+        return a;
+    }
+
+    template <typename T>
+    inline complex<T> conjugate(complex<T> a)
+    {
+        return conj(a);
+    }
+
+    template <typename T>
+    inline T real_part(T a)
+    {
+        return a;
+    }
+
+    template <typename T>
+    inline complex<T> real_part(complex<T> a)
+    {
+        return complex<T>(a.real());
+    }
+
+    template <typename T>
+    T *gemm_workspace(size_t size)
+    {
+        static thread_local std::vector<T> work;
+        if(work.size()<size)
+            work.resize(size);
+        return work.data();
+    }
+
+    template <typename T>
+    void gemm_pack_a(char trans, size_t mc, size_t kc, size_t mr, T *A, size_t ldA, T *Ap)
     {
         const T zero(0.0);
-        const T one(1.0);
-        
-        if((m==0)||(n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
-            return;
-        
-        if(alpha==zero)
+
+        for(size_t i0=0;i0<mc;i0+=mr)
         {
-            T *c=C;
-            if(beta==zero)
+            const size_t mb=std::min(mr,mc-i0);
+            if(trans=='N')
             {
-                for(size_t j=0;j<n;j++)
+                T *a=A+i0;
+                for(size_t l=0;l<kc;l++)
                 {
-                    for(size_t i=0;i<m;i++)
-                        c[i]=zero;
-                    c+=ldC;
+                    for(size_t i=0;i<mb;i++)
+                        Ap[i]=a[i];
+                    for(size_t i=mb;i<mr;i++)
+                        Ap[i]=zero;
+                    Ap+=mr;
+                    a+=ldA;
                 }
             }
             else
             {
-                for(size_t j=0;j<n;j++)
+                T *a=A+i0*ldA;
+                for(size_t l=0;l<kc;l++)
                 {
-                    for(size_t i=0;i<m;i++)
-                        c[i]*=beta;
-                    c+=ldC;
-                }
-            }
-        }
-        else if((transA=='N')&&(transB=='N'))
-        {
-            T *c=C;
-            T *b=B;
-            for(size_t j=0;j<n;j++)
-            {
-                for(size_t i=0;i<m;i++)
-                    c[i]*=beta;
-                T *a=A;
-                for(size_t l=0;l<k;l++)
-                {
-                    for(size_t i=0;i<m;i++)
+                    if(trans=='C')
                     {
-                        c[i]+=alpha*b[l]*a[i];
+                        for(size_t i=0;i<mb;i++)
+                            Ap[i]=conjugate(a[l+i*ldA]);
                     }
-                    a+=ldA;
-                }
-                b+=ldB;
-                c+=ldC;
-            }
-        }
-        else if((transA=='T')&&(transB=='N'))
-        {
-            T *b=B;
-            T *c=C;
-            for(size_t j=0;j<n;j++)
-            {
-                T *a=A;
-                for(size_t i=0;i<m;i++)
-                {
-                    T s=zero;
-                    for(size_t l=0;l<k;l++)
+                    else
                     {
-                        s+=a[l]*b[l];
+                        for(size_t i=0;i<mb;i++)
+                            Ap[i]=a[l+i*ldA];
                     }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
+                    for(size_t i=mb;i<mr;i++)
+                        Ap[i]=zero;
+                    Ap+=mr;
                 }
-                b+=ldB;
-                c+=ldC;
             }
         }
-        else if((transA=='N')&&(transB=='T'))
+    }
+
+    template <typename T>
+    void gemm_pack_b(char trans, size_t kc, size_t nc, size_t nr, T *B, size_t ldB, T *Bp)
+    {
+        const T zero(0.0);
+
+        for(size_t j0=0;j0<nc;j0+=nr)
         {
-            T *c=C;
-            for(size_t j=0;j<n;j++)
+            const size_t nb=std::min(nr,nc-j0);
+            if(trans=='N')
             {
-                for(size_t i=0;i<m;i++)
-                    c[i]*=beta;
-                T *a=A;
-                T *b=B;
-                for(size_t l=0;l<k;l++)
+                T *b=B+j0*ldB;
+                for(size_t l=0;l<kc;l++)
                 {
-                    T t=alpha*b[j];
-                    for(size_t i=0;i<m;i++)
-                    {
-                        c[i]+=t*a[i];
-                    }
-                    a+=ldA;
-                    b+=ldB;
+                    for(size_t j=0;j<nb;j++)
+                        Bp[j]=b[l+j*ldB];
+                    for(size_t j=nb;j<nr;j++)
+                        Bp[j]=zero;
+                    Bp+=nr;
                 }
-                c+=ldC;
             }
-        }
-        else if((transA=='T')&&(transB=='T'))
-        {
-            T *c=C;
-            for(size_t j=0;j<n;j++)
+            else
             {
-                T *a=A;
-                for(size_t i=0;i<m;i++)
+                T *b=B+j0;
+                for(size_t l=0;l<kc;l++)
                 {
-                    T s=zero;
-                    T *b=B;
-                    for(size_t l=0;l<k;l++)
+                    if(trans=='C')
                     {
-                        s+=a[l]*b[j];
-                        b+=ldB;
+                        for(size_t j=0;j<nb;j++)
+                            Bp[j]=conjugate(b[j]);
                     }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
+                    else
+                    {
+                        for(size_t j=0;j<nb;j++)
+                            Bp[j]=b[j];
+                    }
+                    for(size_t j=nb;j<nr;j++)
+                        Bp[j]=zero;
+                    Bp+=nr;
+                    b+=ldB;
                 }
-                c+=ldC;
             }
-            
         }
     }
 
-    template <typename T>
-    void gemm(char transA, char transB, size_t m, size_t n, size_t k, complex<T> alpha, complex<T> *A, size_t ldA, complex<T> *B, size_t ldB, complex<T> beta, complex<T> *C, size_t ldC)
+    //  C <- alpha * a * b + beta * C for an mb-by-nb block of C, where a and
+    //  b are packed panels of depth kc and beta=0 overwrites C.
+
+    template <typename T, size_t MR, size_t NR>
+    void gemm_micro_kernel(size_t kc, T alpha, T *a, T *b, T beta, T *C, size_t ldC, size_t mb, size_t nb)
     {
-        const complex<T> zero(0.0);
-        const complex<T> one(1.0);
-        
-        if((m==0)||(n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
-            return;
-        
-        if(alpha==zero)
+        const T zero(0.0);
+        const T one(1.0);
+
+        T ab[MR*NR];
+        for(size_t i=0;i<MR*NR;i++)
+            ab[i]=zero;
+        for(size_t l=0;l<kc;l++)
+        {
+            for(size_t j=0;j<NR;j++)
+            {
+                const T t=b[j];
+                for(size_t i=0;i<MR;i++)
+                    ab[i+j*MR]+=a[i]*t;
+            }
+            a+=MR;
+            b+=NR;
+        }
+        for(size_t j=0;j<nb;j++)
         {
-            complex<T> *c=C;
             if(beta==zero)
             {
-                for(size_t j=0;j<n;j++)
-                {
-                    for(size_t i=0;i<m;i++)
-                        c[i]=zero;
-                    c+=ldC;
-                }
+                for(size_t i=0;i<mb;i++)
+                    C[i]=alpha*ab[i+j*MR];
+            }
+            else if(beta==one)
+            {
+                for(size_t i=0;i<mb;i++)
+                    C[i]+=alpha*ab[i+j*MR];
             }
             else
             {
-                for(size_t j=0;j<n;j++)
-                {
-                    for(size_t i=0;i<m;i++)
-                        c[i]*=beta;
-                    c+=ldC;
-                }
+                for(size_t i=0;i<mb;i++)
+                    C[i]=alpha*ab[i+j*MR]+beta*C[i];
             }
+            C+=ldC;
         }
-        else if((transA=='N')&&(transB=='N'))
+    }
+
+    template <typename T, size_t MR, size_t NR>
+    void gemm_macro_kernel(size_t mc, size_t nc, size_t kc, T alpha, T *Ap, T *Bp, T beta, T *C, size_t ldC)
+    {
+        for(size_t j0=0;j0<nc;j0+=NR)
         {
-            complex<T> *c=C;
-            complex<T> *b=B;
-            for(size_t j=0;j<n;j++)
+            const size_t nb=std::min(NR,nc-j0);
+            for(size_t i0=0;i0<mc;i0+=MR)
             {
-                for(size_t i=0;i<m;i++)
-                    c[i]*=beta;
-                complex<T> *a=A;
-                for(size_t l=0;l<k;l++)
-                {
-                    for(size_t i=0;i<m;i++)
-                    {
-                        c[i]+=alpha*b[l]*a[i];
-                    }
-                    a+=ldA;
-                }
-                b+=ldB;
-                c+=ldC;
+                const size_t mb=std::min(MR,mc-i0);
+                gemm_micro_kernel<T,MR,NR>(kc,alpha,Ap+i0*kc,Bp+j0*kc,beta,C+i0+j0*ldC,ldC,mb,nb);
             }
         }
-        else if((transA=='T')&&(transB=='N'))
+    }
+
+    //  The scaling by beta is applied as each block of C is first written,
+    //  for the first block of the inner dimension, so C is read and written
+    //  once per block of kc instead of once more by a separate pass.
+
+    template <typename T, size_t MR, size_t NR>
+    void gemm_blocked(char transA, char transB, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC, const tuning &bs)
+    {
+        const T one(1.0);
+        const size_t mc=std::min(bs.mc,(m+MR-1)/MR*MR);
+        const size_t nc=std::min(bs.nc,(n+NR-1)/NR*NR);
+        const size_t kc=std::min(bs.kc,k);
+
+        T *Bp=gemm_workspace<T>(mc*kc+kc*nc);
+        T *Ap=Bp+kc*nc;
+
+        for(size_t jc=0;jc<n;jc+=nc)
         {
-            complex<T> *b=B;
-            complex<T> *c=C;
-            for(size_t j=0;j<n;j++)
+            const size_t nn=std::min(nc,n-jc);
+            for(size_t pc=0;pc<k;pc+=kc)
             {
-                complex<T> *a=A;
-                for(size_t i=0;i<m;i++)
+                const size_t kk=std::min(kc,k-pc);
+                T *b=(transB=='N')?B+pc+jc*ldB:B+jc+pc*ldB;
+                gemm_pack_b(transB,kk,nn,NR,b,ldB,Bp);
+                for(size_t ic=0;ic<m;ic+=mc)
                 {
-                    complex<T> s=zero;
-                    for(size_t l=0;l<k;l++)
-                    {
-                        s+=a[l]*b[l];
-                    }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
+                    const size_t mm=std::min(mc,m-ic);
+                    T *a=(transA=='N')?A+ic+pc*ldA:A+pc+ic*ldA;
+                    gemm_pack_a(transA,mm,kk,MR,a,ldA,Ap);
+                    gemm_macro_kernel<T,MR,NR>(mm,nn,kk,alpha,Ap,Bp,(pc==0)?beta:one,C+ic+jc*ldC,ldC);
                 }
-                b+=ldB;
-                c+=ldC;
             }
         }
-        else if((transA=='C')&&(transB=='N'))
+    }
+
+    //  C <- beta * C for the m-by-n matrix C, where beta=0 clears C.
+
+    template <typename T>
+    void gemm_scale(size_t m, size_t n, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((beta==one)||stream_scale(m,n,beta,C,ldC))
+            return;
+
+        T *c=C;
+        if(beta==zero)
         {
-            complex<T> *b=B;
-            complex<T> *c=C;
             for(size_t j=0;j<n;j++)
             {
-                complex<T> *a=A;
                 for(size_t i=0;i<m;i++)
-                {
-                    complex<T> s=zero;
-                    for(size_t l=0;l<k;l++)
-                    {
-                        s+=conj(a[l])*b[l];
-                    }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
-                }
-                b+=ldB;
+                    c[i]=zero;
                 c+=ldC;
             }
         }
-        else if((transA=='N')&&(transB=='T'))
+        else
         {
-            complex<T> *c=C;
             for(size_t j=0;j<n;j++)
             {
                 for(size_t i=0;i<m;i++)
                     c[i]*=beta;
-                complex<T> *a=A;
-                complex<T> *b=B;
-                for(size_t l=0;l<k;l++)
-                {
-                    complex<T> t=alpha*b[j];
-                    for(size_t i=0;i<m;i++)
-                    {
-                        c[i]+=t*a[i];
-                    }
-                    a+=ldA;
-                    b+=ldB;
-                }
                 c+=ldC;
             }
         }
-        else if((transA=='N')&&(transB=='C'))
+    }
+
+    //  Computes C <- alpha * op(A) * op(B) + beta * C using the tuning
+    //  parameters bs, where beta=0 overwrites C.  The columns of C are
+    //  split over the thread pool, at least l2 multiply-adds per thread.
+
+    template <typename T>
+    void gemm_blocked(char transA, char transB, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC, const tuning &bs)
+    {
+        if((m==0)||(n==0))
+            return;
+
+        if(k==0)
         {
-            complex<T> *c=C;
-            for(size_t j=0;j<n;j++)
-            {
-                for(size_t i=0;i<m;i++)
-                    c[i]*=beta;
-                complex<T> *a=A;
-                complex<T> *b=B;
-                for(size_t l=0;l<k;l++)
-                {
-                    complex<T> t=alpha*conj(b[j]);
-                    for(size_t i=0;i<m;i++)
-                    {
-                        c[i]+=t*a[i];
-                    }
-                    a+=ldA;
-                    b+=ldB;
-                }
-                c+=ldC;
-            }
+            gemm_scale(m,n,beta,C,ldC);
+            return;
         }
-        else if((transA=='T')&&(transB=='T'))
+
+        auto part=[&](size_t begin, size_t end)
         {
-            complex<T> *c=C;
-            for(size_t j=0;j<n;j++)
+            const size_t nn=end-begin;
+            T *b=(transB=='N')?B+begin*ldB:B+begin;
+            T *c=C+begin*ldC;
+            if(bs.nr==4)
             {
-                complex<T> *a=A;
-                for(size_t i=0;i<m;i++)
-                {
-                    complex<T> s=zero;
-                    complex<T> *b=B;
-                    for(size_t l=0;l<k;l++)
-                    {
-                        s+=a[l]*b[j];
-                        b+=ldB;
-                    }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
-                }
-                c+=ldC;
+                if(bs.mr==4)
+                    gemm_blocked<T,4,4>(transA,transB,m,nn,k,alpha,A,ldA,b,ldB,beta,c,ldC,bs);
+                else if(bs.mr==8)
+                    gemm_blocked<T,8,4>(transA,transB,m,nn,k,alpha,A,ldA,b,ldB,beta,c,ldC,bs);
+                else
+                    gemm_blocked<T,16,4>(transA,transB,m,nn,k,alpha,A,ldA,b,ldB,beta,c,ldC,bs);
             }
-        }
-        else if((transA=='C')&&(transB=='T'))
-        {
-            complex<T> *c=C;
-            for(size_t j=0;j<n;j++)
+            else
             {
-                complex<T> *a=A;
-                for(size_t i=0;i<m;i++)
-                {
-                    complex<T> s=zero;
-                    complex<T> *b=B;
-                    for(size_t l=0;l<k;l++)
-                    {
-                        s+=conj(a[l])*b[j];
-                        b+=ldB;
-                    }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
-                }
-                c+=ldC;
+                if(bs.mr==4)
+                    gemm_blocked<T,4,6>(transA,transB,m,nn,k,alpha,A,ldA,b,ldB,beta,c,ldC,bs);
+                else if(bs.mr==8)
+                    gemm_blocked<T,8,6>(transA,transB,m,nn,k,alpha,A,ldA,b,ldB,beta,c,ldC,bs);
+                else
+                    gemm_blocked<T,16,6>(transA,transB,m,nn,k,alpha,A,ldA,b,ldB,beta,c,ldC,bs);
             }
-        }
-        else if((transA=='T')&&(transB=='C'))
+        };
+        parallel_for(n,std::max(bs.nr,bs.l2/(m*k)),part);
+    }
+
+    //  Computes C <- alpha * op(A) * op(B) + C on the upper or lower triangle
+    //  of the order n matrix C only.  Each block column adds its off-diagonal
+    //  part directly and its diagonal block by way of a dense product in
+    //  workspace.  If hermitian is set the diagonal of C is kept real.
+
+    template <typename T>
+    void gemm_triangle(char uplo, char transA, char transB, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T *C, size_t ldC, bool hermitian)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((n==0)||(k==0))
+            return;
+
+        const tuning &bs=profile<T>();
+        const size_t nb=bs.mc;
+        std::vector<T> D(nb*nb);
+        for(size_t j0=0;j0<n;j0+=nb)
         {
-            complex<T> *c=C;
-            for(size_t j=0;j<n;j++)
+            const size_t jb=std::min(nb,n-j0);
+            T *a=(transA=='N')?A+j0:A+j0*ldA;
+            T *b=(transB=='N')?B+j0*ldB:B+j0;
+            T *c=C+j0+j0*ldC;
+            if((uplo=='U')&&(j0>0))
+                gemm_blocked(transA,transB,j0,jb,k,alpha,A,ldA,b,ldB,one,C+j0*ldC,ldC,bs);
+            else if((uplo=='L')&&(j0+jb<n))
+                gemm_blocked(transA,transB,n-j0-jb,jb,k,alpha,(transA=='N')?a+jb:a+jb*ldA,ldA,b,ldB,one,c+jb,ldC,bs);
+            gemm_blocked(transA,transB,jb,jb,k,alpha,a,ldA,b,ldB,zero,D.data(),jb,bs);
+            for(size_t j=0;j<jb;j++)
             {
-                complex<T> *a=A;
-                for(size_t i=0;i<m;i++)
-                {
-                    complex<T> s=zero;
-                    complex<T> *b=B;
-                    for(size_t l=0;l<k;l++)
-                    {
-                        s+=a[l]*conj(b[j]);
-                        b+=ldB;
-                    }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
-                }
+                const T *d=D.data()+j*jb;
+                const size_t i0=(uplo=='U')?0:j+1;
+                const size_t i1=(uplo=='U')?j:jb;
+                for(size_t i=i0;i<i1;i++)
+                    c[i]+=d[i];
+                c[j]=hermitian?real_part(c[j]+d[j]):c[j]+d[j];
                 c+=ldC;
             }
         }
-        else if((transA=='C')&&(transB=='C'))
+    }
+
+    template <typename T>
+    void gemm(char transA, char transB, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+        
+        if((m==0)||(n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
+            return;
+        
+        if(alpha==zero)
+            gemm_scale(m,n,beta,C,ldC);
+        else
+            gemm_blocked(transA,transB,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC,profile<T>());
+    }
+
+    //  Queues the product on g as one chain of tasks per tile of C, each
+    //  task adding the product of one tile of op(A) and one of op(B).
+
+    template <typename T>
+    void gemm(task_graph &g, char transA, char transB, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((m==0)||(n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
+            return;
+
+        const size_t nb=tile_order<T>();
+        for(size_t j0=0;j0<n;j0+=nb)
         {
-            complex<T> *c=C;
-            for(size_t j=0;j<n;j++)
+            const size_t jb=std::min(nb,n-j0);
+            for(size_t i0=0;i0<m;i0+=nb)
             {
-                complex<T> *a=A;
-                for(size_t i=0;i<m;i++)
+                const size_t ib=std::min(nb,m-i0);
+                T *c=C+i0+j0*ldC;
+                if((alpha==zero)||(k==0))
                 {
-                    complex<T> s=zero;
-                    complex<T> *b=B;
-                    for(size_t l=0;l<k;l++)
-                    {
-                        s+=conj(a[l])*conj(b[j]);
-                        b+=ldB;
-                    }
-                    c[i]=alpha*s+beta*c[i];
-                    a+=ldA;
+                    g.submit([=]{ gemm_scale(ib,jb,beta,c,ldC); },{tile_write(c,ib,jb,ldC)});
+                    continue;
+                }
+                for(size_t l0=0;l0<k;l0+=nb)
+                {
+                    const size_t lb=std::min(nb,k-l0);
+                    T *a=(transA=='N')?A+i0+l0*ldA:A+l0+i0*ldA;
+                    T *b=(transB=='N')?B+l0+j0*ldB:B+j0+l0*ldB;
+                    const T s=(l0==0)?beta:one;
+                    g.submit([=]{ gemm_blocked(transA,transB,ib,jb,lb,alpha,a,ldA,b,ldB,s,c,ldC,profile<T>()); },{tile_read(transA,a,ib,lb,ldA),tile_read(transB,b,lb,jb,ldB),tile_write(c,ib,jb,ldC)});
                 }
-                c+=ldC;
             }
         }
     }
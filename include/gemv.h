@@ -40,12 +40,27 @@
 //
 //  incy    stride of vector y; if negative, y is stored in reverse order
 //
+//  If y has unit stride and is longer than the stream parameter of tune.h,
+//  the scaling by beta is split over the thread pool, and for beta=0 y is
+//  cleared with non-temporal stores (see stream.h).
+//
+//  The columns of A are split over the thread pool, in contiguous ranges
+//  that follow the placement of the threads on the NUMA nodes (see
+//  affinity.h).  For trans='N' each range beyond the first adds its
+//  products to a vector of its own, and these are added to y in order,
+//  so the result depends only on the number of threads.
+//
 
 #ifndef __gemv__
 #define __gemv__
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "stream.h"
+#include "thread.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -53,6 +68,50 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
+    //  y <- f(0,n) for the columns of A, where f(begin,end,y,ky,incy) adds
+    //  the products with columns begin to end-1 to the vector at y with
+    //  first element ky and stride incy.  The columns are split over the
+    //  thread pool; the first range adds to y directly, the others to
+    //  vectors of their own, which are then added to y in order.
+
+    template <typename T, typename F>
+    void gemv_split(size_t m, size_t n, size_t grain, T *y, size_t ky, ptrdiff_t incy, F f)
+    {
+        const T zero(0.0);
+        const size_t parts=reduction_parts(n,grain);
+        if(parts==1)
+        {
+            f(size_t(0),n,y,ky,incy);
+            return;
+        }
+        std::vector<T> partial((parts-1)*m,zero);
+        auto task=[&](size_t t)
+        {
+            size_t begin,end;
+            chunk(n,parts,t,begin,end);
+            if(begin>=end)
+                return;
+            if(t==0)
+                f(begin,end,y,ky,incy);
+            else
+                f(begin,end,partial.data()+(t-1)*m,size_t(0),ptrdiff_t(1));
+        };
+        parallel_parts(parts,task);
+        parallel_for(m,profile<T>().l1,[&](size_t begin, size_t end)
+        {
+            for(size_t t=1;t<parts;t++)
+            {
+                const T *p=partial.data()+(t-1)*m;
+                size_t iy=ky+begin*incy;
+                for(size_t i=begin;i<end;i++)
+                {
+                    y[iy]+=p[i];
+                    iy+=incy;
+                }
+            }
+        });
+    }
+
     template <typename T>
     void gemv(char trans, size_t m, size_t n, T alpha, T *A, size_t ldA, T *x, ptrdiff_t incx, T beta, T *y, ptrdiff_t incy)
     {
@@ -67,6 +126,8 @@ namespace tblas
         size_t kx=(incx>0)?0:(1-lenx)*incx;
         size_t ky=(incy>0)?0:(1-leny)*incy;
         
+        if((incy==1)&&(beta!=one)&&stream_scale(leny,size_t(1),beta,y,leny))
+            beta=one;
         if(beta==zero)
         {
             if(incy==1)
@@ -105,59 +166,68 @@ namespace tblas
         
         if(alpha!=zero)
         {
+            const size_t grain=std::max(size_t(1),profile<T>().l2/m);
             if(trans=='N')
             {
-                size_t jx=kx;
-                if(incy==1)
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[jx];
-                        for(size_t i=0;i<m;i++)
-                            y[i]+=temp*A[i];
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                else
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[jx];
-                        size_t iy=ky;
-                        for(size_t i=0;i<m;i++)
+                gemv_split(m,n,grain,y,ky,incy,[=](size_t begin, size_t end, T *y, size_t ky, ptrdiff_t incy)
+                {
+                    const T *a=A+begin*ldA;
+                    size_t jx=kx+begin*incx;
+                    if(incy==1)
+                        for(size_t j=begin;j<end;j++)
                         {
-                            y[iy]+=temp*A[i];
-                            iy+=incy;
+                            T temp=alpha*x[jx];
+                            for(size_t i=0;i<m;i++)
+                                y[i]+=temp*a[i];
+                            a+=ldA;
+                            jx+=incx;
                         }
-                        A+=ldA;
-                        jx+=incx;
-                    }
+                    else
+                        for(size_t j=begin;j<end;j++)
+                        {
+                            T temp=alpha*x[jx];
+                            size_t iy=ky;
+                            for(size_t i=0;i<m;i++)
+                            {
+                                y[iy]+=temp*a[i];
+                                iy+=incy;
+                            }
+                            a+=ldA;
+                            jx+=incx;
+                        }
+                });
             }
             else
             {
-                size_t jy=ky;
-                if(incx==1)
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=zero;
-                        for(size_t i=0;i<m;i++)
-                            temp+=A[i]*x[i];
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                    }
-                else
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=zero;
-                        size_t ix=kx;
-                        for(size_t i=0;i<m;i++)
+                parallel_for(n,grain,[=](size_t begin, size_t end)
+                {
+                    const T *a=A+begin*ldA;
+                    size_t jy=ky+begin*incy;
+                    if(incx==1)
+                        for(size_t j=begin;j<end;j++)
                         {
-                            temp+=A[i]*x[ix];
-                            ix+=incx;
+                            T temp=zero;
+                            for(size_t i=0;i<m;i++)
+                                temp+=a[i]*x[i];
+                            y[jy]+=alpha*temp;
+                            jy+=incy;
+                            a+=ldA;
                         }
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                    }
+                    else
+                        for(size_t j=begin;j<end;j++)
+                        {
+                            T temp=zero;
+                            size_t ix=kx;
+                            for(size_t i=0;i<m;i++)
+                            {
+                                temp+=a[i]*x[ix];
+                                ix+=incx;
+                            }
+                            y[jy]+=alpha*temp;
+                            jy+=incy;
+                            a+=ldA;
+                        }
+                });
             }
         }
     }
@@ -176,6 +246,8 @@ namespace tblas
         size_t kx=(incx>0)?0:(1-lenx)*incx;
         size_t ky=(incy>0)?0:(1-leny)*incy;
         
+        if((incy==1)&&(beta!=one)&&stream_scale(leny,size_t(1),beta,y,leny))
+            beta=one;
         if(beta==zero)
         {
             if(incy==1)
@@ -214,101 +286,89 @@ namespace tblas
         
         if(alpha!=zero)
         {
+            const size_t grain=std::max(size_t(1),profile<complex<T> >().l2/m);
             if(trans=='N')
             {
-                size_t jx=kx;
-                if(incy==1)
+                gemv_split(m,n,grain,y,ky,incy,[=](size_t begin, size_t end, complex<T> *y, size_t ky, ptrdiff_t incy)
                 {
-                    for(size_t j=0;j<n;j++)
+                    const complex<T> *a=A+begin*ldA;
+                    size_t jx=kx+begin*incx;
+                    if(incy==1)
                     {
-                        complex<T> temp=alpha*x[jx];
-                        for(size_t i=0;i<m;i++)
-                            y[i]+=temp*A[i];
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[jx];
-                        size_t iy=ky;
-                        for(size_t i=0;i<m;i++)
+                        for(size_t j=begin;j<end;j++)
                         {
-                            y[iy]+=temp*A[i];
-                            iy+=incy;
+                            complex<T> temp=alpha*x[jx];
+                            for(size_t i=0;i<m;i++)
+                                y[i]+=temp*a[i];
+                            a+=ldA;
+                            jx+=incx;
                         }
-                        A+=ldA;
-                        jx+=incx;
                     }
-                }
-            }
-            else if(trans=='T')
-            {
-                size_t jy=ky;
-                if(incx==1)
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=zero;
-                        for(size_t i=0;i<m;i++)
-                            temp+=A[i]*x[i];
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
-                    }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
+                    else
                     {
-                        complex<T> temp=zero;
-                        size_t ix=kx;
-                        for(size_t i=0;i<m;i++)
+                        for(size_t j=begin;j<end;j++)
                         {
-                            temp+=A[i]*x[ix];
-                            ix+=incx;
+                            complex<T> temp=alpha*x[jx];
+                            size_t iy=ky;
+                            for(size_t i=0;i<m;i++)
+                            {
+                                y[iy]+=temp*a[i];
+                                iy+=incy;
+                            }
+                            a+=ldA;
+                            jx+=incx;
                         }
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
                     }
-                }
+                });
             }
-            else if(trans=='C')
+            else
             {
-                size_t jy=ky;
-                if(incx==1)
+                const bool c=(trans=='C');
+                parallel_for(n,grain,[=](size_t begin, size_t end)
                 {
-                    for(size_t j=0;j<n;j++)
+                    const complex<T> *a=A+begin*ldA;
+                    size_t jy=ky+begin*incy;
+                    if(incx==1)
                     {
-                        complex<T> temp=zero;
-                        for(size_t i=0;i<m;i++)
-                            temp+=conj(A[i])*x[i];
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
+                        for(size_t j=begin;j<end;j++)
+                        {
+                            complex<T> temp=zero;
+                            if(c)
+                                for(size_t i=0;i<m;i++)
+                                    temp+=conj(a[i])*x[i];
+                            else
+                                for(size_t i=0;i<m;i++)
+                                    temp+=a[i]*x[i];
+                            y[jy]+=alpha*temp;
+                            jy+=incy;
+                            a+=ldA;
+                        }
                     }
-                }
-                else
-                {
-                    for(size_t j=0;j<n;j++)
+                    else
                     {
-                        complex<T> temp=zero;
-                        size_t ix=kx;
-                        for(size_t i=0;i<m;i++)
+                        for(size_t j=begin;j<end;j++)
                         {
-                            temp+=conj(A[i])*x[ix];
-                            ix+=incx;
+                            complex<T> temp=zero;
+                            size_t ix=kx;
+                            if(c)
+                                for(size_t i=0;i<m;i++)
+                                {
+                                    temp+=conj(a[i])*x[ix];
+                                    ix+=incx;
+                                }
+                            else
+                                for(size_t i=0;i<m;i++)
+                                {
+                                    temp+=a[i]*x[ix];
+                                    ix+=incx;
+                                }
+                            y[jy]+=alpha*temp;
+                            jy+=incy;
+                            a+=ldA;
                         }
-                        y[jy]+=alpha*temp;
-                        jy+=incy;
-                        A+=ldA;
                     }
-                }
+                });
             }
-            
         }
     }
 }
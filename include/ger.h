@@ -36,6 +36,9 @@
 #define __ger__
 
 #include <cstddef>
+#include <vector>
+#include "rank.h"
+#include "tune.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -49,34 +52,23 @@ namespace tblas
 
         if((m==0)||(n==0)||(alpha==zero))
             return;
-        
-        size_t jy=(incy>0)?0:(1-n)*incy;
-        size_t kx=(incx>0)?0:(1-m)*incx;
-        
-        if(incx==1)
+
+        std::vector<T> u;
+        std::vector<T> t;
+        if(incx!=1)
         {
-            for(size_t j=0;j<n;j++)
-            {
-                for(size_t i=0;i<m;i++)
-                    A[i]+=x[i]*alpha*y[jy];
-                jy+=incy;
-                A+=ldA;
-            }
+            gather(m,x,incx,u);
+            x=u.data();
         }
-        else
+        gather(n,y,incy,t);
+        for(size_t j=0;j<n;j++)
+            t[j]*=alpha;
+
+        const T *ty=t.data();
+        parallel_columns(m,n,profile<T>().l2,[=](size_t j0, size_t j1)
         {
-            for(size_t j=0;j<n;j++)
-            {
-                size_t ix=kx;
-                for(size_t i=0;i<m;i++)
-                {
-                    A[i]+=x[ix]*alpha*y[jy];
-                    ix+=incx;
-                }
-                A+=ldA;
-                jy+=incy;
-            }
-        }
+            rank1_block(m,j1-j0,x,ty+j0,A+j0*ldA,ldA);
+        });
     }
 }
 #endif
@@ -0,0 +1,73 @@
+//
+//  hbmm.h
+//
+//  Purpose
+//  =======
+//
+//  Performs the matrix-matrix operation
+//
+//      C <- alpha * A * B + beta * C
+//
+//  where alpha and beta are scalars, B and C are m-by-n matrices and A is
+//  an m-by-m Hermitian band matrix, with k sub/super-diagonals.  The band is
+//  applied to blocks of columns of B at a time, so it is read once per
+//  block rather than once per column (see band.h).
+//
+//  Arguments
+//  ==========
+//
+//  uplo    specifies whether A is stored as upper ('U') or lower ('L') triangular
+//
+//  m       specifies the order of the matrix A and the number of rows of B
+//          and C
+//
+//  n       specifies the number of columns of B and C
+//
+//  k       specifies the number of sub/super-diagonals of the matrix A
+//
+//  alpha   complex scalar multiple of the matrix-matrix product
+//
+//  A       complex band matrix stored as (k+1)-by-m array
+//
+//  ldA     specifies the column length of A, must be at least k+1
+//
+//  B       complex matrix of size m-by-n
+//
+//  ldB     column length of the matrix B, must be at least m
+//
+//  beta    complex scalar multiple of C
+//
+//  C       complex matrix of size m-by-n
+//
+//  ldC     column length of the matrix C, must be at least m
+//
+
+#ifndef __hbmm__
+#define __hbmm__
+
+#include <complex>
+#include <cstddef>
+#include "band.h"
+
+using std::complex;
+using std::size_t;
+
+namespace tblas
+{
+    template <typename T>
+    void hbmm(char uplo, size_t m, size_t n, size_t k, complex<T> alpha, complex<T> *A, size_t ldA, complex<T> *B, size_t ldB, complex<T> beta, complex<T> *C, size_t ldC)
+    {
+        const complex<T> zero(0.0);
+
+        if((m==0)||(n==0))
+            return;
+
+        if(alpha==zero)
+            band_scale(m,n,beta,C,ldC);
+        else if(uplo=='U')
+            parallel_band_mm(m,n,m,k,k,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return (i<j)?A[k+i-j+j*ldA]:(i>j)?conj(A[k+j-i+i*ldA]):complex<T>(real(A[k+i*ldA])); });
+        else
+            parallel_band_mm(m,n,m,k,k,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return (i>j)?A[i-j+j*ldA]:(i<j)?conj(A[j-i+i*ldA]):complex<T>(real(A[i*ldA])); });
+    }
+}
+#endif
@@ -42,6 +42,10 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "band.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -58,7 +62,6 @@ namespace tblas
         if(n==0)
             return;
         
-        size_t kx=(incx>0)?0:(1-n)*incx;
         size_t ky=(incy>0)?0:(1-n)*incy;
         
         if(beta==zero)
@@ -99,99 +102,33 @@ namespace tblas
         
         if(alpha!=zero)
         {
-            if(uplo=='U')
+            std::vector<complex<T> > t;
+            std::vector<complex<T> > v;
+            const complex<T> *u=x;
+            if((incx!=1)||(alpha!=one))
             {
-                if((incx==1)&&(incy==1))
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[j];
-                        complex<T> sum=zero;
-                        size_t i0=(j>k)?j-k:0;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            y[i]+=temp*A[k-j+i];
-                            sum+=conj(A[k-j+i])*x[i];
-                        }
-                        y[j]+=temp*real(A[k])+alpha*sum;
-                        A+=ldA;
-                    }
-                }
-                else
-                {
-                    size_t jx=kx;
-                    size_t jy=ky;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[jx];
-                        complex<T> sum=zero;
-                        size_t ix=kx;
-                        size_t iy=ky;
-                        size_t i0=(j>k)?j-k:0;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            y[iy]+=temp*A[k-j+i];
-                            sum+=conj(A[k-j+i])*x[ix];
-                            ix+=incx;
-                            iy+=incy;
-                        }
-                        y[jy]+=temp*real(A[k])+alpha*sum;
-                        A+=ldA;
-                        jx+=incx;
-                        jy+=incy;
-                        if(j>=k)
-                        {
-                            kx+=incx;
-                            ky+=incy;
-                        }
-                    }
-                }
+                gather(n,x,incx,t);
+                for(size_t j=0;j<n;j++)
+                    t[j]*=alpha;
+                u=t.data();
             }
-            else if(uplo=='L')
+            complex<T> *w=y;
+            if(incy!=1)
             {
-                if((incx==1)&&(incy==1))
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[j];
-                        complex<T> sum=zero;
-                        y[j]+=temp*real(A[0]);
-                        size_t N=(j+k<n)?j+k+1:n;
-                        for(size_t i=j+1;i<N;i++)
-                        {
-                            y[i]+=temp*A[i-j];
-                            sum+=conj(A[i-j])*x[i];
-                        }
-                        y[j]+=alpha*sum;
-                        A+=ldA;
-                    }
-                }
-                else
-                {
-                    size_t jx=kx;
-                    size_t jy=ky;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        complex<T> temp=alpha*x[jx];
-                        complex<T> sum=zero;
-                        size_t ix=jx;
-                        size_t iy=jy;
-                        size_t N=(j+k<n)?j+k+1:n;
-                        y[jy]+=temp*real(A[0]);
-                        for(size_t i=j+1;i<N;i++)
-                        {
-                            ix+=incx;
-                            iy+=incy;
-                            y[iy]+=temp*A[i-j];
-                            sum+=conj(A[i-j])*x[ix];
-                        }
-                        y[jy]+=alpha*sum;
-                        jx+=incx;
-                        jy+=incy;
-                        A+=ldA;
-                    }
-                }
+                gather(n,y,incy,v);
+                w=v.data();
             }
+            const size_t ku=(uplo=='U')?k:0;
+            const ptrdiff_t d0=(uplo=='U')?-static_cast<ptrdiff_t>(k):1;
+            const ptrdiff_t d1=(uplo=='U')?-1:static_cast<ptrdiff_t>(k);
+            parallel_band(n,2*k+1,profile<complex<T> >().l2,[=](size_t o0, size_t o1)
+            {
+                band_mv('N',n,n,ku,d0,d1,A,ldA,u,w,o0,o1,[](complex<T> a){ return a; });
+                band_mv('T',n,n,ku,d0,d1,A,ldA,u,w,o0,o1,[](complex<T> a){ return conj(a); });
+                band_mv('N',n,n,ku,0,0,A,ldA,u,w,o0,o1,[](complex<T> a){ return complex<T>(real(a)); });
+            });
+            if(incy!=1)
+                scatter(n,w,y,incy);
         }
     }
 }
@@ -36,7 +36,7 @@
 //
 //  ldB     column length of the matrix B, must be at least m
 //
-//  beta    scalar multiple of C
+//  beta    scalar multiple of C; if zero, C need not be set on entry
 //
 //  C       matrix of size m-by-n
 //
@@ -104,7 +104,7 @@ namespace tblas
                             c[k]+=t*a[k];
                             s+=b[k]*conj(a[k]);
                         }
-                        c[i]=beta*c[i]+t*real(a[i])+alpha*s;
+                        c[i]=((beta==zero)?zero:beta*c[i])+t*real(a[i])+alpha*s;
                         a+=ldA;
                     }
                     b+=ldB;
@@ -128,7 +128,7 @@ namespace tblas
                             c[k]+=t*a[k];
                             s+=b[k]*conj(a[k]);
                         }
-                        c[i]=beta*c[i]+t*real(a[i])+alpha*s;
+                        c[i]=((beta==zero)?zero:beta*c[i])+t*real(a[i])+alpha*s;
                     }
                     b+=ldB;
                     c+=ldC;
@@ -145,8 +145,16 @@ namespace tblas
                 for(size_t j=0;j<n;j++)
                 {
                     complex<T> t=alpha*real(a[j]);
-                    for(size_t i=0;i<m;i++)
-                        c[i]=c[i]*beta+t*b[i];
+                    if(beta==zero)
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=t*b[i];
+                    }
+                    else
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=c[i]*beta+t*b[i];
+                    }
                     complex<T> *at=A+(j+1)*ldA;
                     complex<T> *bt=B;
                     for(size_t k=0;k<j;k++)
@@ -178,8 +186,16 @@ namespace tblas
                 for(size_t j=0;j<n;j++)
                 {
                     complex<T> t=alpha*real(a[j]);
-                    for(size_t i=0;i<m;i++)
-                        c[i]=c[i]*beta+t*b[i];
+                    if(beta==zero)
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=t*b[i];
+                    }
+                    else
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=c[i]*beta+t*b[i];
+                    }
                     complex<T> *bt=B;
                     complex<T> *at=A;
                     for(size_t k=0;k<j;k++)
@@ -33,6 +33,9 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "rank.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -47,70 +50,22 @@ namespace tblas
  
         if((n==0)||(alpha==zero))
             return;
-        
-        if(incx==1)
+
+        std::vector<complex<T> > u;
+        std::vector<complex<T> > t(n);
+        if(incx!=1)
         {
-            if(uplo=='U')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[j]);
-                    for(size_t i=0;i<j;i++)
-                        A[i]+=x[i]*t;
-                    A[j]=real(A[j])+real(x[j]*t);
-                    A+=ldA;
-                }
-            }
-            else if(uplo=='L')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[j]);
-                    A[j]=real(A[j])+real(t*x[j]);
-                    for(size_t i=j+1;i<n;i++)
-                        A[i]+=x[i]*t;
-                    A+=ldA;
-                }
-            }
+            gather(n,x,incx,u);
+            x=u.data();
         }
-        else
+        for(size_t j=0;j<n;j++)
+            t[j]=alpha*conj(x[j]);
+
+        const complex<T> *tx=t.data();
+        parallel_triangle(uplo,n,profile<complex<T> >().l2,[=](size_t j0, size_t j1)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(uplo=='U')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[jx]);
-                    size_t ix=kx;
-                    for(size_t i=0;i<j;i++)
-                    {
-                        A[i]+=x[ix]*t;
-                        ix+=incx;
-                    }
-                    A[j]=real(A[j])+real(x[jx]*t);
-                    A+=ldA;
-                    jx+=incx;
-                }
-            }
-            else if(uplo=='L')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[jx]);
-                    A[j]=real(A[j])+real(t*x[jx]);
-                    size_t ix=jx;
-                    for(size_t i=j+1;i<n;i++)
-                    {
-                        ix+=incx;
-                        A[i]+=x[ix]*t;
-                    }
-                    jx+=incx;
-                    A+=ldA;
-                }
-            }
-        }
+            rank1_triangle(uplo,n,j0,j1,x,tx,A,ldA,[](complex<T> &a, complex<T> xj, complex<T> tj){ a=real(a)+real(xj*tj); });
+        });
     }
 }
 #endif
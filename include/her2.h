@@ -37,6 +37,9 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "rank.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -51,83 +54,33 @@ namespace tblas
         
         if((n==0)||(alpha==zero))
             return;
-        
-        if((incx==1)&&(incy==1))
+
+        std::vector<complex<T> > u;
+        std::vector<complex<T> > v;
+        std::vector<complex<T> > s(n);
+        std::vector<complex<T> > t(n);
+        if(incx!=1)
+        {
+            gather(n,x,incx,u);
+            x=u.data();
+        }
+        if(incy!=1)
         {
-            if(uplo=='U')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> tx=conj(alpha*x[j]);
-                    complex<T> ty=alpha*conj(y[j]);
-                    for(size_t i=0;i<j;i++)
-                        A[i]+=x[i]*ty+y[i]*tx;
-                    A[j]=real(A[j])+real(x[j]*ty+y[j]*tx);
-                    A+=ldA;
-                }
-            }
-            else if(uplo=='L')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> tx=conj(alpha*x[j]);
-                    complex<T> ty=alpha*conj(y[j]);
-                    A[j]=real(A[j])+real(x[j]*ty+y[j]*tx);
-                    for(size_t i=j+1;i<n;i++)
-                        A[i]+=x[i]*ty+y[i]*tx;
-                    A+=ldA;
-                }
-            }
+            gather(n,y,incy,v);
+            y=v.data();
         }
-        else
+        for(size_t j=0;j<n;j++)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            size_t ky=(incy>0)?0:(1-n)*incy;
-            if(uplo=='U')
-            {
-                size_t jx=kx;
-                size_t jy=ky;
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> tx=conj(alpha*x[jx]);
-                    complex<T> ty=alpha*conj(y[jy]);
-                    size_t ix=kx;
-                    size_t iy=ky;
-                    for(size_t i=0;i<j;i++)
-                    {
-                        A[i]+=x[ix]*ty+y[iy]*tx;
-                        ix+=incx;
-                        iy+=incy;
-                    }
-                    A[j]=real(A[j])+real(x[jx]*ty+y[jy]*tx);
-                    A+=ldA;
-                    jx+=incx;
-                    jy+=incy;
-                }
-            }
-            else if(uplo=='L')
-            {
-                size_t jx=kx;
-                size_t jy=ky;
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> tx=conj(alpha*x[jx]);
-                    complex<T> ty=alpha*conj(y[jy]);
-                    size_t ix=jx;
-                    size_t iy=jy;
-                    A[j]=real(A[j])+real(x[jx]*ty+y[jy]*tx);
-                    for(size_t i=j+1;i<n;i++)
-                    {
-                        ix+=incx;
-                        iy+=incy;
-                        A[i]+=x[ix]*ty+y[iy]*tx;
-                    }
-                    jx+=incx;
-                    jy+=incy;
-                    A+=ldA;
-                }
-            }
+            s[j]=alpha*conj(y[j]);
+            t[j]=conj(alpha*x[j]);
         }
+
+        const complex<T> *ty=s.data();
+        const complex<T> *tx=t.data();
+        parallel_triangle(uplo,n,profile<complex<T> >().l2,[=](size_t j0, size_t j1)
+        {
+            rank2_triangle(uplo,n,j0,j1,x,ty,y,tx,A,ldA,[](complex<T> &a, complex<T> xj, complex<T> sj, complex<T> yj, complex<T> tj){ a=real(a)+real(xj*sj+yj*tj); });
+        });
     }
 }
 #endif
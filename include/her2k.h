@@ -37,7 +37,7 @@
 //  ldB     column length of the matrix B,
 //          must be at least n if trans='N' or k if trans='C'
 //
-//  beta    scalar multiple of C
+//  beta    scalar multiple of C; if zero, C need not be set on entry
 //
 //  C       Hermitian matrix of order n
 //
@@ -65,7 +65,7 @@ namespace tblas
         if((n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
             return;
         
-        if(alpha==zero)
+        if((alpha==zero)||(k==0))
         {
             complex<T> *c=C;
             if(uplo=='U')
@@ -120,18 +120,29 @@ namespace tblas
                 complex<T> *c=C;
                 for(size_t j=0;j<n;j++)
                 {
-                    for(size_t i=0;i<j;i++)
-                        c[i]*=beta;
-                    c[j]=beta*real(c[j]);
                     complex<T> *a=A;
                     complex<T> *b=B;
                     for(size_t l=0;l<k;l++)
                     {
                         complex<T> s=alpha*conj(b[j]);
                         complex<T> t=conj(alpha*a[j]);
-                        for(size_t i=0;i<j;i++)
-                            c[i]+=s*a[i]+t*b[i];
-                        c[j]=real(c[j])+real(a[j]*s+b[j]*t);
+                        if(l>0)
+                        {
+                            for(size_t i=0;i<j;i++)
+                                c[i]+=s*a[i]+t*b[i];
+                        }
+                        else if(beta==zero)
+                        {
+                            for(size_t i=0;i<j;i++)
+                                c[i]=s*a[i]+t*b[i];
+                        }
+                        else
+                        {
+                            for(size_t i=0;i<j;i++)
+                                c[i]=beta*c[i]+s*a[i]+t*b[i];
+                        }
+                        const T d=(l>0)?real(c[j]):(beta==zero)?T(0):beta*real(c[j]);
+                        c[j]=d+real(a[j]*s+b[j]*t);
                         a+=ldA;
                         b+=ldB;
                     }
@@ -143,18 +154,29 @@ namespace tblas
                 complex<T> *c=C;
                 for(size_t j=0;j<n;j++)
                 {
-                    c[j]=beta*real(c[j]);
-                    for(size_t i=j+1;i<n;i++)
-                        c[i]*=beta;
                     complex<T> *a=A;
                     complex<T> *b=B;
                     for(size_t l=0;l<k;l++)
                     {
                         complex<T> s=alpha*conj(b[j]);
                         complex<T> t=conj(alpha*a[j]);
-                        c[j]=real(c[j])+real(s*a[j]+t*b[j]);
-                        for(size_t i=j+1;i<n;i++)
-                            c[i]+=s*a[i]+t*b[i];
+                        const T d=(l>0)?real(c[j]):(beta==zero)?T(0):beta*real(c[j]);
+                        c[j]=d+real(s*a[j]+t*b[j]);
+                        if(l>0)
+                        {
+                            for(size_t i=j+1;i<n;i++)
+                                c[i]+=s*a[i]+t*b[i];
+                        }
+                        else if(beta==zero)
+                        {
+                            for(size_t i=j+1;i<n;i++)
+                                c[i]=s*a[i]+t*b[i];
+                        }
+                        else
+                        {
+                            for(size_t i=j+1;i<n;i++)
+                                c[i]=beta*c[i]+s*a[i]+t*b[i];
+                        }
                         a+=ldA;
                         b+=ldB;
                     }
@@ -183,9 +205,9 @@ namespace tblas
                             t+=conj(a[l])*bt[l];
                         }
                         if(i<j)
-                            c[i]=alpha*t+conj(alpha)*s+beta*c[i];
+                            c[i]=(beta==zero)?alpha*t+conj(alpha)*s:alpha*t+conj(alpha)*s+beta*c[i];
                         else
-                            c[j]=real(alpha*t+conj(alpha)*s)+beta*real(c[j]);
+                            c[j]=(beta==zero)?real(alpha*t+conj(alpha)*s):real(alpha*t+conj(alpha)*s)+beta*real(c[j]);
                         a+=ldA;
                         b+=ldB;
                     }
@@ -213,9 +235,9 @@ namespace tblas
                             t+=conj(a[l])*bt[l];
                         }
                         if(i>j)
-                            c[i]=alpha*t+conj(alpha)*s+beta*c[i];
+                            c[i]=(beta==zero)?alpha*t+conj(alpha)*s:alpha*t+conj(alpha)*s+beta*c[i];
                         else
-                            c[j]=real(alpha*t+conj(alpha)*s)+beta*real(c[j]);
+                            c[j]=(beta==zero)?real(alpha*t+conj(alpha)*s):real(alpha*t+conj(alpha)*s)+beta*real(c[j]);
                         a+=ldA;
                         b+=ldB;
                     }
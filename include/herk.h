@@ -32,18 +32,26 @@
 //  ldA     column length of the matrix A,
 //          must be at least n if trans='N' or k if trans='C'
 //
-//  beta    scalar multiple of C
+//  beta    scalar multiple of C; if zero, C need not be set on entry
 //
 //  C       Hermitian matrix of order n
 //
 //  ldC     column length of the matrix C, must be at least n
 //
+//  If C spans more than one tile of dag.h, the update is split into tile
+//  tasks and run on a task graph; herk(g,...) queues those tasks on the
+//  task graph g instead.
+//
 
 #ifndef __herk__
 #define __herk__
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "dag.h"
+#include "gemm.h"
 
 using std::complex;
 using std::size_t;
@@ -51,6 +59,11 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
+    //  Queues the update on a task graph (see below).
+
+    template <typename T>
+    void herk(task_graph &g, char uplo, char trans, size_t n, size_t k, T alpha, complex<T> *A, size_t ldA, T beta, complex<T> *C, size_t ldC);
+
     template <typename T>
     void herk(char uplo, char trans, size_t n, size_t k, T alpha, complex<T> *A, size_t ldA, T beta, complex<T> *C, size_t ldC)
     {
@@ -60,8 +73,16 @@ namespace tblas
         
         if((n==0)||(((alpha==rzero)||(k==0))&&(beta==one)))
             return;
+
+        if(n>tile_order<complex<T> >())
+        {
+            task_graph g;
+            herk(g,uplo,trans,n,k,alpha,A,ldA,beta,C,ldC);
+            g.wait();
+            return;
+        }
         
-        if(alpha==zero)
+        if((alpha==rzero)||(k==0))
         {
             if(uplo=='U')
             {
@@ -117,16 +138,27 @@ namespace tblas
                 complex<T> *c=C;
                 for(size_t j=0;j<n;j++)
                 {
-                    for(size_t i=0;i<j;i++)
-                        c[i]*=beta;
-                    c[j]=beta*real(c[j]);
                     complex<T> *a=A;
                     for(size_t l=0;l<k;l++)
                     {
                         complex<T> t=alpha*conj(a[j]);
-                        for(size_t i=0;i<j;i++)
-                            c[i]+=t*a[i];
-                        c[j]=real(c[j])+real(t*a[j]);
+                        if(l>0)
+                        {
+                            for(size_t i=0;i<j;i++)
+                                c[i]+=t*a[i];
+                        }
+                        else if(beta==rzero)
+                        {
+                            for(size_t i=0;i<j;i++)
+                                c[i]=t*a[i];
+                        }
+                        else
+                        {
+                            for(size_t i=0;i<j;i++)
+                                c[i]=beta*c[i]+t*a[i];
+                        }
+                        const T d=(l>0)?real(c[j]):(beta==rzero)?rzero:beta*real(c[j]);
+                        c[j]=d+real(t*a[j]);
                         a+=ldA;
                     }
                     c+=ldC;
@@ -137,16 +169,27 @@ namespace tblas
                 complex<T> *c=C;
                 for(size_t j=0;j<n;j++)
                 {
-                    c[j]=beta*real(c[j]);
-                    for(size_t i=j+1;i<n;i++)
-                        c[i]*=beta;
                     complex<T> *a=A;
                     for(size_t l=0;l<k;l++)
                     {
                         complex<T> t=alpha*conj(a[j]);
-                        c[j]=real(c[j])+real(t*a[j]);
-                        for(size_t i=j+1;i<n;i++)
-                            c[i]+=t*a[i];
+                        const T d=(l>0)?real(c[j]):(beta==rzero)?rzero:beta*real(c[j]);
+                        c[j]=d+real(t*a[j]);
+                        if(l>0)
+                        {
+                            for(size_t i=j+1;i<n;i++)
+                                c[i]+=t*a[i];
+                        }
+                        else if(beta==rzero)
+                        {
+                            for(size_t i=j+1;i<n;i++)
+                                c[i]=t*a[i];
+                        }
+                        else
+                        {
+                            for(size_t i=j+1;i<n;i++)
+                                c[i]=beta*c[i]+t*a[i];
+                        }
                         a+=ldA;
                     }
                     c+=ldC;
@@ -167,13 +210,13 @@ namespace tblas
                         complex<T> t=zero;
                         for(size_t l=0;l<k;l++)
                             t+=conj(a[l])*at[l];
-                        c[i]=alpha*t+beta*c[i];
+                        c[i]=(beta==rzero)?alpha*t:alpha*t+beta*c[i];
                         a+=ldA;
                     }
                     T s=rzero;
                     for(size_t l=0;l<k;l++)
                         s+=real(conj(at[l])*at[l]);
-                    c[j]=alpha*s+beta*real(c[j]);
+                    c[j]=(beta==rzero)?alpha*s:alpha*s+beta*real(c[j]);
                     at+=ldA;
                     c+=ldC;
                 }
@@ -187,14 +230,14 @@ namespace tblas
                     T s=rzero;
                     for(size_t l=0;l<k;l++)
                         s+=real(conj(at[l])*at[l]);
-                    c[j]=alpha*s+beta*real(c[j]);
+                    c[j]=(beta==rzero)?alpha*s:alpha*s+beta*real(c[j]);
                     complex<T> *a=A+(j+1)*ldA;
                     for(size_t i=j+1;i<n;i++)
                     {
                         complex<T> t=zero;
                         for(size_t l=0;l<k;l++)
                             t+=conj(a[l])*at[l];
-                        c[i]=alpha*t+beta*c[i];
+                        c[i]=(beta==rzero)?alpha*t:alpha*t+beta*c[i];
                         a+=ldA;
                     }
                     at+=ldA;
@@ -203,5 +246,52 @@ namespace tblas
             }
         }
     }
+
+    //  Queues the update on g as one task per tile of the triangle uplo of
+    //  C: the diagonal tiles by herk and the others by gemm.
+
+    template <typename T>
+    void herk(task_graph &g, char uplo, char trans, size_t n, size_t k, T alpha, complex<T> *A, size_t ldA, T beta, complex<T> *C, size_t ldC)
+    {
+        const T rzero(0.0);
+        const T one(1.0);
+
+        if((n==0)||(((alpha==rzero)||(k==0))&&(beta==one)))
+            return;
+
+        const size_t nb=tile_order<complex<T> >();
+        const bool scale=((alpha==rzero)||(k==0));
+        const char tA=(trans=='N')?'N':'C';
+        const char tB=(trans=='N')?'C':'N';
+        const complex<T> a(alpha);
+        const complex<T> b(beta);
+        for(size_t j0=0;j0<n;j0+=nb)
+        {
+            const size_t jb=std::min(nb,n-j0);
+            complex<T> *aj=(trans=='N')?A+j0:A+j0*ldA;
+            const size_t i0=(uplo=='U')?0:j0;
+            const size_t i1=(uplo=='U')?j0+jb:n;
+            for(size_t ib0=i0;ib0<i1;ib0+=nb)
+            {
+                const size_t ib=std::min(nb,n-ib0);
+                complex<T> *ai=(trans=='N')?A+ib0:A+ib0*ldA;
+                complex<T> *c=C+ib0+j0*ldC;
+                std::vector<tile_access> data;
+                if(!scale)
+                {
+                    tile_panel(trans,ib0,ib,k,nb,A,ldA,data);
+                    if(ib0!=j0)
+                        tile_panel(trans,j0,jb,k,nb,A,ldA,data);
+                }
+                data.push_back(tile_write(c,ib,jb,ldC));
+                if(ib0==j0)
+                    g.submit([=]{ herk(uplo,trans,jb,k,alpha,aj,ldA,beta,c,ldC); },data);
+                else if(scale)
+                    g.submit([=]{ gemm_scale(ib,jb,b,c,ldC); },data);
+                else
+                    g.submit([=]{ gemm_blocked(tA,tB,ib,jb,k,a,ai,ldA,aj,ldA,b,c,ldC,profile<complex<T> >()); },data);
+            }
+        }
+    }
 }
 #endif
@@ -0,0 +1,76 @@
+//
+//  hfmv.h
+//
+//  Purpose
+//  =======
+//
+//  Performs the matrix-vector operation
+//
+//      y <- alpha * A * x + beta * y
+//
+//  where alpha and beta are scalars, x and y are vectors and A is a
+//  Hermitian matrix in rectangular full packed format (see rfp.h).  The
+//  diagonal blocks of A go through hemv and the off-diagonal block through
+//  gemv, once for each triangle it represents.
+//
+//  Arguments
+//  =========
+//
+//  transr  specifies whether A is stored in normal ('N') or conjugate
+//          transposed ('C') RFP format
+//
+//  uplo    specifies whether the upper ('U') or lower ('L') triangle of A is
+//          stored
+//
+//  n       specifies the order of the Hermitian matrix A
+//
+//  alpha   complex scalar multiple of the matrix-vector product
+//
+//  A       Hermitian matrix of order n in RFP format
+//
+//  x       complex vector of length n
+//
+//  incx    stride of vector x; if negative, x is stored in reverse order
+//
+//  beta    complex scalar multiple of y
+//
+//  y       complex vector of length n
+//
+//  incy    stride of vector y; if negative, y is stored in reverse order
+//
+
+#ifndef __hfmv__
+#define __hfmv__
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "hemv.h"
+#include "rfp.h"
+#include "stride.h"
+
+using std::complex;
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T>
+    void hfmv(char transr, char uplo, size_t n, complex<T> alpha, complex<T> *A, complex<T> *x, ptrdiff_t incx, complex<T> beta, complex<T> *y, ptrdiff_t incy)
+    {
+        if(n==0)
+            return;
+
+        std::vector<complex<T> > u;
+        std::vector<complex<T> > v;
+        gather(n,x,incx,u);
+        gather(n,y,incy,v);
+        const rfp_layout<complex<T> > r=rfp_blocks(transr,uplo,n,A);
+        rfp_mv(r,uplo,alpha,u.data(),beta,v.data(),[](char uplo, size_t n, complex<T> alpha, complex<T> *A, size_t ldA, complex<T> *x, complex<T> beta, complex<T> *y)
+        {
+            hemv(uplo,n,alpha,A,ldA,x,1,beta,y,1);
+        });
+        scatter(n,v.data(),y,incy);
+    }
+}
+#endif
@@ -0,0 +1,73 @@
+//
+//  hfrk.h
+//
+//  Purpose
+//  =======
+//
+//  Performs one of the matrix-matrix operations
+//
+//      C <- alpha * A * A^H + beta * C  [trans='N']
+//
+//      C <- alpha * A^H * A + beta * C  [trans='C']
+//
+//  where alpha and beta are real scalars, C is a Hermitian matrix in
+//  rectangular full packed format (see rfp.h), and A is a complex n-by-k or
+//  k-by-n matrix.  The diagonal blocks of C are updated by gemm_triangle and
+//  the off-diagonal block by the blocked gemm.
+//
+//  Arguments
+//  =========
+//
+//  transr  specifies whether C is stored in normal ('N') or conjugate
+//          transposed ('C') RFP format
+//
+//  uplo    specifies whether the upper ('U') or lower ('L') triangle of C is
+//          stored
+//
+//  trans   specifies whether A is conjugate transposed, 'N' or 'C'
+//
+//  n       specifies the order of the Hermitian matrix C
+//
+//  k       specifies the inner dimension of the matrix-matrix products
+//
+//  alpha   real scalar multiple of matrix-matrix product
+//
+//  A       complex matrix of size n-by-k if trans='N', or k-by-n if trans='C'
+//
+//  ldA     column length of the matrix A,
+//          must be at least n if trans='N' or k if trans='C'
+//
+//  beta    real scalar multiple of C
+//
+//  C       Hermitian matrix of order n in RFP format
+//
+
+#ifndef __hfrk__
+#define __hfrk__
+
+#include <complex>
+#include <cstddef>
+#include "rfp.h"
+
+using std::complex;
+using std::size_t;
+
+namespace tblas
+{
+    template <typename T>
+    void hfrk(char transr, char uplo, char trans, size_t n, size_t k, T alpha, complex<T> *A, size_t ldA, T beta, complex<T> *C)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
+            return;
+
+        const rfp_layout<complex<T> > r=rfp_blocks(transr,uplo,n,C);
+        if(beta!=one)
+            rfp_scale(r,uplo,complex<T>(beta),true);
+        if((alpha!=zero)&&(k>0))
+            rfp_update(r,uplo,trans,(trans=='N')?'C':'N',k,complex<T>(alpha),A,ldA,A,ldA,true);
+    }
+}
+#endif
@@ -33,6 +33,11 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "packed.h"
+#include "rank.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -48,69 +53,21 @@ namespace tblas
         if((n==0)||(alpha==zero))
             return;
         
-        if(incx==1)
+        std::vector<complex<T> > u;
+        std::vector<complex<T> > t(n);
+        if(incx!=1)
         {
-            if(uplo=='U')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[j]);
-                    for(size_t i=0;i<j;i++)
-                        A[i]+=x[i]*t;
-                    A[j]=real(A[j])+real(x[j]*t);
-                    A+=j+1;
-                }
-            }
-            else if(uplo=='L')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[j]);
-                    A[0]=real(A[0])+real(t*x[j]);
-                    for(size_t i=j+1;i<n;i++)
-                        A[i-j]+=x[i]*t;
-                    A+=n-j;
-                }
-            }
+            gather(n,x,incx,u);
+            x=u.data();
         }
-        else
+        for(size_t j=0;j<n;j++)
+            t[j]=alpha*conj(x[j]);
+
+        const complex<T> *tx=t.data();
+        parallel_triangle(uplo,n,profile<complex<T> >().l2,[=](size_t j0, size_t j1)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(uplo=='U')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[jx]);
-                    size_t ix=kx;
-                    for(size_t i=0;i<j;i++)
-                    {
-                        A[i]+=x[ix]*t;
-                        ix+=incx;
-                    }
-                    A[j]=real(A[j])+real(x[jx]*t);
-                    A+=j+1;
-                    jx+=incx;
-                }
-            }
-            else if(uplo=='L')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    complex<T> t=alpha*conj(x[jx]);
-                    A[0]=real(A[0])+real(t*x[jx]);
-                    size_t ix=jx;
-                    for(size_t i=j+1;i<n;i++)
-                    {
-                        ix+=incx;
-                        A[i-j]+=x[ix]*t;
-                    }
-                    jx+=incx;
-                    A+=n-j;
-                }
-            }
-        }
+            packed_rank1(uplo,n,j0,j1,x,tx,A,[](complex<T> &a, complex<T> xj, complex<T> tj){ a=real(a)+real(xj*tj); });
+        });
     }
 }
 #endif
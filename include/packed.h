@@ -0,0 +1,243 @@
+//
+//  packed.h
+//
+//  Purpose
+//  =======
+//
+//  Column-blocked kernels for the packed-storage routines in spmv.h,
+//  hpmv.h, spr.h, hpr.h, tpmv.h and tpsv.h.
+//
+//  Column c of the upper triangle of an order n matrix in packed storage
+//  holds rows 0 to c, and column c of the lower triangle holds rows c to
+//  n-1, so each column is contiguous and packed_index gives the position
+//  of any stored element directly.  The kernels take four columns at a
+//  time and run them together over the rows they have in common, which
+//  makes the inner loops unit stride in every operand and loads each
+//  element of the vectors once for four columns; the small triangle next
+//  to the diagonal is finished one column at a time.
+//
+//  packed_mv computes the products with the strictly upper or lower part
+//  of A used by the matrix-vector routines, with the diagonal left to the
+//  caller.  Large products are split over the thread pool by column
+//  ranges of equal area, each range accumulating into its own copy of y,
+//  and the copies are added in order at the end so the result depends
+//  only on the number of threads.
+//
+
+#ifndef __packed__
+#define __packed__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "rank.h"
+#include "thread.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    //  Position of element (i,c) of the upper or lower triangle of an order
+    //  n matrix in packed storage.
+
+    inline size_t packed_index(char uplo, size_t n, size_t i, size_t c)
+    {
+        return (uplo=='U')?c*(c+1)/2+i:c*(2*n-c-1)/2+i;
+    }
+
+    //  For rows r0 to r1-1 of columns c0 to c1-1 of A, all of them stored,
+    //
+    //      y(r0:r1) <- A(r0:r1,c0:c1) * t + y(r0:r1)  [AXPY]
+    //
+    //      s <- op(A(r0:r1,c0:c1))^T * x(r0:r1) + s   [DOT]
+    //
+    //  where t and s have one element per column.
+
+    template <bool AXPY, bool DOT, typename T, typename C>
+    void packed_panel(char uplo, size_t n, size_t r0, size_t r1, size_t c0, size_t c1, const T *A, const T *x, const T *t, T *y, T *s, C op)
+    {
+        const size_t m=r1-r0;
+        const T *u=DOT?x+r0:x;
+        T *v=AXPY?y+r0:y;
+        size_t k=0;
+        for(;c0+k+4<=c1;k+=4)
+        {
+            const size_t c=c0+k;
+            const T *a0=A+packed_index(uplo,n,r0,c);
+            const T *a1=A+packed_index(uplo,n,r0,c+1);
+            const T *a2=A+packed_index(uplo,n,r0,c+2);
+            const T *a3=A+packed_index(uplo,n,r0,c+3);
+            const T t0=AXPY?t[k]:T(0);
+            const T t1=AXPY?t[k+1]:T(0);
+            const T t2=AXPY?t[k+2]:T(0);
+            const T t3=AXPY?t[k+3]:T(0);
+            T s0(0);
+            T s1(0);
+            T s2(0);
+            T s3(0);
+            for(size_t i=0;i<m;i++)
+            {
+                if(AXPY)
+                    v[i]+=a0[i]*t0+a1[i]*t1+a2[i]*t2+a3[i]*t3;
+                if(DOT)
+                {
+                    const T ui=u[i];
+                    s0+=op(a0[i])*ui;
+                    s1+=op(a1[i])*ui;
+                    s2+=op(a2[i])*ui;
+                    s3+=op(a3[i])*ui;
+                }
+            }
+            if(DOT)
+            {
+                s[k]+=s0;
+                s[k+1]+=s1;
+                s[k+2]+=s2;
+                s[k+3]+=s3;
+            }
+        }
+        for(;c0+k<c1;k++)
+        {
+            const T *a=A+packed_index(uplo,n,r0,c0+k);
+            const T tc=AXPY?t[k]:T(0);
+            T sum(0);
+            for(size_t i=0;i<m;i++)
+            {
+                if(AXPY)
+                    v[i]+=a[i]*tc;
+                if(DOT)
+                    sum+=op(a[i])*u[i];
+            }
+            if(DOT)
+                s[k]+=sum;
+        }
+    }
+
+    //  As packed_panel, over all the strictly upper or lower triangular
+    //  entries of columns j0 to j1-1, with t and s indexed by column.
+
+    template <bool AXPY, bool DOT, typename T, typename C>
+    void packed_strict(char uplo, size_t n, size_t j0, size_t j1, const T *A, const T *x, const T *t, T *y, T *s, C op)
+    {
+        for(size_t j=j0;j<j1;j+=4)
+        {
+            const size_t nb=std::min(size_t(4),j1-j);
+            if(uplo=='U')
+                packed_panel<AXPY,DOT>(uplo,n,0,j,j,j+nb,A,x,AXPY?t+j:t,y,DOT?s+j:s,op);
+            else
+                packed_panel<AXPY,DOT>(uplo,n,j+nb,n,j,j+nb,A,x,AXPY?t+j:t,y,DOT?s+j:s,op);
+            for(size_t c=j;c<j+nb;c++)
+            {
+                const T *a=A+packed_index(uplo,n,0,c);
+                const size_t i0=(uplo=='U')?j:c+1;
+                const size_t i1=(uplo=='U')?c:j+nb;
+                T sum(0);
+                for(size_t i=i0;i<i1;i++)
+                {
+                    if(AXPY)
+                        y[i]+=a[i]*t[c];
+                    if(DOT)
+                        sum+=op(a[i])*x[i];
+                }
+                if(DOT)
+                    s[c]+=sum;
+            }
+        }
+    }
+
+    //  With S the strictly upper or lower triangular part of A,
+    //
+    //      y <- S * t + y       [AXPY]
+    //
+    //      s <- op(S)^T x + s   [DOT]
+    //
+    //  split over the thread pool in ranges of at least grain entries.
+
+    template <bool AXPY, bool DOT, typename T, typename C>
+    void packed_mv(char uplo, size_t n, const T *A, const T *x, const T *t, T *y, T *s, C op, size_t grain)
+    {
+        const size_t parts=reduction_parts(n*(n+1)/2,grain);
+        if(parts==1)
+        {
+            packed_strict<AXPY,DOT>(uplo,n,0,n,A,x,t,y,s,op);
+            return;
+        }
+        std::vector<T> w(AXPY?(parts-1)*n:0,T(0));
+        auto task=[&](size_t p)
+        {
+            const size_t j0=triangle_boundary(uplo,n,parts,p);
+            const size_t j1=triangle_boundary(uplo,n,parts,p+1);
+            if(j0<j1)
+                packed_strict<AXPY,DOT>(uplo,n,j0,j1,A,x,t,(AXPY&&(p>0))?w.data()+(p-1)*n:y,s,op);
+        };
+        parallel_parts(parts,task);
+        if(AXPY)
+        {
+            const T *partial=w.data();
+            parallel_for(n,std::max(size_t(1),grain/parts),[=](size_t begin, size_t end)
+            {
+                for(size_t p=0;p+1<parts;p++)
+                {
+                    const T *z=partial+p*n;
+                    for(size_t i=begin;i<end;i++)
+                        y[i]+=z[i];
+                }
+            });
+        }
+    }
+
+    //  Columns j0 to j1-1 of a rank-1 update x * t^T of the upper or lower
+    //  triangle of A, with the diagonal updated through diag.
+
+    template <typename T, typename D>
+    void packed_rank1(char uplo, size_t n, size_t j0, size_t j1, const T *x, const T *t, T *A, D diag)
+    {
+        for(size_t j=j0;j<j1;j+=4)
+        {
+            const size_t nb=std::min(size_t(4),j1-j);
+            const size_t r0=(uplo=='U')?0:j+nb;
+            const size_t r1=(uplo=='U')?j:n;
+            const T *u=x+r0;
+            size_t c=j;
+            if(nb==4)
+            {
+                T *a0=A+packed_index(uplo,n,r0,c);
+                T *a1=A+packed_index(uplo,n,r0,c+1);
+                T *a2=A+packed_index(uplo,n,r0,c+2);
+                T *a3=A+packed_index(uplo,n,r0,c+3);
+                const T t0=t[c];
+                const T t1=t[c+1];
+                const T t2=t[c+2];
+                const T t3=t[c+3];
+                for(size_t i=0;i<r1-r0;i++)
+                {
+                    const T ui=u[i];
+                    a0[i]+=ui*t0;
+                    a1[i]+=ui*t1;
+                    a2[i]+=ui*t2;
+                    a3[i]+=ui*t3;
+                }
+            }
+            else
+            {
+                for(;c<j+nb;c++)
+                {
+                    T *a=A+packed_index(uplo,n,r0,c);
+                    const T tc=t[c];
+                    for(size_t i=0;i<r1-r0;i++)
+                        a[i]+=u[i]*tc;
+                }
+            }
+            for(c=j;c<j+nb;c++)
+            {
+                T *a=A+packed_index(uplo,n,0,c);
+                const size_t i0=(uplo=='U')?j:c+1;
+                const size_t i1=(uplo=='U')?c:j+nb;
+                for(size_t i=i0;i<i1;i++)
+                    a[i]+=x[i]*t[c];
+                diag(a[c],x[c],t[c]);
+            }
+        }
+    }
+}
+#endif
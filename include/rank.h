@@ -0,0 +1,229 @@
+//
+//  rank.h
+//
+//  Purpose
+//  =======
+//
+//  Column-blocked kernels for the rank-1 and rank-2 updates in ger.h,
+//  gerc.h, syr.h, syr2.h, her.h and her2.h.
+//
+//  The callers gather the vectors into contiguous workspace and hoist the
+//  column scalars, for instance t[j] = alpha * y[j] for ger, so the kernels
+//  below only ever see unit-stride vectors.  Four columns of A are updated
+//  per sweep, so each element of x is loaded once for four columns and
+//  the inner loops vectorize.  The triangular variants run the four
+//  columns together over the rows they have in common and finish the
+//  small triangle next to the diagonal one column at a time; the diagonal
+//  element itself goes through diag so that Hermitian updates can keep it
+//  real.
+//
+//  Large updates are split over the thread pool by column ranges holding
+//  roughly l2 entries each (see tune.h), with triangular ranges sized by
+//  area rather than by column count.
+//
+
+#ifndef __rank__
+#define __rank__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "stride.h"
+#include "thread.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    //  A(0:m,0:nc) <- x * t(0:nc)^T + A(0:m,0:nc)
+
+    template <typename T>
+    void rank1_block(size_t m, size_t nc, const T *x, const T *t, T *A, size_t ldA)
+    {
+        size_t j=0;
+        for(;j+4<=nc;j+=4)
+        {
+            T *a0=A+j*ldA;
+            T *a1=a0+ldA;
+            T *a2=a1+ldA;
+            T *a3=a2+ldA;
+            const T t0=t[j];
+            const T t1=t[j+1];
+            const T t2=t[j+2];
+            const T t3=t[j+3];
+            for(size_t i=0;i<m;i++)
+            {
+                const T xi=x[i];
+                a0[i]+=xi*t0;
+                a1[i]+=xi*t1;
+                a2[i]+=xi*t2;
+                a3[i]+=xi*t3;
+            }
+        }
+        for(;j<nc;j++)
+        {
+            T *a=A+j*ldA;
+            const T tj=t[j];
+            for(size_t i=0;i<m;i++)
+                a[i]+=x[i]*tj;
+        }
+    }
+
+    //  A(0:m,0:nc) <- x * ty(0:nc)^T + y * tx(0:nc)^T + A(0:m,0:nc)
+
+    template <typename T>
+    void rank2_block(size_t m, size_t nc, const T *x, const T *ty, const T *y, const T *tx, T *A, size_t ldA)
+    {
+        size_t j=0;
+        for(;j+4<=nc;j+=4)
+        {
+            T *a0=A+j*ldA;
+            T *a1=a0+ldA;
+            T *a2=a1+ldA;
+            T *a3=a2+ldA;
+            const T s0=ty[j];
+            const T s1=ty[j+1];
+            const T s2=ty[j+2];
+            const T s3=ty[j+3];
+            const T t0=tx[j];
+            const T t1=tx[j+1];
+            const T t2=tx[j+2];
+            const T t3=tx[j+3];
+            for(size_t i=0;i<m;i++)
+            {
+                const T xi=x[i];
+                const T yi=y[i];
+                a0[i]+=xi*s0+yi*t0;
+                a1[i]+=xi*s1+yi*t1;
+                a2[i]+=xi*s2+yi*t2;
+                a3[i]+=xi*s3+yi*t3;
+            }
+        }
+        for(;j<nc;j++)
+        {
+            T *a=A+j*ldA;
+            const T sj=ty[j];
+            const T tj=tx[j];
+            for(size_t i=0;i<m;i++)
+                a[i]+=x[i]*sj+y[i]*tj;
+        }
+    }
+
+    //  Columns j0 to j1-1 of a rank-1 update of the upper or lower triangle
+    //  of the order n matrix A.
+
+    template <typename T, typename D>
+    void rank1_triangle(char uplo, size_t n, size_t j0, size_t j1, const T *x, const T *t, T *A, size_t ldA, D diag)
+    {
+        for(size_t j=j0;j<j1;j+=4)
+        {
+            const size_t nb=std::min(size_t(4),j1-j);
+            if(uplo=='U')
+            {
+                rank1_block(j,nb,x,t+j,A+j*ldA,ldA);
+                for(size_t c=j;c<j+nb;c++)
+                {
+                    T *a=A+c*ldA;
+                    for(size_t i=j;i<c;i++)
+                        a[i]+=x[i]*t[c];
+                    diag(a[c],x[c],t[c]);
+                }
+            }
+            else
+            {
+                for(size_t c=j;c<j+nb;c++)
+                {
+                    T *a=A+c*ldA;
+                    diag(a[c],x[c],t[c]);
+                    for(size_t i=c+1;i<j+nb;i++)
+                        a[i]+=x[i]*t[c];
+                }
+                rank1_block(n-j-nb,nb,x+j+nb,t+j,A+j+nb+j*ldA,ldA);
+            }
+        }
+    }
+
+    //  Columns j0 to j1-1 of a rank-2 update of the upper or lower triangle
+    //  of the order n matrix A.
+
+    template <typename T, typename D>
+    void rank2_triangle(char uplo, size_t n, size_t j0, size_t j1, const T *x, const T *ty, const T *y, const T *tx, T *A, size_t ldA, D diag)
+    {
+        for(size_t j=j0;j<j1;j+=4)
+        {
+            const size_t nb=std::min(size_t(4),j1-j);
+            if(uplo=='U')
+            {
+                rank2_block(j,nb,x,ty+j,y,tx+j,A+j*ldA,ldA);
+                for(size_t c=j;c<j+nb;c++)
+                {
+                    T *a=A+c*ldA;
+                    for(size_t i=j;i<c;i++)
+                        a[i]+=x[i]*ty[c]+y[i]*tx[c];
+                    diag(a[c],x[c],ty[c],y[c],tx[c]);
+                }
+            }
+            else
+            {
+                for(size_t c=j;c<j+nb;c++)
+                {
+                    T *a=A+c*ldA;
+                    diag(a[c],x[c],ty[c],y[c],tx[c]);
+                    for(size_t i=c+1;i<j+nb;i++)
+                        a[i]+=x[i]*ty[c]+y[i]*tx[c];
+                }
+                rank2_block(n-j-nb,nb,x+j+nb,ty+j,y+j+nb,tx+j,A+j+nb+j*ldA,ldA);
+            }
+        }
+    }
+
+    //  Splits the n columns of an m-by-n update into ranges of about grain
+    //  entries each and calls f(j0,j1) for each range.
+
+    template <typename F>
+    void parallel_columns(size_t m, size_t n, size_t grain, F f)
+    {
+        parallel_for(n,(m>0)?std::max(size_t(1),grain/m):n,f);
+    }
+
+    //  First column of part t when the columns of the upper or lower
+    //  triangle of an order n matrix are split into parts ranges holding
+    //  about the same number of entries; boundaries fall on multiples of 4.
+
+    inline size_t triangle_boundary(char uplo, size_t n, size_t parts, size_t t)
+    {
+        if(t==0)
+            return 0;
+        if(t>=parts)
+            return n;
+        const double r=static_cast<double>(t)/parts;
+        const double s=(uplo=='U')?std::sqrt(r):1.0-std::sqrt(1.0-r);
+        return std::min(n,static_cast<size_t>(s*n)/4*4);
+    }
+
+    //  Splits the columns of the upper or lower triangle of an order n
+    //  matrix into ranges holding about the same number of entries, each at
+    //  least grain, and calls f(j0,j1) for each range.
+
+    template <typename F>
+    void parallel_triangle(char uplo, size_t n, size_t grain, F f)
+    {
+        const size_t parts=partition(n*(n+1)/2,grain);
+        if(parts==1)
+        {
+            f(size_t(0),n);
+            return;
+        }
+        auto task=[&](size_t t)
+        {
+            const size_t j0=triangle_boundary(uplo,n,parts,t);
+            const size_t j1=triangle_boundary(uplo,n,parts,t+1);
+            if(j0<j1)
+                f(j0,j1);
+        };
+        thread_pool::instance().run(parts,task);
+    }
+}
+#endif
@@ -0,0 +1,342 @@
+//
+//  rfp.h
+//
+//  Purpose
+//  =======
+//
+//  Rectangular full packed (RFP) storage for symmetric, Hermitian and
+//  triangular matrices, in the layout used by LAPACK, and conversions
+//  between RFP and full or packed storage:
+//
+//      trttf   full to RFP
+//
+//      tfttr   RFP to full
+//
+//      tpttf   packed to RFP
+//
+//      tfttp   RFP to packed
+//
+//  An order n matrix A is split into the diagonal blocks A11 of order n1 and
+//  A22 of order n2, and the off-diagonal block A21 if uplo='L' or A12 if
+//  uplo='U', where n1=n-n/2 and n2=n/2 if uplo='L', or n1=n/2 and n2=n-n/2
+//  if uplo='U'.  With transr='N' the three blocks fill an ld-by-(n+1)/2
+//  array, with ld=n+1 for n even and ld=n for n odd, as follows:
+//
+//      uplo='L'  A11 lower triangle at row 1 (n even) or 0 (n odd)
+//                A21 below it
+//                A22 as the upper triangle of A22^T, at row 0 and
+//                column 0 (n even) or 1 (n odd)
+//
+//      uplo='U'  A12 at row 0
+//                A22 upper triangle below it
+//                A11 as the lower triangle of A11^T, below A22 and one
+//                row down if n is even
+//
+//  With transr='T' for real or 'C' for complex matrices the array is stored
+//  transposed, or conjugate transposed, instead.  Each block is therefore an
+//  ordinary column-major submatrix of the array, stored either as itself or
+//  as its (conjugate) transpose, which rfp_blocks describes so the RFP
+//  kernels in sfrk.h, hfrk.h, tfsm.h, sfmv.h and hfmv.h can apply the
+//  blocked Level-3 and the Level-2 kernels to the blocks directly.
+//
+//  Arguments
+//  =========
+//
+//  transr  specifies whether the RFP array is stored normally ('N') or
+//          transposed ('T' or 'C')
+//
+//  uplo    specifies whether the upper ('U') or lower ('L') triangle of A
+//          is stored
+//
+//  n       specifies the order of the matrix A
+//
+//  A       matrix of order n in full storage
+//
+//  ldA     column length of the matrix A, must be at least n
+//
+//  AP      matrix of order n in packed storage, a vector of length n*(n+1)/2
+//
+//  ARF     matrix of order n in RFP storage, a vector of length n*(n+1)/2
+//
+
+#ifndef __rfp__
+#define __rfp__
+
+#include <cstddef>
+#include "gemm.h"
+#include "gemv.h"
+#include "packed.h"
+#include "tune.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    //  One block of an RFP matrix: an ordinary submatrix starting at a with
+    //  column length ld, holding the block itself or, if flip is set, its
+    //  (conjugate) transpose.
+
+    template <typename T>
+    struct rfp_block
+    {
+        T *a;
+        size_t ld;
+        bool flip;
+    };
+
+    template <typename T>
+    struct rfp_layout
+    {
+        size_t n1;
+        size_t n2;
+        rfp_block<T> a11;
+        rfp_block<T> a22;
+        rfp_block<T> off;
+    };
+
+    template <typename T>
+    rfp_layout<T> rfp_blocks(char transr, char uplo, size_t n, T *ARF)
+    {
+        const bool even=(n%2==0);
+        const size_t ld=even?n+1:n;
+        const size_t ldt=even?n/2:(n+1)/2;
+        const size_t shift=even?1:0;
+        const bool t=(transr!='N');
+
+        auto block=[=](size_t i, size_t j, bool flip)
+        {
+            rfp_block<T> b;
+            b.a=t?ARF+j+i*ldt:ARF+i+j*ld;
+            b.ld=t?ldt:ld;
+            b.flip=(flip!=t);
+            return b;
+        };
+
+        rfp_layout<T> r;
+        if(uplo=='L')
+        {
+            r.n1=n-n/2;
+            r.n2=n/2;
+            r.a11=block(shift,0,false);
+            r.a22=block(0,even?0:1,true);
+            r.off=block(r.n1+shift,0,false);
+        }
+        else
+        {
+            r.n1=n/2;
+            r.n2=n-n/2;
+            r.a11=block(r.n2+shift,0,true);
+            r.a22=block(r.n1,0,false);
+            r.off=block(0,0,false);
+        }
+        return r;
+    }
+
+    //  Triangle of a diagonal block that holds the triangle uplo of the
+    //  block itself.
+
+    template <typename T>
+    inline char rfp_uplo(const rfp_block<T> &b, char uplo)
+    {
+        return b.flip?((uplo=='U')?'L':'U'):uplo;
+    }
+
+    //  Transpose operation that undoes a flipped block.
+
+    template <typename T>
+    inline char rfp_trans(T)
+    {
+        return 'T';
+    }
+
+    template <typename T>
+    inline char rfp_trans(complex<T>)
+    {
+        return 'C';
+    }
+
+    //  Entry (i,j) of the triangle uplo of A; flip is set if it is stored
+    //  as its conjugate.
+
+    template <typename T>
+    T &rfp_entry(const rfp_layout<T> &r, char uplo, size_t i, size_t j, bool &flip)
+    {
+        const rfp_block<T> *b;
+        if((i<r.n1)&&(j<r.n1))
+            b=&r.a11;
+        else if((i>=r.n1)&&(j>=r.n1))
+        {
+            b=&r.a22;
+            i-=r.n1;
+            j-=r.n1;
+        }
+        else
+        {
+            b=&r.off;
+            if(uplo=='L')
+                i-=r.n1;
+            else
+                j-=r.n1;
+        }
+        flip=b->flip;
+        return flip?b->a[j+i*b->ld]:b->a[i+j*b->ld];
+    }
+
+    //  Dimensions of the stored off-diagonal block.
+
+    template <typename T>
+    inline void rfp_off_size(const rfp_layout<T> &r, char uplo, size_t &m, size_t &n)
+    {
+        const bool lower=((uplo=='L')!=r.off.flip);
+        m=lower?r.n2:r.n1;
+        n=lower?r.n1:r.n2;
+    }
+
+    //  C <- beta * C on the stored entries of the RFP matrix C, keeping the
+    //  diagonal real if hermitian is set.
+
+    template <typename T>
+    void rfp_scale(const rfp_layout<T> &r, char uplo, T beta, bool hermitian)
+    {
+        const T zero(0.0);
+        const rfp_block<T> *d[2]={&r.a11,&r.a22};
+        const size_t nd[2]={r.n1,r.n2};
+        for(size_t b=0;b<2;b++)
+        {
+            const char u=rfp_uplo(*d[b],uplo);
+            T *a=d[b]->a;
+            for(size_t j=0;j<nd[b];j++)
+            {
+                const size_t i0=(u=='U')?0:j;
+                const size_t i1=(u=='U')?j+1:nd[b];
+                for(size_t i=i0;i<i1;i++)
+                    a[i]=(beta==zero)?zero:beta*a[i];
+                if(hermitian)
+                    a[j]=real_part(a[j]);
+                a+=d[b]->ld;
+            }
+        }
+        size_t m,n;
+        rfp_off_size(r,uplo,m,n);
+        T *a=r.off.a;
+        for(size_t j=0;j<n;j++)
+        {
+            for(size_t i=0;i<m;i++)
+                a[i]=(beta==zero)?zero:beta*a[i];
+            a+=r.off.ld;
+        }
+    }
+
+    //  C <- alpha * op(A) * op(B) + C on the stored entries of the RFP
+    //  matrix C, where op(A) is n-by-k and op(B) is k-by-n and the product
+    //  is taken to be symmetric, or Hermitian if hermitian is set.
+
+    template <typename T>
+    void rfp_update(const rfp_layout<T> &r, char uplo, char transA, char transB, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, bool hermitian)
+    {
+        const size_t n1=r.n1;
+        T *A2=(transA=='N')?A+n1:A+n1*ldA;
+        T *B2=(transB=='N')?B+n1*ldB:B+n1;
+        gemm_triangle(rfp_uplo(r.a11,uplo),transA,transB,r.n1,k,alpha,A,ldA,B,ldB,r.a11.a,r.a11.ld,hermitian);
+        gemm_triangle(rfp_uplo(r.a22,uplo),transA,transB,r.n2,k,alpha,A2,ldA,B2,ldB,r.a22.a,r.a22.ld,hermitian);
+        if((uplo=='L')!=r.off.flip)
+            gemm_blocked(transA,transB,r.n2,r.n1,k,alpha,A2,ldA,B,ldB,T(1),r.off.a,r.off.ld,profile<T>());
+        else
+            gemm_blocked(transA,transB,r.n1,r.n2,k,alpha,A,ldA,B2,ldB,T(1),r.off.a,r.off.ld,profile<T>());
+    }
+
+    //  y <- alpha * A * x + beta * y for the symmetric or Hermitian RFP
+    //  matrix A and unit-stride x and y, with mv(uplo,n,alpha,A,ldA,x,beta,y)
+    //  the matching full-storage product for the diagonal blocks.
+
+    template <typename T, typename F>
+    void rfp_mv(const rfp_layout<T> &r, char uplo, T alpha, T *x, T beta, T *y, F mv)
+    {
+        const T one(1.0);
+        const char h=rfp_trans(T(0));
+        const size_t n1=r.n1;
+        mv(rfp_uplo(r.a11,uplo),r.n1,alpha,r.a11.a,r.a11.ld,x,beta,y);
+        mv(rfp_uplo(r.a22,uplo),r.n2,alpha,r.a22.a,r.a22.ld,x+n1,beta,y+n1);
+        if((r.n1==0)||(r.n2==0))
+            return;
+        size_t m,n;
+        rfp_off_size(r,uplo,m,n);
+        T *xr=(uplo=='L')?x+n1:x;
+        T *xc=(uplo=='L')?x:x+n1;
+        T *yr=(uplo=='L')?y+n1:y;
+        T *yc=(uplo=='L')?y:y+n1;
+        gemv(r.off.flip?h:'N',m,n,alpha,r.off.a,r.off.ld,xc,1,one,yr,1);
+        gemv(r.off.flip?'N':h,m,n,alpha,r.off.a,r.off.ld,xr,1,one,yc,1);
+    }
+
+    template <typename T>
+    void trttf(char transr, char uplo, size_t n, T *A, size_t ldA, T *ARF)
+    {
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,n,ARF);
+        for(size_t j=0;j<n;j++)
+        {
+            const size_t i0=(uplo=='U')?0:j;
+            const size_t i1=(uplo=='U')?j+1:n;
+            for(size_t i=i0;i<i1;i++)
+            {
+                bool flip;
+                T &e=rfp_entry(r,uplo,i,j,flip);
+                e=flip?conjugate(A[i+j*ldA]):A[i+j*ldA];
+            }
+        }
+    }
+
+    template <typename T>
+    void tfttr(char transr, char uplo, size_t n, T *ARF, T *A, size_t ldA)
+    {
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,n,ARF);
+        for(size_t j=0;j<n;j++)
+        {
+            const size_t i0=(uplo=='U')?0:j;
+            const size_t i1=(uplo=='U')?j+1:n;
+            for(size_t i=i0;i<i1;i++)
+            {
+                bool flip;
+                const T e=rfp_entry(r,uplo,i,j,flip);
+                A[i+j*ldA]=flip?conjugate(e):e;
+            }
+        }
+    }
+
+    template <typename T>
+    void tpttf(char transr, char uplo, size_t n, T *AP, T *ARF)
+    {
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,n,ARF);
+        for(size_t j=0;j<n;j++)
+        {
+            const T *a=AP+packed_index(uplo,n,0,j);
+            const size_t i0=(uplo=='U')?0:j;
+            const size_t i1=(uplo=='U')?j+1:n;
+            for(size_t i=i0;i<i1;i++)
+            {
+                bool flip;
+                T &e=rfp_entry(r,uplo,i,j,flip);
+                e=flip?conjugate(a[i]):a[i];
+            }
+        }
+    }
+
+    template <typename T>
+    void tfttp(char transr, char uplo, size_t n, T *ARF, T *AP)
+    {
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,n,ARF);
+        for(size_t j=0;j<n;j++)
+        {
+            T *a=AP+packed_index(uplo,n,0,j);
+            const size_t i0=(uplo=='U')?0:j;
+            const size_t i1=(uplo=='U')?j+1:n;
+            for(size_t i=i0;i<i1;i++)
+            {
+                bool flip;
+                const T e=rfp_entry(r,uplo,i,j,flip);
+                a[i]=flip?conjugate(e):e;
+            }
+        }
+    }
+}
+#endif
@@ -8,6 +8,27 @@
 //
 //      (x,y) <- (c * x + s * y, -s * x + c * y)
 //
+//  Unit-stride vectors are rotated by a plain loop over both vectors, which
+//  the compiler turns into vector instructions, and long vectors are split
+//  over the thread pool.
+//
+//  rot_sequence applies k sequences of rotations to the matrix A in the
+//  manner of LAPACK's xLASR with pivot='V': rotation j of each sequence
+//  takes (c,s)=(C(j,l),S(j,l)) and acts on columns j and j+1 of A if
+//  side='R', or on rows j and j+1 if side='L', the rotations of each
+//  sequence being applied in increasing order of j if direct='F' or in
+//  decreasing order if direct='B', and the sequences in order l=0,...,k-1.
+//  With side='R' the rows are taken in blocks, and the rotations of all k
+//  sequences are applied to each block in a wavefront: each sequence moves
+//  two columns per step, applying rotations j and j+1 in one pass over
+//  columns j to j+2, and sequence l runs two steps behind sequence l-1 so
+//  that it never touches a column l-1 has yet to finish with.  The columns
+//  being worked on at any step lie within a window of about 4k, so each
+//  block of A is read from memory once for all k sequences instead of once
+//  per sequence.  With side='L' the columns are independent and are taken
+//  a few at a time through the same wavefront, one rotation at a time, so
+//  each step has rotations of several columns and sequences in flight.
+//
 //  Arguments
 //  =========
 //
@@ -25,12 +46,39 @@
 //
 //  s       scalar representing sin(theta) for rotation angle theta
 //
+//  side    specifies whether the rotations act on the columns ('R') or the
+//          rows ('L') of A
+//
+//  direct  specifies whether each sequence is applied forward ('F') or
+//          backward ('B')
+//
+//  m       number of rows of the matrix A
+//
+//  k       number of rotation sequences
+//
+//  C       matrix of size (n-1)-by-k if side='R', or (m-1)-by-k if side='L',
+//          holding the cosines of sequence l in column l
+//
+//  ldC     column length of the matrix C
+//
+//  S       matrix of the same size as C holding the sines
+//
+//  ldS     column length of the matrix S
+//
+//  A       matrix of size m-by-n
+//
+//  ldA     column length of the matrix A, must be at least m
+//
 
 #ifndef __rot__
 #define __rot__
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -41,55 +89,160 @@ namespace tblas
     template <typename T>
     void rot(size_t n, T *x, ptrdiff_t incx, T *y, ptrdiff_t incy, T c, T s)
     {
-        if((incx==1)&&(incy==1))
-        {
-            for(size_t i=0;i<n;i++)
-            {
-                T temp=c*x[i]+s*y[i];
-                y[i]=c*y[i]-s*x[i];
-                x[i]=temp;
-            }
-        }
-        else
+        parallel_pairwise(n,x,incx,y,incy,profile<T>().l1,[c,s](T &a, T &b)
         {
-            size_t ix=incx>0?0:(1-n)*incx;
-            size_t iy=incy>0?0:(1-n)*incy;
-            for(size_t i=0;i<n;i++)
-            {
-                T temp=c*x[ix]+s*y[iy];
-                y[iy]=c*y[iy]-s*x[ix];
-                x[ix]=temp;
-                ix+=incx;
-                iy+=incy;
-            }
-        }
+            T temp=c*a+s*b;
+            b=c*b-s*a;
+            a=temp;
+        });
     }
     
     template <typename T>
     void rot(size_t n, complex<T> *x, ptrdiff_t incx, complex<T> *y, ptrdiff_t incy, T c, T s)
     {
-        if((incx==1)&&(incy==1))
+        parallel_pairwise(n,x,incx,y,incy,profile<complex<T> >().l1,[c,s](complex<T> &a, complex<T> &b)
+        {
+            complex<T> temp=c*a+s*b;
+            b=c*b-s*a;
+            a=temp;
+        });
+    }
+
+    //  Bytes of A held in cache by each row block of rot_sequence.
+
+    const size_t rot_window=131072;
+
+    //  Number of columns rotated together by rot_sequence with side='L'.
+
+    const size_t rot_columns=16;
+
+    //  Calls rotate(l,u) for parts 0 to len-1 of each of k sequences, part u
+    //  of sequence l at step u+2l.
+
+    template <typename F>
+    void rot_wavefront(size_t len, size_t k, F &rotate)
+    {
+        if((len==0)||(k==0))
+            return;
+        for(size_t t=0;t<len+2*(k-1);t++)
         {
-            for(size_t i=0;i<n;i++)
+            const size_t l0=(t+1>len)?(t+2-len)/2:0;
+            const size_t l1=std::min(k,t/2+1);
+            for(size_t l=l0;l<l1;l++)
+                rotate(l,t-2*l);
+        }
+    }
+
+    template <typename T, typename R>
+    void rot_sequence_blocked(char side, char direct, size_t m, size_t n, size_t k, const R *C, size_t ldC, const R *S, size_t ldS, T *A, size_t ldA)
+    {
+        const bool forward=(direct=='F');
+
+        if((m==0)||(n==0)||(k==0))
+            return;
+
+        if(side=='R')
+        {
+            if(n<2)
+                return;
+            const size_t len=n-1;
+            const size_t rows=std::max(size_t(16),rot_window/(sizeof(T)*std::min(n,4*k+2))/16*16);
+            parallel_for(m,std::max(size_t(1),profile<T>().l2/(len*k)),[=](size_t begin, size_t end)
             {
-                complex<T> temp=c*x[i]+s*y[i];
-                y[i]=c*y[i]-s*x[i];
-                x[i]=temp;
-            }
+                for(size_t i0=begin;i0<end;i0+=rows)
+                {
+                    const size_t mb=std::min(rows,end-i0);
+                    auto rotate=[=](size_t l, size_t u)
+                    {
+                        const size_t t=2*u;
+                        const size_t j=forward?t:len-1-t;
+                        const R c=C[j+l*ldC];
+                        const R s=S[j+l*ldS];
+                        T *x=A+i0+j*ldA;
+                        T *y=x+ldA;
+                        if(t+1==len)
+                        {
+                            for(size_t i=0;i<mb;i++)
+                            {
+                                const T temp=c*x[i]+s*y[i];
+                                y[i]=c*y[i]-s*x[i];
+                                x[i]=temp;
+                            }
+                            return;
+                        }
+                        const size_t h=forward?j+1:j-1;
+                        const R d=C[h+l*ldC];
+                        const R e=S[h+l*ldS];
+                        if(forward)
+                        {
+                            T *z=y+ldA;
+                            for(size_t i=0;i<mb;i++)
+                            {
+                                const T xi=c*x[i]+s*y[i];
+                                const T yi=c*y[i]-s*x[i];
+                                x[i]=xi;
+                                y[i]=d*yi+e*z[i];
+                                z[i]=d*z[i]-e*yi;
+                            }
+                        }
+                        else
+                        {
+                            T *w=x-ldA;
+                            for(size_t i=0;i<mb;i++)
+                            {
+                                const T xi=c*x[i]+s*y[i];
+                                y[i]=c*y[i]-s*x[i];
+                                const T wi=w[i];
+                                w[i]=d*wi+e*xi;
+                                x[i]=d*xi-e*wi;
+                            }
+                        }
+                    };
+                    rot_wavefront((len+1)/2,k,rotate);
+                }
+            });
         }
         else
         {
-            size_t ix=incx>0?0:(1-n)*incx;
-            size_t iy=incy>0?0:(1-n)*incy;
-            for(size_t i=0;i<n;i++)
+            if(m<2)
+                return;
+            const size_t len=m-1;
+            parallel_for(n,std::max(size_t(1),profile<T>().l2/(len*k)),[=](size_t begin, size_t end)
             {
-                complex<T> temp=c*x[ix]+s*y[iy];
-                y[iy]=c*y[iy]-s*x[ix];
-                x[ix]=temp;
-                ix+=incx;
-                iy+=incy;
-            }
+                for(size_t c0=begin;c0<end;c0+=rot_columns)
+                {
+                    const size_t nb=std::min(rot_columns,end-c0);
+                    T *a=A+c0*ldA;
+                    auto rotate=[=](size_t l, size_t t)
+                    {
+                        const size_t j=forward?t:len-1-t;
+                        const R c=C[j+l*ldC];
+                        const R s=S[j+l*ldS];
+                        T *x=a+j;
+                        for(size_t q=0;q<nb;q++)
+                        {
+                            const T temp=c*x[0]+s*x[1];
+                            x[1]=c*x[1]-s*x[0];
+                            x[0]=temp;
+                            x+=ldA;
+                        }
+                    };
+                    rot_wavefront(len,k,rotate);
+                }
+            });
         }
     }
+
+    template <typename T>
+    void rot_sequence(char side, char direct, size_t m, size_t n, size_t k, T *C, size_t ldC, T *S, size_t ldS, T *A, size_t ldA)
+    {
+        rot_sequence_blocked(side,direct,m,n,k,C,ldC,S,ldS,A,ldA);
+    }
+
+    template <typename T>
+    void rot_sequence(char side, char direct, size_t m, size_t n, size_t k, T *C, size_t ldC, T *S, size_t ldS, complex<T> *A, size_t ldA)
+    {
+        rot_sequence_blocked(side,direct,m,n,k,C,ldC,S,ldS,A,ldA);
+    }
 }
 #endif
@@ -23,14 +23,28 @@
 //
 //  s       off-diagonal element of 2-by-2 rotation matrix (output only)
 //
+//  rotg_batch generates n independent rotations, rotation i from the point
+//  (a[i],b[i]) with the results stored as rotg stores them.  The cases are
+//  selected with conditional expressions rather than branches, and the
+//  length is computed as a scaled square root of a sum of squares rather
+//  than with hypot, so the loop compiles to vector instructions with the
+//  cases blended lane by lane, provided the square root and the comparisons
+//  need not set errno or trap, as with the -fno-math-errno and
+//  -fno-trapping-math flags the library is built with.  Long batches are
+//  split over the thread pool.
+//
 
 #ifndef __rotg__
 #define __rotg__
 
 #include <complex>
 #include <cmath>
+#include <cstddef>
+#include "thread.h"
+#include "tune.h"
 
 using std::complex;
+using std::size_t;
 
 namespace tblas
 {
@@ -92,5 +106,81 @@ namespace tblas
             a=alpha*r;
         }
     }
+
+    template <typename T>
+    void rotg_batch(size_t n, T *a, T *b, T *c, T *s)
+    {
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            using std::abs;
+            using std::sqrt;
+            using std::copysign;
+            const T one(1.0);
+            const T zero(0.0);
+            for(size_t i=begin;i<end;i++)
+            {
+                const T x=a[i];
+                const T y=b[i];
+                const bool big=(abs(x)>abs(y));
+                const T scale=abs(x)+abs(y);
+                const bool some=(scale!=zero);
+                const T q=some?scale:one;
+                const T u=x/q;
+                const T v=y/q;
+                const T r=copysign(q*sqrt(u*u+v*v),big?x:y);
+                const T d=some?r:one;
+                const T xd=x/d;
+                const T yd=y/d;
+                const T ci=some?xd:one;
+                const T si=some?yd:zero;
+                const T w=one/((ci!=zero)?ci:one);
+                const T z=big?si:w;
+                c[i]=ci;
+                s[i]=si;
+                a[i]=some?r:zero;
+                b[i]=some?z:zero;
+            }
+        });
+    }
+
+    template <typename T>
+    void rotg_batch(size_t n, complex<T> *a, complex<T> *b, T *c, complex<T> *s)
+    {
+        parallel_for(n,profile<complex<T> >().l1,[=](size_t begin, size_t end)
+        {
+            using std::abs;
+            using std::sqrt;
+            const T zero(0.0);
+            const T one(1.0);
+            for(size_t i=begin;i<end;i++)
+            {
+                const T xr=real(a[i]);
+                const T xi=imag(a[i]);
+                const T yr=real(b[i]);
+                const T yi=imag(b[i]);
+                const T mx=abs(xr)+abs(xi);
+                const T scale=mx+abs(yr)+abs(yi);
+                const bool some=(mx!=zero);
+                const T q=some?scale:one;
+                const T ur=xr/q;
+                const T ui=xi/q;
+                const T vr=yr/q;
+                const T vi=yi/q;
+                const T ax=sqrt(ur*ur+ui*ui);
+                const T r=sqrt(ur*ur+ui*ui+vr*vr+vi*vi);
+                const T d=some?ax:one;
+                const T pr=ur/d;
+                const T pi=ui/d;
+                const T rr=some?r:one;
+                const T cr=ax/rr;
+                const T sr=(pr*vr+pi*vi)/rr;
+                const T si=(pi*vr-pr*vi)/rr;
+                c[i]=some?cr:zero;
+                s[i]=complex<T>(some?sr:one,some?si:zero);
+                const T rq=r*q;
+                a[i]=complex<T>(some?pr*rq:yr,some?pi*rq:yi);
+            }
+        });
+    }
 }
 #endif
@@ -6,6 +6,9 @@
 //
 //  Applies a modified Givens rotation matrix H to a set of points (x,y).
 //
+//  As in rot.h, unit-stride vectors are rotated by a plain loop that the
+//  compiler vectorizes, and long vectors are split over the thread pool.
+//
 //  Arguments
 //  =========
 //
@@ -28,6 +31,9 @@
 #define __rotm__
 
 #include <cstddef>
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -37,80 +43,38 @@ namespace tblas
     template <typename T>
     void rotm(size_t n, T *x, ptrdiff_t incx, T *y, ptrdiff_t incy, T *H, int flag)
     {
-        if((incx==incy)&&(incx==1))
+        const T h11=H[0];
+        const T h21=H[1];
+        const T h12=H[2];
+        const T h22=H[3];
+        const size_t grain=profile<T>().l1;
+
+        if(flag==-1)
         {
-            if(flag==-1)
-            {
-                for(size_t i=0;i<n;i++)
-                {
-                    T w=x[i];
-                    T z=y[i];
-                    x[i]=w*H[0]+z*H[2];
-                    y[i]=w*H[1]+z*H[3];
-                }
-            }
-            else if(flag==0)
-            {
-                for(size_t i=0;i<n;i++)
-                {
-                    T w=x[i];
-                    T z=y[i];
-                    x[i]=w+z*H[2];
-                    y[i]=w*H[1]+z;
-                }
-            }
-            else if(flag==1)
+            parallel_pairwise(n,x,incx,y,incy,grain,[h11,h21,h12,h22](T &w, T &z)
             {
-                for(size_t i=0;i<n;i++)
-                {
-                    T w=x[i];
-                    T z=y[i];
-                    x[i]=w*H[0]+z;
-                    y[i]=-w+z*H[3];
-                }
-            }
+                T t=w;
+                w=t*h11+z*h12;
+                z=t*h21+z*h22;
+            });
         }
-        else
+        else if(flag==0)
         {
-            size_t ix=(incx>0)?0:(1-n)*incx;
-            size_t iy=(incy>0)?0:(1-n)*incy;
-            if(flag==-1)
+            parallel_pairwise(n,x,incx,y,incy,grain,[h21,h12](T &w, T &z)
             {
-                for(size_t i=0;i<n;i++)
-                {
-                    T w=x[ix];
-                    T z=y[iy];
-                    x[ix]=w*H[0]+z*H[2];
-                    y[iy]=w*H[1]+z*H[3];
-                    ix+=incx;
-                    iy+=incy;
-                }
-            }
-            else if(flag==0)
-            {
-                for(size_t i=0;i<n;i++)
-                {
-                    T w=x[ix];
-                    T z=y[iy];
-                    x[ix]=w+z*H[2];
-                    y[iy]=w*H[1]+z;
-                    ix+=incx;
-                    iy+=incy;
-                }
-            }
-            else if(flag==1)
+                T t=w;
+                w=t+z*h12;
+                z=t*h21+z;
+            });
+        }
+        else if(flag==1)
+        {
+            parallel_pairwise(n,x,incx,y,incy,grain,[h11,h22](T &w, T &z)
             {
-                for(size_t i=0;i<n;i++)
-                {
-                    T w=x[ix];
-                    T z=y[iy];
-                    x[ix]=w*H[0]+z;
-                    y[iy]=-w+z*H[3];
-                    ix+=incx;
-                    iy+=incy;
-                }
-            }
-            
+                T t=w;
+                w=t*h11+z;
+                z=-t+z*h22;
+            });
         }
     }
 }
@@ -34,16 +34,34 @@
 //
 //  H       rotation matrix stored as array of length 4
 //
+//  rotmg_batch constructs n independent transformations, transformation i
+//  from d1[i], d2[i], x1[i] and y1[i], with its matrix stored in H[4*i] to
+//  H[4*i+3] and its flag in flag[i].  The cases of the construction are
+//  selected with conditional expressions rather than branches, so the loop
+//  compiles to vector instructions with the cases blended lane by lane.
+//  The rescaling of d1 and d2, which is rarely needed and may take any
+//  number of steps, is left to a second pass over the lanes that need it.
+//  Long batches are split over the thread pool.
+//
 
 #ifndef __rotmg__
 #define __rotmg__
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
 
 namespace tblas
 {
+    //  Rescales d1 and d2 into the range (1/gamma^2,gamma^2), gamma=4096,
+    //  adjusting x1 and H to match.
+
     template <typename T>
-    int rotmg(T &d1, T &d2, T &x1, T &y1, T *H)
+    void rotmg_rescale(T &d1, T &d2, T &x1, T &h11, T &h12, T &h21, T &h22, int &flag)
     {
         using std::abs;
         const T zero(0.0);
@@ -52,6 +70,80 @@ namespace tblas
         const T gamsq(gam*gam);
         const T rgamsq(one/gamsq);
         T r=zero;
+        if(d1!=zero)
+        {
+            while((d1<=rgamsq)||(d1>=gamsq))
+            {
+                if(flag==0)
+                {
+                    h11=one;
+                    h22=one;
+                    flag=-1;
+                }
+                else
+                {
+                    h21=-one;
+                    h12=one;
+                    flag=-1;
+                }
+                if(d1<=rgamsq)
+                {
+                    r=gam;
+                    d1*=r*r;
+                    x1/=gam;
+                    h11/=gam;
+                    h12/=gam;
+                }
+                else
+                {
+                    r=gam;
+                    d1/=r*r;
+                    x1*=gam;
+                    h11*=gam;
+                    h12*=gam;
+                }
+            }
+        }
+        if(d2!=zero)
+        {
+            while((abs(d2)<=rgamsq)||(abs(d2)>=gamsq))
+            {
+                if(flag==0)
+                {
+                    h11=one;
+                    h22=one;
+                    flag=-1;
+                }
+                else
+                {
+                    h21=-one;
+                    h12=one;
+                    flag=-1;
+                }
+                if(abs(d2)<=rgamsq)
+                {
+                    r=gam;
+                    d2*=r*r;
+                    h21/=gam;
+                    h22/=gam;
+                }
+                else
+                {
+                    r=gam;
+                    d2/=r*r;
+                    h21*=gam;
+                    h22*=gam;
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    int rotmg(T &d1, T &d2, T &x1, T &y1, T *H)
+    {
+        using std::abs;
+        const T zero(0.0);
+        const T one(1.0);
         T u=zero;
         T p1=zero;
         T p2=zero;
@@ -124,72 +216,7 @@ namespace tblas
                     x1=y1*u;
                 }
             }
-            if(d1!=zero)
-            {
-                while((d1<=rgamsq)||(d1>=gamsq))
-                {
-                    if(flag==0)
-                    {
-                        h11=one;
-                        h22=one;
-                        flag=-1;
-                    }
-                    else
-                    {
-                        h21=-one;
-                        h12=one;
-                        flag=-1;
-                    }
-                    if(d1<=rgamsq)
-                    {
-                        r=gam;
-                        d1*=r*r;
-                        x1/=gam;
-                        h11/=gam;
-                        h12/=gam;
-                    }
-                    else
-                    {
-                        r=gam;
-                        d1/=r*r;
-                        x1*=gam;
-                        h11*=gam;
-                        h12*=gam;
-                    }
-                }
-            }
-            if(d2!=zero)
-            {
-                while((abs(d2)<=rgamsq)||(abs(d2)>=gamsq))
-                {
-                    if(flag==0)
-                    {
-                        h11=one;
-                        h22=one;
-                        flag=-1;
-                    }
-                    else
-                    {
-                        h21=-one;
-                        h12=one;
-                        flag=-1;
-                    }
-                    if(abs(d2)<=rgamsq)
-                    {
-                        r=gam;
-                        d2*=r*r;
-                        h21/=gam;
-                        h22/=gam;
-                    }
-                    else
-                    {
-                        r=gam;
-                        d2/=r*r;
-                        h21*=gam;
-                        h22*=gam;
-                    }
-                }
-            }
+            rotmg_rescale(d1,d2,x1,h11,h12,h21,h22,flag);
         }
         if(flag<0)
         {
@@ -210,5 +237,116 @@ namespace tblas
         }
         return flag;
     }
+
+    template <typename T>
+    void rotmg_batch(size_t n, T *d1, T *d2, T *x1, T *y1, T *H, int *flag)
+    {
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            using std::abs;
+            const T zero(0.0);
+            const T one(1.0);
+            const T gamsq(4096.0*4096.0);
+            const T rgamsq(one/gamsq);
+
+            //  The flags are staged in f so that the loop has few enough
+            //  pointers for the compiler to check them for overlap.  Each
+            //  case is blended over the ones before it in order of
+            //  precedence, one condition at a time.
+
+            T f[64];
+            for(size_t b0=begin;b0<end;b0+=64)
+            {
+                const size_t b1=std::min(end,b0+64);
+                for(size_t i=b0;i<b1;i++)
+                {
+                    const T a=d1[i];
+                    const T b=d2[i];
+                    const T x=x1[i];
+                    const T y=y1[i];
+                    const T p1=a*x;
+                    const T p2=b*y;
+                    const T q1=p1*x;
+                    const T q2=p2*y;
+                    const T h11=p1/p2;
+                    const T h22=x/y;
+                    const T ut=one+h11*h22;
+                    const T h21=-y/x;
+                    const T h12=p2/p1;
+                    const T uw=one-h12*h21;
+                    const T w=(uw>zero)?uw:one;
+                    const T aw=a/w;
+                    const T bw=b/w;
+                    const T au=a/ut;
+                    const T bu=b/ut;
+                    const T xw=x*w;
+                    const T yu=y*ut;
+                    T *h=H+4*i;
+                    const T g0=h[0];
+                    const T g1=h[1];
+                    const T g2=h[2];
+                    const T g3=h[3];
+                    const bool wide=(abs(q1)>abs(q2));
+                    const bool neg=(q2<zero);
+                    const bool skip=(p2==zero);
+                    const bool zap=(a<zero);
+                    T g=neg?T(-1):one;
+                    T e1=neg?zero:bu;
+                    T e2=neg?zero:au;
+                    T e3=neg?zero:yu;
+                    T k0=neg?zero:h11;
+                    T k1=neg?zero:g1;
+                    T k2=neg?zero:g2;
+                    T k3=neg?zero:h22;
+                    g=wide?zero:g;
+                    e1=wide?aw:e1;
+                    e2=wide?bw:e2;
+                    e3=wide?xw:e3;
+                    k0=wide?g0:k0;
+                    k1=wide?h21:k1;
+                    k2=wide?h12:k2;
+                    k3=wide?g3:k3;
+                    g=skip?T(-2):g;
+                    e1=skip?a:e1;
+                    e2=skip?b:e2;
+                    e3=skip?x:e3;
+                    k0=skip?g0:k0;
+                    k1=skip?g1:k1;
+                    k2=skip?g2:k2;
+                    k3=skip?g3:k3;
+                    g=zap?T(-1):g;
+                    d1[i]=zap?zero:e1;
+                    d2[i]=zap?zero:e2;
+                    x1[i]=zap?zero:e3;
+                    h[0]=zap?zero:k0;
+                    h[1]=zap?zero:k1;
+                    h[2]=zap?zero:k2;
+                    h[3]=zap?zero:k3;
+                    f[i-b0]=g;
+                }
+                for(size_t i=b0;i<b1;i++)
+                    flag[i]=static_cast<int>(f[i-b0]);
+            }
+            for(size_t i=begin;i<end;i++)
+            {
+                const T a=d1[i];
+                const T b=d2[i];
+                const bool out1=(a!=zero)&&((a<=rgamsq)||(a>=gamsq));
+                const bool out2=(b!=zero)&&((abs(b)<=rgamsq)||(abs(b)>=gamsq));
+                T *h=H+4*i;
+                if((flag[i]==-2)||!(out1||out2))
+                    continue;
+                T h11=h[0];
+                T h21=h[1];
+                T h12=h[2];
+                T h22=h[3];
+                rotmg_rescale(d1[i],d2[i],x1[i],h11,h12,h21,h22,flag[i]);
+                h[0]=h11;
+                h[1]=h21;
+                h[2]=h12;
+                h[3]=h22;
+            }
+        });
+    }
 }
 #endif
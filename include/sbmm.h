@@ -0,0 +1,71 @@
+//
+//  sbmm.h
+//
+//  Purpose
+//  =======
+//
+//  Performs the matrix-matrix operation
+//
+//      C <- alpha * A * B + beta * C
+//
+//  where alpha and beta are scalars, B and C are m-by-n matrices and A is
+//  an m-by-m symmetric band matrix, with k sub/super-diagonals.  The band is
+//  applied to blocks of columns of B at a time, so it is read once per
+//  block rather than once per column (see band.h).
+//
+//  Arguments
+//  ==========
+//
+//  uplo    specifies whether A is stored as upper ('U') or lower ('L') triangular
+//
+//  m       specifies the order of the matrix A and the number of rows of B
+//          and C
+//
+//  n       specifies the number of columns of B and C
+//
+//  k       specifies the number of sub/super-diagonals of the matrix A
+//
+//  alpha   scalar multiple of the matrix-matrix product
+//
+//  A       band matrix stored as (k+1)-by-m array
+//
+//  ldA     specifies the column length of A, must be at least k+1
+//
+//  B       matrix of size m-by-n
+//
+//  ldB     column length of the matrix B, must be at least m
+//
+//  beta    scalar multiple of C
+//
+//  C       matrix of size m-by-n
+//
+//  ldC     column length of the matrix C, must be at least m
+//
+
+#ifndef __sbmm__
+#define __sbmm__
+
+#include <cstddef>
+#include "band.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    template <typename T>
+    void sbmm(char uplo, size_t m, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+
+        if((m==0)||(n==0))
+            return;
+
+        if(alpha==zero)
+            band_scale(m,n,beta,C,ldC);
+        else if(uplo=='U')
+            parallel_band_mm(m,n,m,k,k,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return (i<=j)?A[k+i-j+j*ldA]:A[k+j-i+i*ldA]; });
+        else
+            parallel_band_mm(m,n,m,k,k,alpha,B,ldB,beta,C,ldC,[=](size_t i, size_t j){ return (i>=j)?A[i-j+j*ldA]:A[j-i+i*ldA]; });
+    }
+}
+#endif
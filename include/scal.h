@@ -19,12 +19,21 @@
 //
 //  incx    stride of vector x
 //
+//  Unit-stride vectors longer than the stream parameter of tune.h are
+//  split over the thread pool and prefetched ahead of the sweep (see
+//  stream.h).  A complex vector scaled by a real alpha is scaled as a real
+//  vector of twice the length, and one scaled by a complex alpha forms the
+//  products from the real and imaginary parts (see cplx.h), split over the
+//  thread pool.
+//
 
 #ifndef __scal__
 #define __scal__
 
 #include <complex>
 #include <cstddef>
+#include "cplx.h"
+#include "stream.h"
 
 using std::complex;
 using std::size_t;
@@ -34,15 +43,47 @@ namespace tblas
     template <typename T>
     void scal(size_t n, T alpha, T *x, size_t incx=1)
     {
-        for(size_t i=0;i<n;i++)
-            x[i*incx]*=alpha;
+        if((incx==1)&&streamed<T>(n))
+            parallel_scale(n,alpha,x);
+        else if(incx==1)
+        {
+            for(size_t i=0;i<n;i++)
+                x[i]*=alpha;
+        }
+        else
+        {
+            for(size_t i=0;i<n;i++)
+                x[i*incx]*=alpha;
+        }
     }
     
     template <typename T>
     void scal(size_t n, T alpha, complex<T> *x, size_t incx=1)
     {
-        for(size_t i=0;i<n;i++)
-            x[i*incx]*=alpha;
+        if(incx==1)
+            scal(2*n,alpha,reinterpret_cast<T *>(x));
+        else
+        {
+            for(size_t i=0;i<n;i++)
+                x[i*incx]*=alpha;
+        }
+    }
+
+    template <typename T>
+    void scal(size_t n, complex<T> alpha, complex<T> *x, size_t incx=1)
+    {
+        if(incx==1)
+        {
+            parallel_for(n,profile<complex<T> >().l1,[=](size_t begin, size_t end)
+            {
+                stream_update(end-begin,x+begin,[=](const complex<T> &a){ return cmul(alpha,a); });
+            });
+        }
+        else
+        {
+            for(size_t i=0;i<n;i++)
+                x[i*incx]=cmul(alpha,x[i*incx]);
+        }
     }
 }
 #endif
@@ -0,0 +1,67 @@
+//
+//  scalcopy.h
+//
+//  Purpose
+//  =======
+//
+//  Copies a scalar multiple of vector x to vector y:
+//
+//      y <- alpha * x
+//
+//  in a single pass, instead of a copy followed by a scal over y.  Long
+//  vectors are split across threads.
+//
+//  Arguments
+//  =========
+//
+//  n       length of vectors x and y
+//
+//  alpha   scalar multiple of x
+//
+//  x       vector of length n
+//
+//  incx    stride of vector x; if negative, x is stored in reverse order
+//
+//  y       vector of length n (output only)
+//
+//  incy    stride of vector y; if negative, y is stored in reverse order
+//
+
+#ifndef __scalcopy__
+#define __scalcopy__
+
+#include <cstddef>
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T, typename U>
+    void scalcopy(size_t n, U alpha, T *x, ptrdiff_t incx, T *y, ptrdiff_t incy)
+    {
+        x=origin(x,n,incx);
+        y=origin(y,n,incy);
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            const ptrdiff_t b=static_cast<ptrdiff_t>(begin);
+            const ptrdiff_t m=static_cast<ptrdiff_t>(end-begin);
+            T *xb=x+b*incx;
+            T *yb=y+b*incy;
+            if((incx==1)&&(incy==1))
+            {
+                for(ptrdiff_t i=0;i<m;i++)
+                    yb[i]=alpha*xb[i];
+            }
+            else
+            {
+                for(ptrdiff_t i=0;i<m;i++)
+                    yb[i*incy]=alpha*xb[i*incx];
+            }
+        });
+    }
+}
+#endif
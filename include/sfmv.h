@@ -0,0 +1,74 @@
+//
+//  sfmv.h
+//
+//  Purpose
+//  =======
+//
+//  Performs the matrix-vector operation
+//
+//      y <- alpha * A * x + beta * y
+//
+//  where alpha and beta are scalars, x and y are vectors and A is a real
+//  symmetric matrix in rectangular full packed format (see rfp.h).  The
+//  diagonal blocks of A go through symv and the off-diagonal block through
+//  gemv, once for each triangle it represents.
+//
+//  Arguments
+//  =========
+//
+//  transr  specifies whether A is stored in normal ('N') or transposed ('T')
+//          RFP format
+//
+//  uplo    specifies whether the upper ('U') or lower ('L') triangle of A is
+//          stored
+//
+//  n       specifies the order of the symmetric matrix A
+//
+//  alpha   scalar multiple of the matrix-vector product
+//
+//  A       symmetric matrix of order n in RFP format
+//
+//  x       vector of length n
+//
+//  incx    stride of vector x; if negative, x is stored in reverse order
+//
+//  beta    scalar multiple of y
+//
+//  y       vector of length n
+//
+//  incy    stride of vector y; if negative, y is stored in reverse order
+//
+
+#ifndef __sfmv__
+#define __sfmv__
+
+#include <cstddef>
+#include <vector>
+#include "rfp.h"
+#include "stride.h"
+#include "symv.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T>
+    void sfmv(char transr, char uplo, size_t n, T alpha, T *A, T *x, ptrdiff_t incx, T beta, T *y, ptrdiff_t incy)
+    {
+        if(n==0)
+            return;
+
+        std::vector<T> u;
+        std::vector<T> v;
+        gather(n,x,incx,u);
+        gather(n,y,incy,v);
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,n,A);
+        rfp_mv(r,uplo,alpha,u.data(),beta,v.data(),[](char uplo, size_t n, T alpha, T *A, size_t ldA, T *x, T beta, T *y)
+        {
+            symv(uplo,n,alpha,A,ldA,x,1,beta,y,1);
+        });
+        scatter(n,v.data(),y,incy);
+    }
+}
+#endif
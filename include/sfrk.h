@@ -0,0 +1,71 @@
+//
+//  sfrk.h
+//
+//  Purpose
+//  =======
+//
+//  Performs one of the matrix-matrix operations
+//
+//      C <- alpha * A * A^T + beta * C  [trans='N']
+//
+//      C <- alpha * A^T * A + beta * C  [trans='T']
+//
+//  where alpha and beta are scalars, C is a real symmetric matrix in
+//  rectangular full packed format (see rfp.h), and A is a real n-by-k or
+//  k-by-n matrix.  The diagonal blocks of C are updated by gemm_triangle and
+//  the off-diagonal block by the blocked gemm.
+//
+//  Arguments
+//  =========
+//
+//  transr  specifies whether C is stored in normal ('N') or transposed ('T')
+//          RFP format
+//
+//  uplo    specifies whether the upper ('U') or lower ('L') triangle of C is
+//          stored
+//
+//  trans   specifies whether A is transposed, 'N' or 'T'
+//
+//  n       specifies the order of the symmetric matrix C
+//
+//  k       specifies the inner dimension of the matrix-matrix products
+//
+//  alpha   scalar multiple of matrix-matrix product
+//
+//  A       matrix of size n-by-k if trans='N', or k-by-n if trans='T'
+//
+//  ldA     column length of the matrix A,
+//          must be at least n if trans='N' or k if trans='T'
+//
+//  beta    scalar multiple of C
+//
+//  C       symmetric matrix of order n in RFP format
+//
+
+#ifndef __sfrk__
+#define __sfrk__
+
+#include <cstddef>
+#include "rfp.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    template <typename T>
+    void sfrk(char transr, char uplo, char trans, size_t n, size_t k, T alpha, T *A, size_t ldA, T beta, T *C)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
+            return;
+
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,n,C);
+        if(beta!=one)
+            rfp_scale(r,uplo,beta,false);
+        if((alpha!=zero)&&(k>0))
+            rfp_update(r,uplo,trans,(trans=='N')?'T':'N',k,alpha,A,ldA,A,ldA,false);
+    }
+}
+#endif
@@ -0,0 +1,473 @@
+//
+//  small.h
+//
+//  Purpose
+//  =======
+//
+//  Direct paths for tiny operations, taken first thing by the gemm, gemv,
+//  trsv, ger, gerc, syr, her, syr2, her2, axpy and dot wrappers in src.
+//  When every dimension is at most small_order the arithmetic is only a
+//  few hundred flops, less than the cost of the general path: the
+//  argument checks, the dispatch on the transpose and triangle options,
+//  the lookups of the tuning profile and the thread pool, and, for gemm,
+//  the packing of the operands.  The other wrappers keep their general
+//  path, which at these orders costs about what direct loops do: trmv,
+//  symv, hemv and the rest of Level 1 are plain loops already, and trsm,
+//  trmm, symm, syrk and syr2k run their loops in place when the call fits
+//  in one tile.  latency.cpp times the wrappers on both sides of the line.
+//
+//  small_gemm and small_gemv take the raw arguments of the wrapper and
+//  return false, leaving the call to the general path, if a dimension is
+//  larger than small_order or any argument would be reported as illegal;
+//  otherwise they do the operation with BLAS semantics, C or y not read
+//  when beta is zero and A, B and x not read when alpha is zero, and
+//  return true.  The transpose options select kernels with the strides
+//  and conjugations fixed at compile time, which run along columns of A
+//  for trans='N' and take dot products of columns of A otherwise, so the
+//  innermost loops run over contiguous elements and have no branches other
+//  than their trip counts.  Complex products are formed as in cplx.h.
+//  small_axpy and small_dot handle any n up to small_order, including
+//  n <= 0.
+//
+//  small_trsv, the rank-one updates small_ger and small_gerc, and the
+//  symmetric and Hermitian ones small_syr, small_her, small_syr2 and
+//  small_her2 follow the same rules with plain loops in the order of the
+//  reference BLAS, the updates touching only the stored triangle and
+//  keeping the diagonal of a Hermitian result real.
+//
+
+#ifndef __small__
+#define __small__
+
+#include <complex>
+#include <cstddef>
+#include "cplx.h"
+
+using std::complex;
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    //  Largest dimension handled by the direct paths.
+
+    const int small_order=8;
+
+    //  a, conjugated if CONJ is set and T is complex.
+
+    template <bool CONJ, typename T>
+    inline T small_op(T a)
+    {
+        return a;
+    }
+
+    template <bool CONJ, typename T>
+    inline complex<T> small_op(complex<T> a)
+    {
+        return CONJ?conj(a):a;
+    }
+
+    //  a * b
+
+    template <typename T>
+    inline T small_mul(T a, T b)
+    {
+        return a*b;
+    }
+
+    template <typename T>
+    inline complex<T> small_mul(complex<T> a, complex<T> b)
+    {
+        return cmul(a,b);
+    }
+
+    //  Form of op(A) selected by trans: 0 for 'N', 1 for 'T', 2 for 'C', or
+    //  -1 for an illegal option.
+
+    inline int small_trans(char trans)
+    {
+        switch(trans)
+        {
+            case 'N': case 'n': return 0;
+            case 'T': case 't': return 1;
+            case 'C': case 'c': return 2;
+            default: return -1;
+        }
+    }
+
+    //  Index of the first element of a vector of n elements with stride
+    //  inc, as in the reference BLAS.
+
+    inline ptrdiff_t small_start(int n, int inc)
+    {
+        return (inc>0)?0:ptrdiff_t(1-n)*inc;
+    }
+
+    //  c <- beta * c for a vector c of n elements with stride inc, setting
+    //  c to zero without reading it if beta is zero.
+
+    template <typename T>
+    inline void small_scale(int n, T beta, T *c, ptrdiff_t inc)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+        if(beta==zero)
+        {
+            for(int i=0;i<n;i++)
+                c[i*inc]=zero;
+        }
+        else if(beta!=one)
+        {
+            for(int i=0;i<n;i++)
+                c[i*inc]=small_mul(beta,c[i*inc]);
+        }
+    }
+
+    //  C <- alpha * op(A) * op(B) + beta * C for op(A) given by TA as in
+    //  small_trans and op(B) by TB.
+
+    template <int TA, int TB, typename T>
+    void small_gemm_kernel(int m, int n, int k, T alpha, const T *A, int ldA, const T *B, int ldB, T beta, T *C, int ldC)
+    {
+        const T zero(0.0);
+        const ptrdiff_t bl=(TB==0)?1:ldB;
+        const ptrdiff_t bj=(TB==0)?ldB:1;
+        for(int j=0;j<n;j++)
+        {
+            const T *b=B+j*bj;
+            T *c=C+ptrdiff_t(j)*ldC;
+            small_scale(m,beta,c,1);
+            if(alpha==zero)
+                continue;
+            if(TA==0)
+            {
+                for(int l=0;l<k;l++)
+                {
+                    const T t=small_mul(alpha,small_op<TB==2>(b[l*bl]));
+                    const T *a=A+ptrdiff_t(l)*ldA;
+                    for(int i=0;i<m;i++)
+                        c[i]+=small_mul(a[i],t);
+                }
+            }
+            else
+            {
+                for(int i=0;i<m;i++)
+                {
+                    const T *a=A+ptrdiff_t(i)*ldA;
+                    T t=zero;
+                    for(int l=0;l<k;l++)
+                        t+=small_mul(small_op<TA==2>(a[l]),small_op<TB==2>(b[l*bl]));
+                    c[i]+=small_mul(alpha,t);
+                }
+            }
+        }
+    }
+
+    //  C <- alpha * op(A) * op(B) + beta * C for m, n, k <= small_order.
+
+    template <typename T>
+    bool small_gemm(char transA, char transB, int m, int n, int k, T alpha, const T *A, int ldA, const T *B, int ldB, T beta, T *C, int ldC)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+        const int ta=small_trans(transA);
+        const int tb=small_trans(transB);
+        if((unsigned(m)>unsigned(small_order))||(unsigned(n)>unsigned(small_order))||(unsigned(k)>unsigned(small_order)))
+            return false;
+        if((ta<0)||(tb<0))
+            return false;
+        if((ldA<((ta==0)?m:k))||(ldA<1)||(ldB<((tb==0)?k:n))||(ldB<1)||(ldC<m)||(ldC<1))
+            return false;
+        if((m==0)||(n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
+            return true;
+        switch(3*ta+tb)
+        {
+            case 0: small_gemm_kernel<0,0>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 1: small_gemm_kernel<0,1>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 2: small_gemm_kernel<0,2>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 3: small_gemm_kernel<1,0>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 4: small_gemm_kernel<1,1>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 5: small_gemm_kernel<1,2>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 6: small_gemm_kernel<2,0>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            case 7: small_gemm_kernel<2,1>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+            default: small_gemm_kernel<2,2>(m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC); break;
+        }
+        return true;
+    }
+
+    //  y <- alpha * op(A) * x + y for op(A) given by TA as in small_trans,
+    //  where x and y point to the first elements of the vectors.
+
+    template <int TA, typename T>
+    void small_gemv_kernel(int m, int n, T alpha, const T *A, int ldA, const T *x, ptrdiff_t incx, T *y, ptrdiff_t incy)
+    {
+        const T zero(0.0);
+        if(TA==0)
+        {
+            for(int l=0;l<n;l++)
+            {
+                const T t=small_mul(alpha,x[l*incx]);
+                const T *a=A+ptrdiff_t(l)*ldA;
+                for(int i=0;i<m;i++)
+                    y[i*incy]+=small_mul(a[i],t);
+            }
+        }
+        else
+        {
+            for(int j=0;j<n;j++)
+            {
+                const T *a=A+ptrdiff_t(j)*ldA;
+                T t=zero;
+                for(int i=0;i<m;i++)
+                    t+=small_mul(small_op<TA==2>(a[i]),x[i*incx]);
+                y[j*incy]+=small_mul(alpha,t);
+            }
+        }
+    }
+
+    //  y <- alpha * op(A) * x + beta * y for m, n <= small_order.
+
+    template <typename T>
+    bool small_gemv(char trans, int m, int n, T alpha, const T *A, int ldA, const T *x, int incx, T beta, T *y, int incy)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+        const int ta=small_trans(trans);
+        if((unsigned(m)>unsigned(small_order))||(unsigned(n)>unsigned(small_order)))
+            return false;
+        if((ta<0)||(ldA<m)||(ldA<1)||(incx==0)||(incy==0))
+            return false;
+        if((m==0)||(n==0)||((alpha==zero)&&(beta==one)))
+            return true;
+        const int lenx=(ta==0)?n:m;
+        const int leny=(ta==0)?m:n;
+        const T *u=x+small_start(lenx,incx);
+        T *v=y+small_start(leny,incy);
+        small_scale(leny,beta,v,incy);
+        if(alpha==zero)
+            return true;
+        if(ta==0)
+            small_gemv_kernel<0>(m,n,alpha,A,ldA,u,incx,v,incy);
+        else if(ta==1)
+            small_gemv_kernel<1>(m,n,alpha,A,ldA,u,incx,v,incy);
+        else
+            small_gemv_kernel<2>(m,n,alpha,A,ldA,u,incx,v,incy);
+        return true;
+    }
+
+    //  y <- alpha * x + y for n <= small_order.
+
+    template <typename T>
+    void small_axpy(int n, T alpha, const T *x, int incx, T *y, int incy)
+    {
+        const T zero(0.0);
+        if((n<=0)||(alpha==zero))
+            return;
+        const T *u=x+small_start(n,incx);
+        T *v=y+small_start(n,incy);
+        for(int i=0;i<n;i++)
+            v[i*incy]+=small_mul(alpha,u[i*incx]);
+    }
+
+    //  Returns the sum of op(x[i]) * y[i] for n <= small_order, where op
+    //  conjugates if CONJ is set.
+
+    template <bool CONJ, typename T>
+    T small_dot(int n, const T *x, int incx, const T *y, int incy)
+    {
+        T sum(0.0);
+        if(n<=0)
+            return sum;
+        const T *u=x+small_start(n,incx);
+        const T *v=y+small_start(n,incy);
+        for(int i=0;i<n;i++)
+            sum+=small_mul(small_op<CONJ>(u[i*incx]),v[i*incy]);
+        return sum;
+    }
+
+    //  a with its imaginary part set to zero, for the diagonal of a
+    //  Hermitian matrix.
+
+    template <typename T>
+    inline T small_re(T a)
+    {
+        return a;
+    }
+
+    template <typename T>
+    inline complex<T> small_re(complex<T> a)
+    {
+        return complex<T>(real(a),T(0.0));
+    }
+
+    //  0 if option c is first, 1 if it is second, in either case, or -1.
+
+    inline int small_option(char c, char first, char second)
+    {
+        if((c==first)||(c==first-'A'+'a'))
+            return 0;
+        if((c==second)||(c==second-'A'+'a'))
+            return 1;
+        return -1;
+    }
+
+    //  x <- op(A)^-1 * x for the order n upper or lower triangular A, where
+    //  op(A) is A^T if TRANS is set and A otherwise, conjugated if CONJ is
+    //  set, and x points to the first element.
+
+    template <bool TRANS, bool CONJ, typename T>
+    void small_trsv_kernel(bool upper, bool unit, int n, const T *A, int ldA, T *x, ptrdiff_t inc)
+    {
+        for(int s=0;s<n;s++)
+        {
+            const int j=(upper!=TRANS)?n-1-s:s;
+            const T *a=A+ptrdiff_t(j)*ldA;
+            const int first=upper?0:j+1;
+            const int last=upper?j:n;
+            if(!TRANS)
+            {
+                if(!unit)
+                    x[j*inc]/=small_op<CONJ>(a[j]);
+                const T t=x[j*inc];
+                for(int i=first;i<last;i++)
+                    x[i*inc]-=small_mul(small_op<CONJ>(a[i]),t);
+            }
+            else
+            {
+                T t=x[j*inc];
+                for(int i=first;i<last;i++)
+                    t-=small_mul(small_op<CONJ>(a[i]),x[i*inc]);
+                if(!unit)
+                    t/=small_op<CONJ>(a[j]);
+                x[j*inc]=t;
+            }
+        }
+    }
+
+    //  x <- op(A)^-1 * x for n <= small_order.
+
+    template <typename T>
+    bool small_trsv(char Uplo, char Trans, char Diag, int n, const T *A, int ldA, T *x, int incx)
+    {
+        const int uplo=small_option(Uplo,'U','L');
+        const int trans=small_trans(Trans);
+        const int diag=small_option(Diag,'N','U');
+        if(unsigned(n)>unsigned(small_order))
+            return false;
+        if((uplo<0)||(trans<0)||(diag<0)||(ldA<n)||(ldA<1)||(incx==0))
+            return false;
+        T *u=x+small_start(n,incx);
+        if(trans==0)
+            small_trsv_kernel<false,false>(uplo==0,diag==1,n,A,ldA,u,incx);
+        else if(trans==1)
+            small_trsv_kernel<true,false>(uplo==0,diag==1,n,A,ldA,u,incx);
+        else
+            small_trsv_kernel<true,true>(uplo==0,diag==1,n,A,ldA,u,incx);
+        return true;
+    }
+
+    //  A <- alpha * x * op(y)^T + A, where op conjugates if CONJ is set, for
+    //  m, n <= small_order.
+
+    template <bool CONJ, typename T>
+    bool small_rank_1(int m, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int ldA)
+    {
+        const T zero(0.0);
+        if((unsigned(m)>unsigned(small_order))||(unsigned(n)>unsigned(small_order)))
+            return false;
+        if((incx==0)||(incy==0)||(ldA<m)||(ldA<1))
+            return false;
+        if((m==0)||(n==0)||(alpha==zero))
+            return true;
+        const T *u=x+small_start(m,incx);
+        const T *v=y+small_start(n,incy);
+        for(int j=0;j<n;j++)
+        {
+            const T t=small_mul(alpha,small_op<CONJ>(v[j*incy]));
+            T *a=A+ptrdiff_t(j)*ldA;
+            for(int i=0;i<m;i++)
+                a[i]+=small_mul(u[i*incx],t);
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool small_ger(int m, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int ldA)
+    {
+        return small_rank_1<false>(m,n,alpha,x,incx,y,incy,A,ldA);
+    }
+
+    template <typename T>
+    bool small_gerc(int m, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int ldA)
+    {
+        return small_rank_1<true>(m,n,alpha,x,incx,y,incy,A,ldA);
+    }
+
+    //  A <- alpha * x * op(y)^T + alpha' * y * op(x)^T + A on the upper or
+    //  lower triangle, where op conjugates and alpha' is conj(alpha) if HERM
+    //  is set, for n <= small_order; with y null, A <- alpha * x * op(x)^T +
+    //  A.
+
+    template <bool HERM, typename T>
+    bool small_sym_rank(char Uplo, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int ldA)
+    {
+        const T zero(0.0);
+        const int uplo=small_option(Uplo,'U','L');
+        if(unsigned(n)>unsigned(small_order))
+            return false;
+        if((uplo<0)||(incx==0)||(y&&(incy==0))||(ldA<n)||(ldA<1))
+            return false;
+        if((n==0)||(alpha==zero))
+            return true;
+        const T *u=x+small_start(n,incx);
+        const T *v=y?y+small_start(n,incy):0;
+        const T alpha2=small_op<HERM>(alpha);
+        for(int j=0;j<n;j++)
+        {
+            T *a=A+ptrdiff_t(j)*ldA;
+            const int first=(uplo==0)?0:j;
+            const int last=(uplo==0)?j+1:n;
+            if(v)
+            {
+                const T t=small_mul(alpha,small_op<HERM>(v[j*incy]));
+                const T s=small_mul(alpha2,small_op<HERM>(u[j*incx]));
+                for(int i=first;i<last;i++)
+                    a[i]+=small_mul(u[i*incx],t)+small_mul(v[i*incy],s);
+            }
+            else
+            {
+                const T t=small_mul(alpha,small_op<HERM>(u[j*incx]));
+                for(int i=first;i<last;i++)
+                    a[i]+=small_mul(u[i*incx],t);
+            }
+            if(HERM)
+                a[j]=small_re(a[j]);
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool small_syr(char Uplo, int n, T alpha, const T *x, int incx, T *A, int ldA)
+    {
+        return small_sym_rank<false>(Uplo,n,alpha,x,incx,(const T *)0,1,A,ldA);
+    }
+
+    template <typename T>
+    bool small_her(char Uplo, int n, T alpha, const complex<T> *x, int incx, complex<T> *A, int ldA)
+    {
+        return small_sym_rank<true>(Uplo,n,complex<T>(alpha),x,incx,(const complex<T> *)0,1,A,ldA);
+    }
+
+    template <typename T>
+    bool small_syr2(char Uplo, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int ldA)
+    {
+        return small_sym_rank<false>(Uplo,n,alpha,x,incx,y,incy,A,ldA);
+    }
+
+    template <typename T>
+    bool small_her2(char Uplo, int n, T alpha, const T *x, int incx, const T *y, int incy, T *A, int ldA)
+    {
+        return small_sym_rank<true>(Uplo,n,alpha,x,incx,y,incy,A,ldA);
+    }
+}
+#endif
@@ -37,6 +37,10 @@
 #define __spmv__
 
 #include <cstddef>
+#include <vector>
+#include "packed.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -49,7 +53,6 @@ namespace tblas
         const T one(1.0);
         const T zero(0.0);
         
-        size_t kx=(incx>0)?0:(1-n)*incx;
         size_t ky=(incy>0)?0:(1-n)*incy;
         
         if(beta==zero)
@@ -90,90 +93,21 @@ namespace tblas
         
         if(alpha!=zero)
         {
-            if(uplo=='U')
+            std::vector<T> u;
+            if(incx!=1)
             {
-                if((incx==1)&&(incy==1))
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[j];
-                        T sum=zero;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            y[i]+=temp*A[i];
-                            sum+=A[i]*x[i];
-                        }
-                        y[j]+=temp*A[j]+alpha*sum;
-                        A+=j+1;
-                    }
-                }
-                else
-                {
-                    size_t jx=kx;
-                    size_t jy=ky;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[jx];
-                        T sum=zero;
-                        size_t ix=kx;
-                        size_t iy=ky;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            y[iy]+=temp*A[i];
-                            sum+=A[i]*x[ix];
-                            ix+=incx;
-                            iy+=incy;
-                        }
-                        y[jy]+=temp*A[j]+alpha*sum;
-                        A+=j+1;
-                        jx+=incx;
-                        jy+=incy;
-                    }
-                }
-            }
-            else if(uplo=='L')
-            {
-                if((incx==1)&&(incy==1))
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[j];
-                        T sum=zero;
-                        y[j]+=temp*A[0];
-                        for(size_t i=j+1;i<n;i++)
-                        {
-                            y[i]+=temp*A[i-j];
-                            sum+=A[i-j]*x[i];
-                        }
-                        y[j]+=alpha*sum;
-                        A+=n-j;
-                    }
-                }
-                else
-                {
-                    size_t jx=kx;
-                    size_t jy=ky;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        T temp=alpha*x[jx];
-                        T sum=zero;
-                        size_t ix=jx;
-                        size_t iy=jy;
-                        y[jy]+=temp*A[0];
-                        for(size_t i=j+1;i<n;i++)
-                        {
-                            ix+=incx;
-                            iy+=incy;
-                            y[iy]+=temp*A[i-j];
-                            sum+=A[i-j]*x[ix];
-                        }
-                        y[jy]+=alpha*sum;
-                        jx+=incx;
-                        jy+=incy;
-                        A+=n-j;
-                    }
-                }
+                gather(n,x,incx,u);
+                x=u.data();
             }
+            std::vector<T> t(n);
+            std::vector<T> w(n,zero);
+            std::vector<T> s(n,zero);
+            for(size_t j=0;j<n;j++)
+                t[j]=alpha*x[j];
+            packed_mv<true,true>(uplo,n,A,x,t.data(),w.data(),s.data(),[](T a){ return a; },profile<T>().l2);
+            y=origin(y,n,incy);
+            for(size_t j=0;j<n;j++)
+                y[static_cast<ptrdiff_t>(j)*incy]+=t[j]*A[packed_index(uplo,n,j,j)]+w[j]+alpha*s[j];
         }
     }
 }
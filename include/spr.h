@@ -32,6 +32,11 @@
 #define __spr__
 
 #include <cstddef>
+#include <vector>
+#include "packed.h"
+#include "rank.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -41,65 +46,26 @@ namespace tblas
     template <typename T>
     void spr(char uplo, size_t n, T alpha, T *x, ptrdiff_t incx, T *A)
     {
-        if(incx==1)
+        const T zero(0.0);
+
+        if((n==0)||(alpha==zero))
+            return;
+
+        std::vector<T> u;
+        std::vector<T> t(n);
+        if(incx!=1)
         {
-            if(uplo=='U')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[j];
-                    for(size_t i=0;i<=j;i++)
-                        A[i]+=x[i]*t;
-                    A+=j+1;
-                }
-            }
-            else if(uplo=='L')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[j];
-                    for(size_t i=j;i<n;i++)
-                        A[i-j]+=x[i]*t;
-                    A+=n-j;
-                }
-            }
+            gather(n,x,incx,u);
+            x=u.data();
         }
-        else
+        for(size_t j=0;j<n;j++)
+            t[j]=alpha*x[j];
+
+        const T *tx=t.data();
+        parallel_triangle(uplo,n,profile<T>().l2,[=](size_t j0, size_t j1)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(uplo=='U')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[jx];
-                    size_t ix=kx;
-                    for(size_t i=0;i<=j;i++)
-                    {
-                        A[i]+=x[ix]*t;
-                        ix+=incx;
-                    }
-                    A+=j+1;
-                    jx+=incx;
-                }
-            }
-            else if(uplo=='L')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[jx];
-                    size_t ix=jx;
-                    for(size_t i=j;i<n;i++)
-                    {
-                        A[i-j]+=x[ix]*t;
-                        ix+=incx;
-                    }
-                    jx+=incx;
-                    A+=n-j;
-                }
-            }
-        }
+            packed_rank1(uplo,n,j0,j1,x,tx,A,[](T &a, T xj, T tj){ a+=xj*tj; });
+        });
     }
 }
 #endif
@@ -0,0 +1,194 @@
+//
+//  stream.h
+//
+//  Purpose
+//  =======
+//
+//  Long sweeps for the Level-1 routines copy, scal and swap and for the
+//  beta-scaling passes of the matrix-vector and matrix-matrix routines.
+//
+//  A sweep over a vector too long to stay in cache gains nothing from
+//  leaving its result there: every ordinary store first reads the line it
+//  writes into, and the lines it fills evict data the caller still needs.
+//  Sweeps of more than the stream parameter of tune.h elements are split
+//  over the thread pool, and those that only write their output, the copy
+//  and the clearing of y or C for beta=0, store it with non-temporal
+//  stores, which go straight to memory without reading the line first.
+//  Sweeps that update a vector in place, scal, swap and the scaling by a
+//  nonzero beta, have already brought each line into cache by the time it
+//  is written, so they keep ordinary stores and prefetch the lines a
+//  fixed distance ahead instead.  Shorter sweeps are left to the callers'
+//  own loops.
+//
+//  Non-temporal stores are used where SSE2 is available; elsewhere the
+//  output is written with ordinary stores and only the threading remains.
+//
+
+#ifndef __stream__
+#define __stream__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    //  Number of elements between successive prefetches of an in-place
+    //  sweep.
+
+    const size_t stream_block=64;
+
+    //  Distance in bytes ahead of the sweep at which lines are prefetched.
+
+    const size_t stream_ahead=2048;
+
+    //  True if a sweep over n elements of type T should bypass the cache.
+
+    template <typename T>
+    inline bool streamed(size_t n)
+    {
+        const size_t s=profile<T>().stream;
+        return (s>0)&&(n>s);
+    }
+
+    //  Prefetches for writing the lines stream_ahead bytes beyond the n
+    //  elements at x.
+
+    template <typename T>
+    inline void stream_prefetch(size_t n, const T *x)
+    {
+#ifdef __GNUC__
+        const char *p=reinterpret_cast<const char *>(x)+stream_ahead;
+        for(size_t b=0;b<n*sizeof(T);b+=64)
+            __builtin_prefetch(p+b,1,0);
+#endif
+    }
+
+    //  Orders the non-temporal stores of the calling thread before any of
+    //  its later stores.
+
+    inline void stream_fence()
+    {
+#ifdef __SSE2__
+        _mm_sfence();
+#endif
+    }
+
+    //  y(i) <- f(i) for i=0,...,n-1 with non-temporal stores, in pieces of
+    //  16 bytes once y is aligned to them.
+
+    template <typename T, typename F>
+    void stream_store(size_t n, T *y, F f)
+    {
+        size_t i=0;
+#ifdef __SSE2__
+        const size_t w=16/sizeof(T);
+        if((w>0)&&(16%sizeof(T)==0)&&(reinterpret_cast<std::uintptr_t>(y)%sizeof(T)==0))
+        {
+            for(;(i<n)&&(reinterpret_cast<std::uintptr_t>(y+i)%16!=0);i++)
+                y[i]=f(i);
+            for(;i+w<=n;i+=w)
+            {
+                T v[16/sizeof(T)];
+                for(size_t t=0;t<w;t++)
+                    v[t]=f(i+t);
+                _mm_stream_si128(reinterpret_cast<__m128i *>(y+i),_mm_loadu_si128(reinterpret_cast<const __m128i *>(v)));
+            }
+        }
+#endif
+        for(;i<n;i++)
+            y[i]=f(i);
+        stream_fence();
+    }
+
+    //  x(i) <- f(x(i)) for i=0,...,n-1 with ordinary stores.
+
+    template <typename T, typename F>
+    void stream_update(size_t n, T *x, F f)
+    {
+        for(size_t i=0;i<n;i+=stream_block)
+        {
+            const size_t nb=std::min(stream_block,n-i);
+            T *u=x+i;
+            stream_prefetch(nb,u);
+            for(size_t t=0;t<nb;t++)
+                u[t]=f(u[t]);
+        }
+    }
+
+    //  y <- x, x <- beta * x and x <-> y for unit-stride vectors of length
+    //  n, split over the thread pool.
+
+    template <typename T>
+    void parallel_copy(size_t n, const T *x, T *y)
+    {
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            const T *u=x+begin;
+            stream_store(end-begin,y+begin,[=](size_t i){ return u[i]; });
+        });
+    }
+
+    template <typename T, typename U>
+    void parallel_scale(size_t n, U beta, T *x)
+    {
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            stream_update(end-begin,x+begin,[=](const T &a){ return beta*a; });
+        });
+    }
+
+    template <typename T>
+    void parallel_exchange(size_t n, T *x, T *y)
+    {
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            for(size_t i=begin;i<end;i+=stream_block)
+            {
+                const size_t nb=std::min(stream_block,end-i);
+                T *u=x+i;
+                T *v=y+i;
+                stream_prefetch(nb,u);
+                stream_prefetch(nb,v);
+                for(size_t t=0;t<nb;t++)
+                {
+                    const T a=u[t];
+                    u[t]=v[t];
+                    v[t]=a;
+                }
+            }
+        });
+    }
+
+    //  C <- beta * C for the m-by-n matrix C, where beta=0 clears C, with
+    //  the columns split over the thread pool.  Returns false, leaving C
+    //  untouched, if C is too small to be streamed.
+
+    template <typename T>
+    bool stream_scale(size_t m, size_t n, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+        if(!streamed<T>(m*n))
+            return false;
+        parallel_for(n,std::max(size_t(1),profile<T>().l1/std::max(m,size_t(1))),[=](size_t begin, size_t end)
+        {
+            for(size_t j=begin;j<end;j++)
+            {
+                T *c=C+j*ldC;
+                if(beta==zero)
+                    stream_store(m,c,[=](size_t){ return zero; });
+                else
+                    stream_update(m,c,[=](const T &a){ return beta*a; });
+            }
+        });
+        return true;
+    }
+}
+#endif
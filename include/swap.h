@@ -19,6 +19,10 @@
 //
 //  incy    stride of vector y; if negative, y is stored in reverse order
 //
+//  Unit-stride vectors longer than the stream parameter of tune.h are
+//  split over the thread pool and prefetched ahead of the sweep (see
+//  stream.h).
+//
 
 #ifndef __swap__
 #define __swap__
@@ -26,6 +30,8 @@
 #include <complex>
 #include <cstddef>
 #include <utility>
+#include "stream.h"
+#include "stride.h"
 
 using std::complex;
 using std::size_t;
@@ -36,23 +42,10 @@ namespace tblas
     template <typename T>
     void swap(size_t n, T *x, ptrdiff_t incx, T *y, ptrdiff_t incy)
     {
-        using std::swap;
-        if((incx==1)&&(incy==1))
-        {
-            for(size_t i=0;i<n;i++)
-                swap(x[i],y[i]);
-        }
+        if((incx==1)&&(incy==1)&&streamed<T>(n))
+            parallel_exchange(n,x,y);
         else
-        {
-            size_t ix=incx>0?0:(1-n)*incx;
-            size_t iy=incy>0?0:(1-n)*incy;
-            for(size_t i=0;i<n;i++)
-            {
-                swap(x[ix],y[iy]);
-                ix+=incx;
-                iy+=incy;
-            }
-        }
+            pairwise(n,x,incx,y,incy,[](T &a, T &b){ T t=a; a=b; b=t; });
     }
 }
 #endif
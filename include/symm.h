@@ -36,7 +36,7 @@
 //
 //  ldB     column length of the matrix B, must be at least m
 //
-//  beta    scalar multiple of C
+//  beta    scalar multiple of C; if zero, C need not be set on entry
 //
 //  C       matrix of size m-by-n
 //
@@ -98,7 +98,7 @@ namespace tblas
                             c[k]+=t*a[k];
                             s+=b[k]*a[k];
                         }
-                        c[i]=beta*c[i]+t*a[i]+alpha*s;
+                        c[i]=((beta==zero)?zero:beta*c[i])+t*a[i]+alpha*s;
                         a+=ldA;
                     }
                     b+=ldB;
@@ -122,7 +122,7 @@ namespace tblas
                             c[k]+=t*a[k];
                             s+=b[k]*a[k];
                         }
-                        c[i]=beta*c[i]+t*a[i]+alpha*s;
+                        c[i]=((beta==zero)?zero:beta*c[i])+t*a[i]+alpha*s;
                     }
                     b+=ldB;
                     c+=ldC;
@@ -139,8 +139,16 @@ namespace tblas
                 for(size_t j=0;j<n;j++)
                 {
                     T t=alpha*a[j];
-                    for(size_t i=0;i<m;i++)
-                        c[i]=c[i]*beta+t*b[i];
+                    if(beta==zero)
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=t*b[i];
+                    }
+                    else
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=c[i]*beta+t*b[i];
+                    }
                     T *at=A+(j+1)*ldA;
                     T *bt=B;
                     for(size_t k=0;k<j;k++)
@@ -172,8 +180,16 @@ namespace tblas
                 for(size_t j=0;j<n;j++)
                 {
                     T t=alpha*a[j];
-                    for(size_t i=0;i<m;i++)
-                        c[i]=c[i]*beta+t*b[i];
+                    if(beta==zero)
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=t*b[i];
+                    }
+                    else
+                    {
+                        for(size_t i=0;i<m;i++)
+                            c[i]=c[i]*beta+t*b[i];
+                    }
                     T *bt=B;
                     T *at=A;
                     for(size_t k=0;k<j;k++)
@@ -32,6 +32,9 @@
 #define __syr__
 
 #include <cstddef>
+#include <vector>
+#include "rank.h"
+#include "tune.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -46,65 +49,21 @@ namespace tblas
         if((n==0)||(alpha==zero))
             return;
 
-        if(incx==1)
+        std::vector<T> u;
+        std::vector<T> t(n);
+        if(incx!=1)
         {
-            if(uplo=='U')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[j];
-                    for(size_t i=0;i<=j;i++)
-                        A[i]+=x[i]*t;
-                    A+=ldA;
-                }
-            }
-            else if(uplo=='L')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[j];
-                    for(size_t i=j;i<n;i++)
-                        A[i]+=x[i]*t;
-                    A+=ldA;
-                }
-            }
+            gather(n,x,incx,u);
+            x=u.data();
         }
-        else
+        for(size_t j=0;j<n;j++)
+            t[j]=alpha*x[j];
+
+        const T *tx=t.data();
+        parallel_triangle(uplo,n,profile<T>().l2,[=](size_t j0, size_t j1)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(uplo=='U')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[jx];
-                    size_t ix=kx;
-                    for(size_t i=0;i<=j;i++)
-                    {
-                        A[i]+=x[ix]*t;
-                        ix+=incx;
-                    }
-                    A+=ldA;
-                    jx+=incx;
-                }
-            }
-            else if(uplo=='L')
-            {
-                size_t jx=kx;
-                for(size_t j=0;j<n;j++)
-                {
-                    T t=alpha*x[jx];
-                    size_t ix=jx;
-                    for(size_t i=j;i<n;i++)
-                    {
-                        A[i]+=x[ix]*t;
-                        ix+=incx;
-                    }
-                    jx+=incx;
-                    A+=ldA;
-                }
-            }
-        }
+            rank1_triangle(uplo,n,j0,j1,x,tx,A,ldA,[](T &a, T xj, T tj){ a+=xj*tj; });
+        });
     }
 }
 #endif
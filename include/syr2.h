@@ -36,6 +36,9 @@
 #define __syr2__
 
 #include <cstddef>
+#include <vector>
+#include "rank.h"
+#include "tune.h"
 
 using std::size_t;
 using std::ptrdiff_t;
@@ -49,79 +52,33 @@ namespace tblas
         
         if((n==0)||(alpha==zero))
             return;
-        
-        if((incx==1)&&(incy==1))
+
+        std::vector<T> u;
+        std::vector<T> v;
+        std::vector<T> s(n);
+        std::vector<T> t(n);
+        if(incx!=1)
+        {
+            gather(n,x,incx,u);
+            x=u.data();
+        }
+        if(incy!=1)
         {
-            if(uplo=='U')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    T tx=alpha*x[j];
-                    T ty=alpha*y[j];
-                    for(size_t i=0;i<=j;i++)
-                        A[i]+=x[i]*ty+y[i]*tx;
-                    A+=ldA;
-                }
-            }
-            else if(uplo=='L')
-            {
-                for(size_t j=0;j<n;j++)
-                {
-                    T tx=alpha*x[j];
-                    T ty=alpha*y[j];
-                    for(size_t i=j;i<n;i++)
-                        A[i]+=x[i]*ty+y[i]*tx;
-                    A+=ldA;
-                }
-            }
+            gather(n,y,incy,v);
+            y=v.data();
         }
-        else
+        for(size_t j=0;j<n;j++)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            size_t ky=(incy>0)?0:(1-n)*incy;
-            if(uplo=='U')
-            {
-                size_t jx=kx;
-                size_t jy=ky;
-                for(size_t j=0;j<n;j++)
-                {
-                    T tx=alpha*x[jx];
-                    T ty=alpha*y[jy];
-                    size_t ix=kx;
-                    size_t iy=ky;
-                    for(size_t i=0;i<=j;i++)
-                    {
-                        A[i]+=x[ix]*ty+y[iy]*tx;
-                        ix+=incx;
-                        iy+=incy;
-                    }
-                    A+=ldA;
-                    jx+=incx;
-                    jy+=incy;
-                }
-            }
-            else if(uplo=='L')
-            {
-                size_t jx=kx;
-                size_t jy=ky;
-                for(size_t j=0;j<n;j++)
-                {
-                    T tx=alpha*x[jx];
-                    T ty=alpha*y[jy];
-                    size_t ix=jx;
-                    size_t iy=jy;
-                    for(size_t i=j;i<n;i++)
-                    {
-                        A[i]+=x[ix]*ty+y[iy]*tx;
-                        ix+=incx;
-                        iy+=incy;
-                    }
-                    jx+=incx;
-                    jy+=incy;
-                    A+=ldA;
-                }
-            }
+            s[j]=alpha*y[j];
+            t[j]=alpha*x[j];
         }
+
+        const T *ty=s.data();
+        const T *tx=t.data();
+        parallel_triangle(uplo,n,profile<T>().l2,[=](size_t j0, size_t j1)
+        {
+            rank2_triangle(uplo,n,j0,j1,x,ty,y,tx,A,ldA,[](T &a, T xj, T sj, T yj, T tj){ a+=xj*sj+yj*tj; });
+        });
     }
 }
 #endif
@@ -35,22 +35,35 @@
 //
 //  ldB     column length of the matrix B, must be at least n if trans='N' or k if trans='T'
 //
-//  beta    scalar multiple of C
+//  beta    scalar multiple of C; if zero, C need not be set on entry
 //
 //  C       symmetric matrix of order n
 //
 //  ldC     column length of the matrix C, must be at least n
 //
+//  If C spans more than one tile of dag.h, the update is split into tile
+//  tasks and run on a task graph; syr2k(g,...) queues those tasks on the
+//  task graph g instead.
+//
 
 #ifndef __syr2k__
 #define __syr2k__
 
+#include <algorithm>
 #include <cstddef>
+#include <vector>
+#include "dag.h"
+#include "gemm.h"
 
 using std::size_t;
 
 namespace tblas
 {
+    //  Queues the update on a task graph (see below).
+
+    template <typename T>
+    void syr2k(task_graph &g, char uplo, char trans, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC);
+
     template <typename T>
     void syr2k(char uplo, char trans, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
     {
@@ -59,8 +72,16 @@ namespace tblas
         
         if((n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
             return;
+
+        if(n>tile_order<T>())
+        {
+            task_graph g;
+            syr2k(g,uplo,trans,n,k,alpha,A,ldA,B,ldB,beta,C,ldC);
+            g.wait();
+            return;
+        }
         
-        if(alpha==zero)
+        if((alpha==zero)||(k==0))
         {
             if(uplo=='U')
             {
@@ -114,16 +135,27 @@ namespace tblas
                 T *c=C;
                 for(size_t j=0;j<n;j++)
                 {
-                    for(size_t i=0;i<=j;i++)
-                        c[i]*=beta;
                     T *a=A;
                     T *b=B;
                     for(size_t l=0;l<k;l++)
                     {
                         T s=alpha*b[j];
                         T t=alpha*a[j];
-                        for(size_t i=0;i<=j;i++)
-                            c[i]+=s*a[i]+t*b[i];
+                        if(l>0)
+                        {
+                            for(size_t i=0;i<=j;i++)
+                                c[i]+=s*a[i]+t*b[i];
+                        }
+                        else if(beta==zero)
+                        {
+                            for(size_t i=0;i<=j;i++)
+                                c[i]=s*a[i]+t*b[i];
+                        }
+                        else
+                        {
+                            for(size_t i=0;i<=j;i++)
+                                c[i]=beta*c[i]+s*a[i]+t*b[i];
+                        }
                         a+=ldA;
                         b+=ldB;
                     }
@@ -135,16 +167,27 @@ namespace tblas
                 T *c=C;
                 for(size_t j=0;j<n;j++)
                 {
-                    for(size_t i=j;i<n;i++)
-                        c[i]*=beta;
                     T *a=A;
                     T *b=B;
                     for(size_t l=0;l<k;l++)
                     {
                         T s=alpha*b[j];
                         T t=alpha*a[j];
-                        for(size_t i=j;i<n;i++)
-                            c[i]+=s*a[i]+t*b[i];
+                        if(l>0)
+                        {
+                            for(size_t i=j;i<n;i++)
+                                c[i]+=s*a[i]+t*b[i];
+                        }
+                        else if(beta==zero)
+                        {
+                            for(size_t i=j;i<n;i++)
+                                c[i]=s*a[i]+t*b[i];
+                        }
+                        else
+                        {
+                            for(size_t i=j;i<n;i++)
+                                c[i]=beta*c[i]+s*a[i]+t*b[i];
+                        }
                         a+=ldA;
                         b+=ldB;
                     }
@@ -172,7 +215,7 @@ namespace tblas
                             s+=b[l]*at[l];
                             t+=a[l]*bt[l];
                         }
-                        c[i]=alpha*t+alpha*s+beta*c[i];
+                        c[i]=(beta==zero)?alpha*t+alpha*s:alpha*t+alpha*s+beta*c[i];
                         a+=ldA;
                         b+=ldB;
                     }
@@ -199,7 +242,7 @@ namespace tblas
                             s+=b[l]*at[l];
                             t+=a[l]*bt[l];
                         }
-                        c[i]=alpha*t+alpha*s+beta*c[i];
+                        c[i]=(beta==zero)?alpha*t+alpha*s:alpha*t+alpha*s+beta*c[i];
                         a+=ldA;
                         b+=ldB;
                     }
@@ -210,5 +253,60 @@ namespace tblas
             }
         }
     }
+
+    //  Queues the update on g as one task per tile of the triangle uplo of
+    //  C: the diagonal tiles by syr2k and the others by two gemm calls.
+
+    template <typename T>
+    void syr2k(task_graph &g, char uplo, char trans, size_t n, size_t k, T alpha, T *A, size_t ldA, T *B, size_t ldB, T beta, T *C, size_t ldC)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((n==0)||(((alpha==zero)||(k==0))&&(beta==one)))
+            return;
+
+        const size_t nb=tile_order<T>();
+        const bool scale=((alpha==zero)||(k==0));
+        const char tA=(trans=='N')?'N':'T';
+        const char tB=(trans=='N')?'T':'N';
+        for(size_t j0=0;j0<n;j0+=nb)
+        {
+            const size_t jb=std::min(nb,n-j0);
+            T *aj=(trans=='N')?A+j0:A+j0*ldA;
+            T *bj=(trans=='N')?B+j0:B+j0*ldB;
+            const size_t i0=(uplo=='U')?0:j0;
+            const size_t i1=(uplo=='U')?j0+jb:n;
+            for(size_t ib0=i0;ib0<i1;ib0+=nb)
+            {
+                const size_t ib=std::min(nb,n-ib0);
+                T *ai=(trans=='N')?A+ib0:A+ib0*ldA;
+                T *bi=(trans=='N')?B+ib0:B+ib0*ldB;
+                T *c=C+ib0+j0*ldC;
+                std::vector<tile_access> data;
+                if(!scale)
+                {
+                    tile_panel(trans,ib0,ib,k,nb,A,ldA,data);
+                    tile_panel(trans,ib0,ib,k,nb,B,ldB,data);
+                    if(ib0!=j0)
+                    {
+                        tile_panel(trans,j0,jb,k,nb,A,ldA,data);
+                        tile_panel(trans,j0,jb,k,nb,B,ldB,data);
+                    }
+                }
+                data.push_back(tile_write(c,ib,jb,ldC));
+                if(ib0==j0)
+                    g.submit([=]{ syr2k(uplo,trans,jb,k,alpha,aj,ldA,bj,ldB,beta,c,ldC); },data);
+                else if(scale)
+                    g.submit([=]{ gemm_scale(ib,jb,beta,c,ldC); },data);
+                else
+                    g.submit([=]
+                    {
+                        gemm_blocked(tA,tB,ib,jb,k,alpha,ai,ldA,bj,ldB,beta,c,ldC,profile<T>());
+                        gemm_blocked(tA,tB,ib,jb,k,alpha,bi,ldB,aj,ldA,one,c,ldC,profile<T>());
+                    },data);
+            }
+        }
+    }
 }
 #endif
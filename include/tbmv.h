@@ -43,6 +43,10 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "band.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -50,384 +54,51 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
-    inline size_t maxsub(size_t j, size_t k)
-    {
-        return (j>k)?j-k:0;
-    }
-    
-    inline size_t minadd(size_t j, size_t k, size_t n)
-    {
-        return (j+k<n)?j+k:n;
-    }
+    //  x <- op(A) * x or op(A)^T * x, with the product formed diagonal by
+    //  diagonal into workspace (see band.h).
 
-    template <typename T>
-    void tbmv(char uplo, char trans, char diag, size_t n, size_t k, T *A, size_t ldA, T *x, ptrdiff_t incx)
+    template <typename T, typename C>
+    void tbmv_band(char uplo, char trans, char diag, size_t n, size_t k, T *A, size_t ldA, T *x, ptrdiff_t incx, C op)
     {
         const bool nounit(diag=='N');
-        
-        if(incx==1)
+
+        if(n==0)
+            return;
+
+        std::vector<T> u;
+        const T *v=x;
+        if(incx!=1)
         {
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        for(size_t i=i0;i<j;i++)
-                            x[i]+=x[j]*A[k-j+i];
-                        if(nounit)
-                            x[j]*=A[k];
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        for(ptrdiff_t i=im;i>j;i--)
-                            x[i]+=x[j]*A[i-j];
-                        if(nounit)
-                            x[j]*=A[0];
-                    }
-                }
-            }
-            else if((trans=='T')||(trans=='C'))
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]*=A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                            x[j]+=A[k+i-j]*x[i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]*=A[0];
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                            x[j]+=A[i-j]*x[i];
-                        A+=ldA;
-                    }
-                }
-            }
+            gather(n,x,incx,u);
+            v=u.data();
         }
-        else
+        std::vector<T> w(nounit?n:0,T(0));
+        if(!nounit)
+            w.assign(v,v+n);
+        const size_t ku=(uplo=='U')?k:0;
+        const ptrdiff_t d0=(uplo=='U')?-static_cast<ptrdiff_t>(k):(nounit?0:1);
+        const ptrdiff_t d1=(uplo=='U')?(nounit?0:-1):static_cast<ptrdiff_t>(k);
+        T *y=w.data();
+        parallel_band(n,k+1,profile<T>().l2,[=](size_t o0, size_t o1)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        size_t ix=kx+i0*incx;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            x[ix]+=x[jx]*A[k+i-j];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]*=A[k];
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    size_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        size_t ix=kx-(n-im)*incx;
-                        for(ptrdiff_t i=im;i>j;i--)
-                        {
-                            x[ix]+=x[jx]*A[i-j];
-                            ix-=incx;
-                        }
-                        if(nounit)
-                            x[jx]*=A[0];
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    size_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]*=A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                        {
-                            ix-=incx;
-                            x[jx]+=A[k+i-j]*x[ix];
-                        }
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]*=A[0];
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                        {
-                            ix+=incx;
-                            x[jx]+=A[i-j]*x[ix];
-                        }
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-            }
-        }
+            band_mv((trans=='N')?'N':'T',n,n,ku,d0,d1,A,ldA,v,y,o0,o1,op);
+        });
+        scatter(n,y,x,incx);
     }
-    
+
+    template <typename T>
+    void tbmv(char uplo, char trans, char diag, size_t n, size_t k, T *A, size_t ldA, T *x, ptrdiff_t incx)
+    {
+        tbmv_band(uplo,trans,diag,n,k,A,ldA,x,incx,[](T a){ return a; });
+    }
+
     template <typename T>
     void tbmv(char uplo, char trans, char diag, size_t n, size_t k, complex<T> *A, size_t ldA, complex<T> *x, ptrdiff_t incx)
     {
-        const bool nounit(diag=='N');
-        
-        if(incx==1)
-        {
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        for(size_t i=i0;i<j;i++)
-                            x[i]+=x[j]*A[k-j+i];
-                        if(nounit)
-                            x[j]*=A[k];
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        for(ptrdiff_t i=im;i>j;i--)
-                            x[i]+=x[j]*A[i-j];
-                        if(nounit)
-                            x[j]*=A[0];
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]*=A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                            x[j]+=A[k+i-j]*x[i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]*=A[0];
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                            x[j]+=A[i-j]*x[i];
-                        A+=ldA;
-                    }
-                }
-            }
-            else if(trans=='C')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]*=conj(A[k]);
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                            x[j]+=conj(A[k+i-j])*x[i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]*=conj(A[0]);
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                            x[j]+=conj(A[i-j])*x[i];
-                        A+=ldA;
-                    }
-                }
-            }
-        }
+        if(trans=='C')
+            tbmv_band(uplo,trans,diag,n,k,A,ldA,x,incx,[](complex<T> a){ return conj(a); });
         else
-        {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        size_t ix=kx+i0*incx;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            x[ix]+=x[jx]*A[k+i-j];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]*=A[k];
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    size_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        size_t ix=kx-(n-im)*incx;
-                        for(ptrdiff_t i=im;i>j;i--)
-                        {
-                            x[ix]+=x[jx]*A[i-j];
-                            ix-=incx;
-                        }
-                        if(nounit)
-                            x[jx]*=A[0];
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    size_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]*=A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                        {
-                            ix-=incx;
-                            x[jx]+=A[k+i-j]*x[ix];
-                        }
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]*=A[0];
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                        {
-                            ix+=incx;
-                            x[jx]+=A[i-j]*x[ix];
-                        }
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-            }
-            else if(trans=='C')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    size_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]*=conj(A[k]);
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                        {
-                            ix-=incx;
-                            x[jx]+=conj(A[k+i-j])*x[ix];
-                        }
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]*=conj(A[0]);
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                        {
-                            ix+=incx;
-                            x[jx]+=conj(A[i-j])*x[ix];
-                        }
-                        A+=ldA;
-                        jx+=incx;
-                    }
-                }
-            }
-        }
+            tbmv_band(uplo,trans,diag,n,k,A,ldA,x,incx,[](complex<T> a){ return a; });
     }
 }
 #endif
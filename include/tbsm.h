@@ -0,0 +1,190 @@
+//
+//  tbsm.h
+//
+//  Purpose
+//  =======
+//
+//  Solves one of the following systems:
+//
+//      A   * X = alpha * B  [trans='N']
+//
+//      A^T * X = alpha * B  [trans='T']
+//
+//      A^H * X = alpha * B  [trans='C']
+//
+//  where X and B are n-by-nrhs matrices, alpha is a scalar and A is an
+//  n-by-n triangular band matrix with k+1 diagonals.  If diag='U', the
+//  matrix is assumed to be unit triangular, or diag='N' for nonunit
+//  triangular.
+//
+//  The right-hand sides are solved together in blocks of band_rhs columns.
+//  Each block is transposed, a row at a time, into a window of k+1 rows
+//  that moves down (or up) the band along with the substitution, so every
+//  column of A is read once per block and each step of the substitution is
+//  a handful of unit-stride vector operations across the block instead of
+//  one short loop per right-hand side.  Blocks are split over the thread
+//  pool.
+//
+//  Arguments
+//  ==========
+//
+//  uplo    specifies whether matrix is upper ('U') or lower ('L') triangular
+//
+//  trans   specifies the transpose operation for A as above
+//
+//  diag    specifies whether the matrix A is unit triangular ('U') or not ('N')
+//
+//  n       specifies the order of the triangular matrix A
+//
+//  k       specifies the number of sub/super-diagonals of the matrix A
+//
+//  nrhs    specifies the number of columns of the matrix B
+//
+//  alpha   scalar multiple of the right-hand side B
+//
+//  A       band matrix stored as (k+1)-by-n array
+//
+//  ldA     specifies the column length of A, must be at least k+1
+//
+//  B       matrix of size n-by-nrhs containing the right-hand side on entry,
+//          and the solution X on exit
+//
+//  ldB     column length of the matrix B, must be at least n
+//
+
+#ifndef __tbsm__
+#define __tbsm__
+
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <vector>
+#include "band.h"
+#include "thread.h"
+#include "tune.h"
+
+using std::complex;
+using std::size_t;
+
+namespace tblas
+{
+    //  Solves the nb right-hand sides in B, using W for a window of k+1
+    //  rows of nb elements.  Step t of the substitution finishes row j,
+    //  which is row t going forward or row n-1-t going back; the window
+    //  slot of the row reached at step t is t modulo k+1.
+
+    template <typename T, typename C>
+    void tbsm_block(char uplo, char trans, char diag, size_t n, size_t k, size_t nb, T alpha, const T *A, size_t ldA, T *B, size_t ldB, T *W, C op)
+    {
+        const bool nounit(diag=='N');
+        const bool forward=((uplo=='L')==(trans=='N'));
+        const bool right=(trans=='N');
+        const size_t w=k+1;
+        const size_t dk=(uplo=='U')?k:0;
+
+        auto load=[&](size_t t)
+        {
+            const T *b=B+(forward?t:n-1-t);
+            T *x=W+(t%w)*nb;
+            for(size_t c=0;c<nb;c++)
+                x[c]=alpha*b[c*ldB];
+        };
+
+        auto store=[&](size_t t)
+        {
+            T *b=B+(forward?t:n-1-t);
+            const T *x=W+(t%w)*nb;
+            for(size_t c=0;c<nb;c++)
+                b[c*ldB]=x[c];
+        };
+
+        if(right)
+        {
+            for(size_t t=0;t<std::min(k,n);t++)
+                load(t);
+        }
+        for(size_t t=0;t<n;t++)
+        {
+            const size_t j=forward?t:n-1-t;
+            const T *a=A+j*ldA;
+            T *x=W+(t%w)*nb;
+            if(right)
+            {
+                if(t+k<n)
+                    load(t+k);
+                if(nounit)
+                {
+                    const T d=a[dk];
+                    for(size_t c=0;c<nb;c++)
+                        x[c]/=d;
+                }
+                for(size_t s=1;s<=std::min(k,n-1-t);s++)
+                {
+                    const T as=a[(uplo=='U')?k-s:s];
+                    T *r=W+((t+s)%w)*nb;
+                    for(size_t c=0;c<nb;c++)
+                        r[c]-=as*x[c];
+                }
+            }
+            else
+            {
+                load(t);
+                for(size_t s=std::min(k,t);s>=1;s--)
+                {
+                    const T as=op(a[(uplo=='U')?k-s:s]);
+                    const T *r=W+((t-s)%w)*nb;
+                    for(size_t c=0;c<nb;c++)
+                        x[c]-=as*r[c];
+                }
+                if(nounit)
+                {
+                    const T d=op(a[dk]);
+                    for(size_t c=0;c<nb;c++)
+                        x[c]/=d;
+                }
+            }
+            store(t);
+        }
+    }
+
+    template <typename T, typename C>
+    void tbsm_band(char uplo, char trans, char diag, size_t n, size_t k, size_t nrhs, T alpha, T *A, size_t ldA, T *B, size_t ldB, C op)
+    {
+        const T zero(0.0);
+
+        if((n==0)||(nrhs==0))
+            return;
+
+        if(alpha==zero)
+        {
+            for(size_t j=0;j<nrhs;j++)
+                for(size_t i=0;i<n;i++)
+                    B[i+j*ldB]=zero;
+            return;
+        }
+
+        const size_t grain=std::max(size_t(1),profile<T>().l2/(n*(k+1)));
+        parallel_for(nrhs,grain,[=](size_t begin, size_t end)
+        {
+            std::vector<T> W((k+1)*band_rhs);
+            for(size_t j=begin;j<end;j+=band_rhs)
+                tbsm_block(uplo,trans,diag,n,k,std::min(band_rhs,end-j),alpha,A,ldA,B+j*ldB,ldB,W.data(),op);
+        });
+    }
+
+    template <typename T>
+    void tbsm(char uplo, char trans, char diag, size_t n, size_t k, size_t nrhs, T alpha, T *A, size_t ldA, T *B, size_t ldB)
+    {
+        tbsm_band(uplo,trans,diag,n,k,nrhs,alpha,A,ldA,B,ldB,[](T a){ return a; });
+    }
+
+    template <typename T>
+    void tbsm(char uplo, char trans, char diag, size_t n, size_t k, size_t nrhs, complex<T> alpha, complex<T> *A, size_t ldA, complex<T> *B, size_t ldB)
+    {
+        if(trans=='C')
+            tbsm_band(uplo,trans,diag,n,k,nrhs,alpha,A,ldA,B,ldB,[](complex<T> a){ return conj(a); });
+        else
+            tbsm_band(uplo,trans,diag,n,k,nrhs,alpha,A,ldA,B,ldB,[](complex<T> a){ return a; });
+    }
+}
+#endif
@@ -43,6 +43,8 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "stride.h"
 
 using std::complex;
 using std::size_t;
@@ -64,147 +66,67 @@ namespace tblas
     void tbsv(char uplo, char trans, char diag, size_t n, size_t k, T *A, size_t ldA, T *x, ptrdiff_t incx)
     {
         const bool nounit(diag=='N');
-        if(incx==1)
+        if(incx!=1)
         {
-            if(trans=='N')
+            std::vector<T> u;
+            gather(n,x,incx,u);
+            tbsv(uplo,trans,diag,n,k,A,ldA,u.data(),1);
+            scatter(n,u.data(),x,incx);
+            return;
+        }
+        if(trans=='N')
+        {
+            if(uplo=='U')
             {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]=x[j]/A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                            x[i]-=x[j]*A[k-j+i];
-                    }
-                }
-                else if(uplo=='L')
+                A+=n*ldA;
+                for(ptrdiff_t j=n-1;j>=0;j--)
                 {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                            x[i]-=x[j]*A[i-j];
-                        A+=ldA;
-                    }
+                    A-=ldA;
+                    if(nounit)
+                        x[j]=x[j]/A[k];
+                    ptrdiff_t i0=maxsub(j,k);
+                    for(ptrdiff_t i=j-1;i>=i0;i--)
+                        x[i]-=x[j]*A[k-j+i];
                 }
             }
-            else if((trans=='T')||(trans=='C'))
+            else if(uplo=='L')
             {
-                if(uplo=='U')
+                for(size_t j=0;j<n;j++)
                 {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        for(size_t i=i0;i<j;i++)
-                            x[j]-=x[i]*A[k-j+i];
-                        if(nounit)
-                            x[j]=x[j]/A[k];
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        for(ptrdiff_t i=im;i>j;i--)
-                            x[j]-=x[i]*A[i-j];
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                    }
+                    if(nounit)
+                        x[j]=x[j]/A[0];
+                    size_t im=minadd(j,k,n-1);
+                    for(size_t i=j+1;i<=im;i++)
+                        x[i]-=x[j]*A[i-j];
+                    A+=ldA;
                 }
             }
         }
-        else
+        else if((trans=='T')||(trans=='C'))
         {
-            ptrdiff_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
+            if(uplo=='U')
             {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    ptrdiff_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        ptrdiff_t ix=jx;
-                        if(nounit)
-                            x[jx]=x[jx]/A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                        {
-                            ix-=incx;
-                            x[ix]-=x[jx]*A[k-j+i];
-                        }
-                    }
-                }
-                else if(uplo=='L')
+                for(size_t j=0;j<n;j++)
                 {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                        size_t ix=jx;
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                        {
-                            ix+=incx;
-                            x[ix]-=x[jx]*A[i-j];
-                        }
-                        jx+=incx;
-                        A+=ldA;
-                    }
+                    size_t i0=maxsub(j,k);
+                    for(size_t i=i0;i<j;i++)
+                        x[j]-=x[i]*A[k-j+i];
+                    if(nounit)
+                        x[j]=x[j]/A[k];
+                    A+=ldA;
                 }
             }
-            else if((trans=='T')||(trans=='C'))
+            else if(uplo=='L')
             {
-                if(uplo=='U')
+                A+=n*ldA;
+                for(ptrdiff_t j=n-1;j>=0;j--)
                 {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        size_t ix=kx+i0*incx;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*A[k-j+i];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[k];
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    ptrdiff_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        ptrdiff_t ix=kx-(n-im)*incx;
-                        for(ptrdiff_t i=im;i>j;i--)
-                        {
-                            x[jx]-=x[ix]*A[i-j];
-                            ix-=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                    }
+                    A-=ldA;
+                    ptrdiff_t im=minadd(j,k,n-1);
+                    for(ptrdiff_t i=im;i>j;i--)
+                        x[j]-=x[i]*A[i-j];
+                    if(nounit)
+                        x[j]=x[j]/A[0];
                 }
             }
         }
@@ -214,216 +136,95 @@ namespace tblas
     void tbsv(char uplo, char trans, char diag, size_t n, size_t k, complex<T> *A, size_t ldA, complex<T> *x, ptrdiff_t incx)
     {
         const bool nounit(diag=='N');
-        if(incx==1)
+        if(incx!=1)
         {
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]=x[j]/A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                            x[i]-=x[j]*A[k-j+i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                            x[i]-=x[j]*A[i-j];
-                        A+=ldA;
-                    }
-                }
-            }
-            else if(trans=='T')
+            std::vector<complex<T> > u;
+            gather(n,x,incx,u);
+            tbsv(uplo,trans,diag,n,k,A,ldA,u.data(),1);
+            scatter(n,u.data(),x,incx);
+            return;
+        }
+        if(trans=='N')
+        {
+            if(uplo=='U')
             {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        for(size_t i=i0;i<j;i++)
-                            x[j]-=x[i]*A[k-j+i];
-                        if(nounit)
-                            x[j]=x[j]/A[k];
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
+                A+=n*ldA;
+                for(ptrdiff_t j=n-1;j>=0;j--)
                 {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        for(ptrdiff_t i=im;i>j;i--)
-                            x[j]-=x[i]*A[i-j];
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                    }
+                    A-=ldA;
+                    if(nounit)
+                        x[j]=x[j]/A[k];
+                    ptrdiff_t i0=maxsub(j,k);
+                    for(ptrdiff_t i=j-1;i>=i0;i--)
+                        x[i]-=x[j]*A[k-j+i];
                 }
             }
-            else if(trans=='C')
+            else if(uplo=='L')
             {
-                if(uplo=='U')
+                for(size_t j=0;j<n;j++)
                 {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        for(size_t i=i0;i<j;i++)
-                            x[j]-=x[i]*conj(A[k-j+i]);
-                        if(nounit)
-                            x[j]=x[j]/conj(A[k]);
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        for(ptrdiff_t i=im;i>j;i--)
-                            x[j]-=x[i]*conj(A[i-j]);
-                        if(nounit)
-                            x[j]=x[j]/conj(A[0]);
-                    }
+                    if(nounit)
+                        x[j]=x[j]/A[0];
+                    size_t im=minadd(j,k,n-1);
+                    for(size_t i=j+1;i<=im;i++)
+                        x[i]-=x[j]*A[i-j];
+                    A+=ldA;
                 }
             }
         }
-        else
+        else if(trans=='T')
         {
-            ptrdiff_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
+            if(uplo=='U')
             {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    ptrdiff_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        ptrdiff_t ix=jx;
-                        if(nounit)
-                            x[jx]=x[jx]/A[k];
-                        ptrdiff_t i0=maxsub(j,k);
-                        for(ptrdiff_t i=j-1;i>=i0;i--)
-                        {
-                            ix-=incx;
-                            x[ix]-=x[jx]*A[k-j+i];
-                        }
-                    }
-                }
-                else if(uplo=='L')
+                for(size_t j=0;j<n;j++)
                 {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                        size_t ix=jx;
-                        size_t im=minadd(j,k,n-1);
-                        for(size_t i=j+1;i<=im;i++)
-                        {
-                            ix+=incx;
-                            x[ix]-=x[jx]*A[i-j];
-                        }
-                        jx+=incx;
-                        A+=ldA;
-                    }
+                    size_t i0=maxsub(j,k);
+                    for(size_t i=i0;i<j;i++)
+                        x[j]-=x[i]*A[k-j+i];
+                    if(nounit)
+                        x[j]=x[j]/A[k];
+                    A+=ldA;
                 }
             }
-            else if(trans=='T')
+            else if(uplo=='L')
             {
-                if(uplo=='U')
+                A+=n*ldA;
+                for(ptrdiff_t j=n-1;j>=0;j--)
                 {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        size_t ix=kx+i0*incx;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*A[k-j+i];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[k];
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    ptrdiff_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        ptrdiff_t ix=kx-(n-im)*incx;
-                        for(ptrdiff_t i=im;i>j;i--)
-                        {
-                            x[jx]-=x[ix]*A[i-j];
-                            ix-=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                    }
+                    A-=ldA;
+                    ptrdiff_t im=minadd(j,k,n-1);
+                    for(ptrdiff_t i=im;i>j;i--)
+                        x[j]-=x[i]*A[i-j];
+                    if(nounit)
+                        x[j]=x[j]/A[0];
                 }
             }
-            else if(trans=='C')
+        }
+        else if(trans=='C')
+        {
+            if(uplo=='U')
             {
-                if(uplo=='U')
+                for(size_t j=0;j<n;j++)
                 {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t i0=maxsub(j,k);
-                        size_t ix=kx+i0*incx;
-                        for(size_t i=i0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*conj(A[k-j+i]);
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/conj(A[k]);
-                        jx+=incx;
-                        A+=ldA;
-                    }
+                    size_t i0=maxsub(j,k);
+                    for(size_t i=i0;i<j;i++)
+                        x[j]-=x[i]*conj(A[k-j+i]);
+                    if(nounit)
+                        x[j]=x[j]/conj(A[k]);
+                    A+=ldA;
                 }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    ptrdiff_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        A-=ldA;
-                        ptrdiff_t im=minadd(j,k,n-1);
-                        ptrdiff_t ix=kx-(n-im)*incx;
-                        for(ptrdiff_t i=im;i>j;i--)
-                        {
-                            x[jx]-=x[ix]*conj(A[i-j]);
-                            ix-=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/conj(A[0]);
-                    }
+            }
+            else if(uplo=='L')
+            {
+                A+=n*ldA;
+                for(ptrdiff_t j=n-1;j>=0;j--)
+                {
+                    A-=ldA;
+                    ptrdiff_t im=minadd(j,k,n-1);
+                    for(ptrdiff_t i=im;i>j;i--)
+                        x[j]-=x[i]*conj(A[i-j]);
+                    if(nounit)
+                        x[j]=x[j]/conj(A[0]);
                 }
             }
         }
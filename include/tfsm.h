@@ -0,0 +1,133 @@
+//
+//  tfsm.h
+//
+//  Purpose
+//  =======
+//
+//  Solves one of the following systems:
+//
+//      A   * X = alpha * B  [trans='N' and side='L']
+//
+//      A^T * X = alpha * B  [trans='T' and side='L']
+//
+//      A^H * X = alpha * B  [trans='C' and side='L']
+//
+//      X * A   = alpha * B  [trans='N' and side='R']
+//
+//      X * A^T = alpha * B  [trans='T' and side='R']
+//
+//      X * A^H = alpha * B  [trans='C' and side='R']
+//
+//  where X and B are m-by-n matrices, alpha is a scalar, and A is a
+//  triangular matrix in rectangular full packed format (see rfp.h).  The
+//  system is split along the diagonal blocks of A into two triangular
+//  solves, done by trsm, and one update with the off-diagonal block, done
+//  by gemm.  trans='T' is for real and trans='C' for complex matrices.
+//
+//  Arguments
+//  =========
+//
+//  transr  specifies whether A is stored in normal ('N') or transposed ('T'
+//          for real, 'C' for complex) RFP format
+//
+//  side    specifies the side from which A is applied as above
+//
+//  uplo    specifies whether matrix is upper ('U') or lower ('L') triangular
+//
+//  trans   specifies the transpose operation for A as above
+//
+//  diag    specifies whether the matrix A is unit triangular ('U') or not ('N')
+//
+//  m       specifies the number of rows in the matrix B
+//
+//  n       specifies the number of columns in the matrix B
+//
+//  alpha   scalar multiple of the right-hand side B
+//
+//  A       triangular matrix in RFP format, of order m if side='L' or n if
+//          side='R'
+//
+//  B       matrix of size m-by-n containing the right-hand side on entry,
+//          and the solution X on exit, stored in ldB-by-n array
+//
+//  ldB     column length of the matrix B, must be at least m
+//
+
+#ifndef __tfsm__
+#define __tfsm__
+
+#include <cstddef>
+#include "gemm.h"
+#include "rfp.h"
+#include "trsm.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    template <typename T>
+    void tfsm(char transr, char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, T *B, size_t ldB)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((m==0)||(n==0))
+            return;
+        if(alpha==zero)
+        {
+            for(size_t j=0;j<n;j++)
+                for(size_t i=0;i<m;i++)
+                    B[i+j*ldB]=zero;
+            return;
+        }
+
+        const char h=rfp_trans(zero);
+        const rfp_layout<T> r=rfp_blocks(transr,uplo,(side=='L')?m:n,A);
+        const size_t n1=r.n1;
+        const size_t n2=r.n2;
+        const char ta=(r.off.flip!=(trans!='N'))?h:'N';
+        const bool lower=((uplo=='L')==(trans=='N'));
+
+        //  Solves with a diagonal block, undoing its flip.
+
+        auto solve=[&](const rfp_block<T> &b, size_t p, size_t q, T s, T *X)
+        {
+            const char t=b.flip?((trans=='N')?h:'N'):trans;
+            trsm(side,rfp_uplo(b,uplo),t,diag,p,q,s,b.a,b.ld,X,ldB);
+        };
+
+        if(side=='L')
+        {
+            T *B2=B+n1;
+            if(lower)
+            {
+                solve(r.a11,n1,n,alpha,B);
+                gemm(ta,'N',n2,n,n1,-one,r.off.a,r.off.ld,B,ldB,alpha,B2,ldB);
+                solve(r.a22,n2,n,one,B2);
+            }
+            else
+            {
+                solve(r.a22,n2,n,alpha,B2);
+                gemm(ta,'N',n1,n,n2,-one,r.off.a,r.off.ld,B2,ldB,alpha,B,ldB);
+                solve(r.a11,n1,n,one,B);
+            }
+        }
+        else
+        {
+            T *B2=B+n1*ldB;
+            if(lower)
+            {
+                solve(r.a22,m,n2,alpha,B2);
+                gemm('N',ta,m,n1,n2,-one,B2,ldB,r.off.a,r.off.ld,alpha,B,ldB);
+                solve(r.a11,m,n1,one,B);
+            }
+            else
+            {
+                solve(r.a11,m,n1,alpha,B);
+                gemm('N',ta,m,n2,n1,-one,B,ldB,r.off.a,r.off.ld,alpha,B2,ldB);
+                solve(r.a22,m,n2,one,B2);
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,389 @@
+//
+//  thread.h
+//
+//  Purpose
+//  =======
+//
+//  Internal thread pool used to split large operations across cores.
+//  The pool is started on first use with TBLAS_NUM_THREADS threads, or
+//  one per hardware thread, counting the calling thread.  A call made
+//  from inside a pool task, or while another thread has the pool busy,
+//  runs serially on the calling thread, so kernels may be nested and
+//  called concurrently without oversubscribing the machine.
+//
+//  parallel_for splits the range [0,n) into at most one chunk per thread,
+//  each at least grain long, and calls f(begin,end) for each chunk.  Chunk
+//  boundaries fall on multiples of 16 so that threads writing neighbouring
+//  chunks of a vector do not share cache lines.  parallel_sum does the
+//  same and returns sum plus the values of f added in chunk order, so the
+//  result depends only on the number of threads.
+//
+//  With TBLAS_AFFINITY set the workers are bound to the NUMA nodes at
+//  start-up and the tasks of each call are handed out in fixed runs, one
+//  per thread, instead of first come first served (see affinity.h).
+//
+//  A call made from inside an active OpenMP parallel region runs serially,
+//  so a program that is parallel already is not oversubscribed by a pool
+//  per OpenMP thread.  The region is detected through omp_in_parallel,
+//  declared weak so that the library neither needs nor pulls in an OpenMP
+//  runtime.  A thread_limit caps the threads of the calls made by the
+//  thread that creates it, until it goes out of scope; a thread_limit of 1
+//  declares a parallel region of the caller's own, e.g. around the body of
+//  a std::thread or a task of another runtime.  The cap is the threads
+//  field of the context of the calling thread (see context.h).
+//
+//  Reductions, whose rounding depends on where the sum is split, take
+//  their number of parts from reduction_parts, which in deterministic mode
+//  depends on the length of the sum alone, and run the parts with
+//  parallel_parts on however many threads there are.
+//
+
+#ifndef __thread__
+#define __thread__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "affinity.h"
+#include "context.h"
+
+using std::size_t;
+
+namespace tblas
+{
+#ifdef __GNUC__
+    //  Weak reference to omp_in_parallel, null unless the program links an
+    //  OpenMP runtime; named apart so as not to clash with omp.h.
+
+    static int omp_active() __attribute__((weakref("omp_in_parallel")));
+#endif
+
+    //  True if the calling thread is in an active OpenMP parallel region.
+
+    inline bool omp_region()
+    {
+#ifdef __GNUC__
+        return omp_active&&omp_active();
+#else
+        return false;
+#endif
+    }
+
+    //  Caps at n the threads used by the calls made from the calling
+    //  thread while it exists; limits nest, the smallest one applying.
+
+    class thread_limit
+    {
+    public:
+        explicit thread_limit(size_t n) : saved(this_context().threads)
+        {
+            n=std::max(n,size_t(1));
+            this_context().threads=(saved>0)?std::min(saved,n):n;
+        }
+
+        ~thread_limit()
+        {
+            this_context().threads=saved;
+        }
+
+    private:
+        thread_limit(const thread_limit &);
+        thread_limit &operator=(const thread_limit &);
+
+        size_t saved;
+    };
+
+#ifdef __GNUC__
+#pragma GCC visibility push(default)
+#endif
+
+    //  The pool and the flag marking its threads are compiled into the
+    //  library, in thread.cpp, so that a program built with the templates
+    //  of include uses the one pool of the shared library.
+
+    class thread_pool
+    {
+    public:
+        static thread_pool &instance();
+
+        const topology &nodes() const
+        {
+            return top;
+        }
+
+        bool placed() const
+        {
+            return mode!=place_none;
+        }
+
+        size_t size() const
+        {
+            return workers.size()+1;
+        }
+
+        static bool &inside();
+
+        template <typename F>
+        void run(size_t ntasks, F &f)
+        {
+            std::unique_lock<std::mutex> busy(job,std::try_to_lock);
+            if((ntasks<2)||workers.empty()||inside()||!busy.owns_lock())
+            {
+                for(size_t t=0;t<ntasks;t++)
+                    f(t);
+                return;
+            }
+            if(counters *stats=this_context().stats)
+            {
+                stats->parallel++;
+                stats->tasks+=ntasks;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                idle.wait(lock,[this]{ return active==0; });
+                call=&invoke<F>;
+                data=&f;
+                caller=this_context();
+                count=ntasks;
+                next=0;
+                active=placed()?workers.size():0;
+                generation++;
+            }
+            wake.notify_all();
+            work(0);
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock,[this]{ return active==0; });
+        }
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop=true;
+            }
+            wake.notify_all();
+            for(size_t i=0;i<workers.size();i++)
+                workers[i].join();
+        }
+
+    private:
+        explicit thread_pool(size_t nthreads) : top(read_topology()), mode(read_placement()), call(0), data(0), count(0), next(0), generation(0), active(0), stop(false)
+        {
+            for(size_t i=1;i<nthreads;i++)
+                workers.push_back(std::thread(&thread_pool::loop,this,i,nthreads));
+        }
+
+        thread_pool(const thread_pool &);
+        thread_pool &operator=(const thread_pool &);
+
+        static size_t default_threads()
+        {
+            const char *env=std::getenv("TBLAS_NUM_THREADS");
+            if(env&&*env)
+            {
+                long n=std::atol(env);
+                return (n>0)?static_cast<size_t>(n):1;
+            }
+            size_t n=std::thread::hardware_concurrency();
+            return (n>0)?n:1;
+        }
+
+        template <typename F>
+        static void invoke(void *f, size_t t)
+        {
+            (*static_cast<F *>(f))(t);
+        }
+
+        //  Runs the tasks of the current call on thread self: whatever is
+        //  left, or with placed threads the run of tasks t with
+        //  t*size()/count equal to self.
+
+        void work(size_t self)
+        {
+            inside()=true;
+            size_t t;
+            if(placed())
+            {
+                const size_t p=size();
+                for(t=(self*count+p-1)/p;t<((self+1)*count+p-1)/p;t++)
+                    call(data,t);
+            }
+            else
+            {
+                while((t=next.fetch_add(1))<count)
+                    call(data,t);
+            }
+            inside()=false;
+        }
+
+        //  With placed threads every worker has its own run of tasks, so
+        //  run counts them all as active before waking them; otherwise a
+        //  worker counts itself in when it wakes and may find nothing left.
+        //  Workers run the tasks in a copy of the context of the calling
+        //  thread, which run copies under the lock, since a worker may wake
+        //  after run has returned.
+
+        void loop(size_t self, size_t nthreads)
+        {
+            bind_thread(top,mode,self,nthreads);
+            size_t seen=0;
+            std::unique_lock<std::mutex> lock(mutex);
+            for(;;)
+            {
+                wake.wait(lock,[&]{ return stop||(generation!=seen); });
+                if(stop)
+                    return;
+                seen=generation;
+                if(!placed())
+                    active++;
+                const context local=caller;
+                lock.unlock();
+                {
+                    context_scope scope(local);
+                    work(self);
+                }
+                lock.lock();
+                if(--active==0)
+                    idle.notify_all();
+            }
+        }
+
+        topology top;
+        placement mode;
+        std::vector<std::thread> workers;
+        std::mutex job;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        void (*call)(void *, size_t);
+        void *data;
+        context caller;
+        size_t count;
+        std::atomic<size_t> next;
+        size_t generation;
+        size_t active;
+        bool stop;
+    };
+
+#ifdef __GNUC__
+#pragma GCC visibility pop
+#endif
+
+    //  Threads available to a call from the calling thread; inside an
+    //  OpenMP region this does not start the pool.
+
+    inline size_t threads()
+    {
+        if(omp_region())
+            return 1;
+        const size_t n=thread_pool::instance().size();
+        const size_t cap=this_context().threads;
+        return (cap>0)?std::min(n,cap):n;
+    }
+
+    inline size_t partition(size_t n, size_t grain)
+    {
+        size_t parts=(grain>0)?n/grain:n;
+        return (parts>1)?std::min(parts,threads()):1;
+    }
+
+    //  Number of parts in deterministic mode of a reduction that is long
+    //  enough for any number of threads.
+
+    const size_t deterministic_parts=64;
+
+    //  Number of parts of a reduction of n terms, each of at least grain.
+
+    inline size_t reduction_parts(size_t n, size_t grain)
+    {
+        if(!this_context().deterministic)
+            return partition(n,grain);
+        const size_t parts=(grain>0)?n/grain:n;
+        return std::max(std::min(parts,deterministic_parts),size_t(1));
+    }
+
+    //  Largest value of reduction_parts.
+
+    inline size_t reduction_limit()
+    {
+        return this_context().deterministic?deterministic_parts:threads();
+    }
+
+    //  Calls f(p) for the parts p in [0,parts), each thread taking a
+    //  contiguous run of parts.
+
+    template <typename F>
+    void parallel_parts(size_t parts, F &f)
+    {
+        const size_t runs=std::min(parts,threads());
+        if(runs==1)
+        {
+            for(size_t p=0;p<parts;p++)
+                f(p);
+            return;
+        }
+        if(runs==parts)
+        {
+            thread_pool::instance().run(parts,f);
+            return;
+        }
+        auto task=[&](size_t t)
+        {
+            for(size_t p=t*parts/runs;p<(t+1)*parts/runs;p++)
+                f(p);
+        };
+        thread_pool::instance().run(runs,task);
+    }
+
+    inline void chunk(size_t n, size_t parts, size_t t, size_t &begin, size_t &end)
+    {
+        const size_t align=16;
+        begin=(t==0)?0:(n/parts*t)/align*align;
+        end=(t+1==parts)?n:(n/parts*(t+1))/align*align;
+    }
+
+    template <typename F>
+    void parallel_for(size_t n, size_t grain, F f)
+    {
+        const size_t parts=partition(n,grain);
+        if(parts==1)
+        {
+            f(size_t(0),n);
+            return;
+        }
+        auto task=[&](size_t t)
+        {
+            size_t begin,end;
+            chunk(n,parts,t,begin,end);
+            if(begin<end)
+                f(begin,end);
+        };
+        thread_pool::instance().run(parts,task);
+    }
+
+    template <typename T, typename F>
+    T parallel_sum(size_t n, size_t grain, T sum, F f)
+    {
+        const size_t parts=reduction_parts(n,grain);
+        if(parts==1)
+            return sum+f(size_t(0),n);
+        std::vector<T> partial(parts,T(0));
+        auto task=[&](size_t t)
+        {
+            size_t begin,end;
+            chunk(n,parts,t,begin,end);
+            if(begin<end)
+                partial[t]=f(begin,end);
+        };
+        parallel_parts(parts,task);
+        for(size_t t=0;t<parts;t++)
+            sum+=partial[t];
+        return sum;
+    }
+}
+#endif
@@ -0,0 +1,77 @@
+//
+//  touch.h
+//
+//  Purpose
+//  =======
+//
+//  Allocation of matrices and vectors laid out for the thread placement
+//  of affinity.h.  Linux puts each page of memory on the NUMA node of the
+//  thread that first writes it, so an array that is cleared by the
+//  calling thread alone ends up on one node, and every other node then
+//  reads it from afar.  touch_matrix clears the new array a range of
+//  columns per thread, through parallel_for with a grain of one column,
+//  so with TBLAS_AFFINITY set each range lands on the node of its thread.
+//  gemm and gemv split the columns of C and A with the same parallel_for
+//  and chunk, only with a grain of many columns, so once a matrix has at
+//  least a grain of columns per thread, which is when its placement
+//  matters, their ranges are exactly these.  Smaller calls run on fewer
+//  threads, each of whose ranges spans several of these, and a gemv
+//  reduction in deterministic mode takes its parts in runs per thread,
+//  whose edges may be off from these by up to a part.  touch_vector does
+//  the same for a vector split like the columns.  Arrays are aligned to
+//  pages and must be released with touch_free.
+//
+//  Arguments
+//  =========
+//
+//  ld      column length of the matrix
+//
+//  n       number of columns of the matrix, or length of the vector
+//
+
+#ifndef __touch__
+#define __touch__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "thread.h"
+
+using std::size_t;
+
+namespace tblas
+{
+    //  Alignment of the arrays, one page.
+
+    const size_t touch_align=4096;
+
+    template <typename T>
+    T *touch_matrix(size_t ld, size_t n)
+    {
+        const T zero(0.0);
+        void *p=0;
+        if(posix_memalign(&p,touch_align,std::max(ld*n,size_t(1))*sizeof(T))!=0)
+            throw std::bad_alloc();
+        T *A=static_cast<T *>(p);
+        parallel_for(n,size_t(1),[=](size_t begin, size_t end)
+        {
+            for(size_t i=begin*ld;i<end*ld;i++)
+                new(A+i) T(zero);
+        });
+        return A;
+    }
+
+    template <typename T>
+    T *touch_vector(size_t n)
+    {
+        return touch_matrix<T>(1,n);
+    }
+
+    template <typename T>
+    void touch_free(T *A)
+    {
+        std::free(A);
+    }
+}
+#endif
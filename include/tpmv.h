@@ -38,6 +38,10 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "packed.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -45,359 +49,66 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
-    template <typename T>
-    void tpmv(char uplo, char trans, char diag, size_t n, T *A, T *x, ptrdiff_t incx)
+    //  x <- op(A) * x for a unit-stride x, where op is applied to the
+    //  elements of A if trans is not 'N'.
+
+    template <typename T, typename C>
+    void tpmv_blocked(char uplo, char trans, char diag, size_t n, T *A, T *x, C op)
     {
         const bool nounit(diag=='N');
-        if(n>0)
+
+        std::vector<T> y(n,T(0));
+        if(trans=='N')
+            packed_mv<true,false>(uplo,n,A,x,x,y.data(),y.data(),op,profile<T>().l2);
+        else
+            packed_mv<false,true>(uplo,n,A,x,x,y.data(),y.data(),op,profile<T>().l2);
+        for(size_t j=0;j<n;j++)
         {
-            if(incx==1)
-            {
-                if(trans=='N')
-                {
-                    if(uplo=='U')
-                    {
-                        for(size_t j=0;j<n;j++)
-                        {
-                            for(size_t i=0;i<j;i++)
-                                x[i]+=x[j]*A[i];
-                            if(nounit)
-                                x[j]*=A[j];
-                            A+=j+1;
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        A+=n*(n+1)/2;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=n-j;
-                            for(ptrdiff_t i=n-1;i>j;i--)
-                                x[i]+=x[j]*A[i-j];
-                            if(nounit)
-                                x[j]*=A[0];
-                        }
-                    }
-                }
-                else if(trans=='T')
-                {
-                    if(uplo=='U')
-                    {
-                        A+=n*(n+1)/2;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=j+1;
-                            if(nounit)
-                                x[j]*=A[j];
-                            for(ptrdiff_t i=j-1;i>=0;i--)
-                                x[j]+=A[i]*x[i];
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        for(size_t j=0;j<n;j++)
-                        {
-                            if(nounit)
-                                x[j]*=A[0];
-                            for(size_t i=j+1;i<n;i++)
-                                x[j]+=A[i-j]*x[i];
-                            A+=n-j;
-                        }
-                    }
-                }
-            }
+            const T a=A[packed_index(uplo,n,j,j)];
+            if(nounit)
+                x[j]=y[j]+((trans=='N')?a:op(a))*x[j];
             else
-            {
-                size_t kx=(incx>0)?0:(1-n)*incx;
-                if(trans=='N')
-                {
-                    if(uplo=='U')
-                    {
-                        size_t jx=kx;
-                        for(size_t j=0;j<n;j++)
-                        {
-                            size_t ix=kx;
-                            for(size_t i=0;i<j;i++)
-                            {
-                                x[ix]+=x[jx]*A[i];
-                                ix+=incx;
-                            }
-                            if(nounit)
-                                x[jx]*=A[j];
-                            A+=j+1;
-                            jx+=incx;
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        A+=n*(n+1)/2;
-                        kx+=n*incx;
-                        size_t jx=kx;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=n-j;
-                            jx-=incx;
-                            size_t ix=kx;
-                            for(ptrdiff_t i=n-1;i>j;i--)
-                            {
-                                ix-=incx;
-                                x[ix]+=x[jx]*A[i-j];
-                            }
-                            if(nounit)
-                                x[jx]*=A[0];
-                        }
-                    }
-                }
-                else if(trans=='T')
-                {
-                    if(uplo=='U')
-                    {
-                        A+=n*(n+1)/2;
-                        size_t jx=kx+n*incx;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=j+1;
-                            jx-=incx;
-                            size_t ix=jx;
-                            if(nounit)
-                                x[jx]*=A[j];
-                            for(ptrdiff_t i=j-1;i>=0;i--)
-                            {
-                                ix-=incx;
-                                x[jx]+=A[i]*x[ix];
-                            }
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        size_t jx=kx;
-                        for(size_t j=0;j<n;j++)
-                        {
-                            size_t ix=jx;
-                            if(nounit)
-                                x[jx]*=A[0];
-                            for(size_t i=j+1;i<n;i++)
-                            {
-                                ix+=incx;
-                                x[jx]+=A[i-j]*x[ix];
-                            }
-                            A+=n-j;
-                            jx+=incx;
-                        }
-                    }
-                }
-            }
+                x[j]+=y[j];
+        }
+    }
+
+    template <typename T>
+    void tpmv(char uplo, char trans, char diag, size_t n, T *A, T *x, ptrdiff_t incx)
+    {
+        if(n==0)
+            return;
+
+        std::vector<T> u;
+        T *b=x;
+        if(incx!=1)
+        {
+            gather(n,x,incx,u);
+            b=u.data();
         }
+        tpmv_blocked(uplo,trans,diag,n,A,b,[](T a){ return a; });
+        if(incx!=1)
+            scatter(n,b,x,incx);
     }
-    
+
     template <typename T>
     void tpmv(char uplo, char trans, char diag, size_t n, complex<T> *A, complex<T> *x, ptrdiff_t incx)
     {
-        const bool nounit(diag=='N');
-        if(n>0)
+        if(n==0)
+            return;
+
+        std::vector<complex<T> > u;
+        complex<T> *b=x;
+        if(incx!=1)
         {
-            if(incx==1)
-            {
-                if(trans=='N')
-                {
-                    if(uplo=='U')
-                    {
-                        for(size_t j=0;j<n;j++)
-                        {
-                            for(size_t i=0;i<j;i++)
-                                x[i]+=x[j]*A[i];
-                            if(nounit)
-                                x[j]*=A[j];
-                            A+=j+1;
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        A+=n*(n+1)/2;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=n-j;
-                            for(ptrdiff_t i=n-1;i>j;i--)
-                                x[i]+=x[j]*A[i-j];
-                            if(nounit)
-                                x[j]*=A[0];
-                        }
-                    }
-                }
-                else if(trans=='T')
-                {
-                    if(uplo=='U')
-                    {
-                        A+=n*(n+1)/2;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=j+1;
-                            if(nounit)
-                                x[j]*=A[j];
-                            for(ptrdiff_t i=j-1;i>=0;i--)
-                                x[j]+=A[i]*x[i];
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        for(size_t j=0;j<n;j++)
-                        {
-                            if(nounit)
-                                x[j]*=A[0];
-                            for(size_t i=j+1;i<n;i++)
-                                x[j]+=A[i-j]*x[i];
-                            A+=n-j;
-                        }
-                    }
-                }
-                else if(trans=='C')
-                {
-                    if(uplo=='U')
-                    {
-                        A+=n*(n+1)/2;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=j+1;
-                            if(nounit)
-                                x[j]*=conj(A[j]);
-                            for(ptrdiff_t i=j-1;i>=0;i--)
-                                x[j]+=conj(A[i])*x[i];
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        for(size_t j=0;j<n;j++)
-                        {
-                            if(nounit)
-                                x[j]*=conj(A[0]);
-                            for(size_t i=j+1;i<n;i++)
-                                x[j]+=conj(A[i-j])*x[i];
-                            A+=n-j;
-                        }
-                    }
-                }
-                
-            }
-            else
-            {
-                size_t kx=(incx>0)?0:(1-n)*incx;
-                if(trans=='N')
-                {
-                    if(uplo=='U')
-                    {
-                        size_t jx=kx;
-                        for(size_t j=0;j<n;j++)
-                        {
-                            size_t ix=kx;
-                            for(size_t i=0;i<j;i++)
-                            {
-                                x[ix]+=x[jx]*A[i];
-                                ix+=incx;
-                            }
-                            if(nounit)
-                                x[jx]*=A[j];
-                            A+=j+1;
-                            jx+=incx;
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        A+=n*(n+1)/2;
-                        kx+=n*incx;
-                        size_t jx=kx;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=n-j;
-                            jx-=incx;
-                            size_t ix=kx;
-                            for(ptrdiff_t i=n-1;i>j;i--)
-                            {
-                                ix-=incx;
-                                x[ix]+=x[jx]*A[i-j];
-                            }
-                            if(nounit)
-                                x[jx]*=A[0];
-                        }
-                    }
-                }
-                else if(trans=='T')
-                {
-                    if(uplo=='U')
-                    {
-                        A+=n*(n+1)/2;
-                        size_t jx=kx+n*incx;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=j+1;
-                            jx-=incx;
-                            size_t ix=jx;
-                            if(nounit)
-                                x[jx]*=A[j];
-                            for(ptrdiff_t i=j-1;i>=0;i--)
-                            {
-                                ix-=incx;
-                                x[jx]+=A[i]*x[ix];
-                            }
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        size_t jx=kx;
-                        for(size_t j=0;j<n;j++)
-                        {
-                            size_t ix=jx;
-                            if(nounit)
-                                x[jx]*=A[0];
-                            for(size_t i=j+1;i<n;i++)
-                            {
-                                ix+=incx;
-                                x[jx]+=A[i-j]*x[ix];
-                            }
-                            A+=n-j;
-                            jx+=incx;
-                        }
-                    }
-                }
-                else if(trans=='C')
-                {
-                    if(uplo=='U')
-                    {
-                        A+=n*(n+1)/2;
-                        size_t jx=kx+n*incx;
-                        for(ptrdiff_t j=n-1;j>=0;j--)
-                        {
-                            A-=j+1;
-                            jx-=incx;
-                            size_t ix=jx;
-                            if(nounit)
-                                x[jx]*=conj(A[j]);
-                            for(ptrdiff_t i=j-1;i>=0;i--)
-                            {
-                                ix-=incx;
-                                x[jx]+=conj(A[i])*x[ix];
-                            }
-                        }
-                    }
-                    else if(uplo=='L')
-                    {
-                        size_t jx=kx;
-                        for(size_t j=0;j<n;j++)
-                        {
-                            size_t ix=jx;
-                            if(nounit)
-                                x[jx]*=conj(A[0]);
-                            for(size_t i=j+1;i<n;i++)
-                            {
-                                ix+=incx;
-                                x[jx]+=conj(A[i-j])*x[ix];
-                            }
-                            A+=n-j;
-                            jx+=incx;
-                        }
-                    }
-                }
-            }
+            gather(n,x,incx,u);
+            b=u.data();
         }
+        if(trans=='C')
+            tpmv_blocked(uplo,trans,diag,n,A,b,[](complex<T> a){ return conj(a); });
+        else
+            tpmv_blocked(uplo,trans,diag,n,A,b,[](complex<T> a){ return a; });
+        if(incx!=1)
+            scatter(n,b,x,incx);
     }
 }
 #endif
@@ -39,6 +39,10 @@
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "packed.h"
+#include "stride.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -46,355 +50,120 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
-    template <typename T>
-    void tpsv(char uplo, char trans, char diag, size_t n, T *A, T *x, ptrdiff_t incx)
+    //  Solves op(A) * x = b for a unit-stride x, where op is applied to the
+    //  elements of A if trans is not 'N'.  The triangle is taken in blocks
+    //  of nb columns, each diagonal block solved one column at a time.  For
+    //  trans='N' the solved block is then subtracted from the rest of x as
+    //  a packed matrix-vector product; otherwise each block first subtracts
+    //  the dot products of its columns with the part of x already solved.
+    //  Both products run over contiguous column segments and are split over
+    //  the thread pool by rows, the dot products summing per-thread partials
+    //  in order.
+
+    template <typename T, typename C>
+    void tpsv_blocked(char uplo, char trans, char diag, size_t n, T *A, T *x, C op)
     {
         const bool nounit(diag=='N');
-        
-        if(incx==1)
+        const size_t nb=64;
+        const size_t grain=std::max(size_t(1),profile<T>().l2/nb);
+        const bool forward=(trans=='N')?(uplo=='L'):(uplo=='U');
+        const size_t blocks=(n+nb-1)/nb;
+
+        std::vector<T> w(reduction_limit()*nb);
+        T *t=w.data();
+        for(size_t k=0;k<blocks;k++)
         {
+            const size_t j0=(forward?k:blocks-k-1)*nb;
+            const size_t j1=std::min(n,j0+nb);
             if(trans=='N')
             {
-                if(uplo=='U')
-                {
-                    A+=n*(n+1)/2;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=j+1;
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                            x[i]-=x[j]*A[i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                        for(size_t i=j+1;i<n;i++)
-                            x[i]-=x[j]*A[i-j];
-                        A+=n-j;
-                    }
-                }
+                for(size_t l=0;l<j1-j0;l++)
+                {
+                    const size_t c=(uplo=='L')?j0+l:j1-l-1;
+                    const T *a=A+packed_index(uplo,n,0,c);
+                    if(nounit)
+                        x[c]=x[c]/a[c];
+                    const size_t i0=(uplo=='U')?j0:c+1;
+                    const size_t i1=(uplo=='U')?c:j1;
+                    for(size_t i=i0;i<i1;i++)
+                        x[i]-=x[c]*a[i];
+                    t[c-j0]=-x[c];
+                }
+                const size_t r0=(uplo=='U')?0:j1;
+                const size_t r1=(uplo=='U')?j0:n;
+                parallel_for(r1-r0,grain,[=](size_t begin, size_t end)
+                {
+                    packed_panel<true,false>(uplo,n,r0+begin,r0+end,j0,j1,A,x,t,x,t,op);
+                });
             }
-            else if(trans=='T')
+            else
             {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        for(size_t i=0;i<j;i++)
-                            x[j]-=x[i]*A[i];
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        A+=j+1;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*(n+1)/2;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=n-j;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                            x[j]-=x[i]*A[i-j];
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                    }
+                const size_t r0=(uplo=='U')?0:j1;
+                const size_t r1=(uplo=='U')?j0:n;
+                const size_t parts=reduction_parts(r1-r0,grain);
+                std::fill(w.begin(),w.begin()+parts*nb,T(0));
+                auto task=[&](size_t p)
+                {
+                    size_t begin,end;
+                    chunk(r1-r0,parts,p,begin,end);
+                    if(begin<end)
+                        packed_panel<false,true>(uplo,n,r0+begin,r0+end,j0,j1,A,x,t,x,t+p*nb,op);
+                };
+                parallel_parts(parts,task);
+                for(size_t l=0;l<j1-j0;l++)
+                {
+                    const size_t c=(uplo=='U')?j0+l:j1-l-1;
+                    const T *a=A+packed_index(uplo,n,0,c);
+                    const size_t i0=(uplo=='U')?j0:c+1;
+                    const size_t i1=(uplo=='U')?c:j1;
+                    T temp=x[c];
+                    for(size_t p=0;p<parts;p++)
+                        temp-=t[p*nb+c-j0];
+                    for(size_t i=i0;i<i1;i++)
+                        temp-=op(a[i])*x[i];
+                    x[c]=nounit?temp/op(a[c]):temp;
                 }
             }
         }
-        else
+    }
+
+    template <typename T>
+    void tpsv(char uplo, char trans, char diag, size_t n, T *A, T *x, ptrdiff_t incx)
+    {
+        if(n==0)
+            return;
+
+        std::vector<T> u;
+        T *b=x;
+        if(incx!=1)
         {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*(n+1)/2;
-                    size_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=j+1;
-                        jx-=incx;
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                        {
-                            ix-=incx;
-                            x[ix]-=x[jx]*A[i];
-                        }
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                        size_t ix=jx;
-                        for(size_t i=j+1;i<n;i++)
-                        {
-                            ix+=incx;
-                            x[ix]-=x[jx]*A[i-j];
-                        }
-                        jx+=incx;
-                        A+=n-j;
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t ix=kx;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*A[i];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        jx+=incx;
-                        A+=j+1;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*(n+1)/2;
-                    kx+=n*incx;
-                    size_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        size_t ix=kx;
-                        A-=n-j;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                        {
-                            ix-=incx;
-                            x[jx]-=x[ix]*A[i-j];
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                    }
-                }
-            }
+            gather(n,x,incx,u);
+            b=u.data();
         }
+        tpsv_blocked(uplo,trans,diag,n,A,b,[](T a){ return a; });
+        if(incx!=1)
+            scatter(n,b,x,incx);
     }
-    
+
     template <typename T>
     void tpsv(char uplo, char trans, char diag, size_t n, complex<T> *A, complex<T> *x, ptrdiff_t incx)
     {
-        const bool nounit(diag=='N');
-        
-        if(incx==1)
+        if(n==0)
+            return;
+
+        std::vector<complex<T> > u;
+        complex<T> *b=x;
+        if(incx!=1)
         {
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*(n+1)/2;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=j+1;
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                            x[i]-=x[j]*A[i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                        for(size_t i=j+1;i<n;i++)
-                            x[i]-=x[j]*A[i-j];
-                        A+=n-j;
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        for(size_t i=0;i<j;i++)
-                            x[j]-=x[i]*A[i];
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        A+=j+1;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*(n+1)/2;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=n-j;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                            x[j]-=x[i]*A[i-j];
-                        if(nounit)
-                            x[j]=x[j]/A[0];
-                    }
-                }
-            }
-            else if(trans=='C')
-            {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        for(size_t i=0;i<j;i++)
-                            x[j]-=x[i]*conj(A[i]);
-                        if(nounit)
-                            x[j]=x[j]/conj(A[j]);
-                        A+=j+1;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*(n+1)/2;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=n-j;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                            x[j]-=x[i]*conj(A[i-j]);
-                        if(nounit)
-                            x[j]=x[j]/conj(A[0]);
-                    }
-                }
-            }
+            gather(n,x,incx,u);
+            b=u.data();
         }
+        if(trans=='C')
+            tpsv_blocked(uplo,trans,diag,n,A,b,[](complex<T> a){ return conj(a); });
         else
-        {
-            size_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*(n+1)/2;
-                    size_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=j+1;
-                        jx-=incx;
-                        size_t ix=jx;
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                        {
-                            ix-=incx;
-                            x[ix]-=x[jx]*A[i];
-                        }
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                        size_t ix=jx;
-                        for(size_t i=j+1;i<n;i++)
-                        {
-                            ix+=incx;
-                            x[ix]-=x[jx]*A[i-j];
-                        }
-                        jx+=incx;
-                        A+=n-j;
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t ix=kx;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*A[i];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        jx+=incx;
-                        A+=j+1;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*(n+1)/2;
-                    kx+=n*incx;
-                    size_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        size_t ix=kx;
-                        A-=n-j;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                        {
-                            ix-=incx;
-                            x[jx]-=x[ix]*A[i-j];
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[0];
-                    }
-                }
-            }
-            else if(trans=='C')
-            {
-                if(uplo=='U')
-                {
-                    size_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        size_t ix=kx;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*conj(A[i]);
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/conj(A[j]);
-                        jx+=incx;
-                        A+=j+1;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*(n+1)/2;
-                    kx+=n*incx;
-                    size_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        size_t ix=kx;
-                        A-=n-j;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                        {
-                            ix-=incx;
-                            x[jx]-=x[ix]*conj(A[i-j]);
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/conj(A[0]);
-                    }
-                }
-            }
-        }
+            tpsv_blocked(uplo,trans,diag,n,A,b,[](complex<T> a){ return a; });
+        if(incx!=1)
+            scatter(n,b,x,incx);
     }
 }
 #endif
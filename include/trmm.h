@@ -46,12 +46,19 @@
 //
 //  ldB     column length of the matrix B, must be at least m
 //
+//  If A or B spans more than one tile of dag.h, the product is split into
+//  tile tasks and run on a task graph; trmm(g,...) queues those tasks on
+//  the task graph g instead.
+//
 
 #ifndef __trmm__
 #define __trmm__
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
+#include "dag.h"
+#include "gemm.h"
 
 using std::complex;
 using std::size_t;
@@ -59,6 +66,11 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
+    //  Queues the product on a task graph (see below).
+
+    template <typename T>
+    void trmm(task_graph &g, char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, size_t ldA, T *B, size_t ldB);
+
     template <typename T>
     void trmm(char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, size_t ldA, T *B, size_t ldB)
     {
@@ -67,6 +79,14 @@ namespace tblas
 
         if((m==0)||(n==0))
             return;
+
+        if(std::max(m,n)>tile_order<T>())
+        {
+            task_graph g;
+            trmm(g,side,uplo,trans,diag,m,n,alpha,A,ldA,B,ldB);
+            g.wait();
+            return;
+        }
         
         if(alpha==zero)
         {
@@ -266,6 +286,14 @@ namespace tblas
 
         if((m==0)||(n==0))
             return;
+
+        if(std::max(m,n)>tile_order<complex<T> >())
+        {
+            task_graph g;
+            trmm(g,side,uplo,trans,diag,m,n,alpha,A,ldA,B,ldB);
+            g.wait();
+            return;
+        }
         
         if(alpha==zero)
         {
@@ -543,5 +571,76 @@ namespace tblas
         }
     }
     
+
+    //  Queues the product on g as tile tasks.  Each tile row (side='L') or
+    //  column (side='R') of B is multiplied by the diagonal tile of A and
+    //  then has the products with the tiles of op(A) beyond it added, in an
+    //  order that uses every tile of B before it is overwritten.
+
+    template <typename T>
+    void trmm(task_graph &g, char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, size_t ldA, T *B, size_t ldB)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((m==0)||(n==0))
+            return;
+
+        const size_t nb=tile_order<T>();
+        if(alpha==zero)
+        {
+            for(size_t j0=0;j0<n;j0+=nb)
+                for(size_t i0=0;i0<m;i0+=nb)
+                {
+                    const size_t ib=std::min(nb,m-i0);
+                    const size_t jb=std::min(nb,n-j0);
+                    T *b=B+i0+j0*ldB;
+                    g.submit([=]{ gemm_scale(ib,jb,zero,b,ldB); },{tile_write(b,ib,jb,ldB)});
+                }
+            return;
+        }
+
+        const bool left=(side=='L');
+        const bool upper=((uplo=='U')==(trans=='N'));
+        const bool forward=(left==upper);
+        const size_t order=left?m:n;
+        const size_t other=left?n:m;
+        const size_t nt=(order+nb-1)/nb;
+        for(size_t s=0;s<nt;s++)
+        {
+            const size_t i0=(forward?s:nt-1-s)*nb;
+            const size_t ib=std::min(nb,order-i0);
+            T *aii=A+i0+i0*ldA;
+            for(size_t o0=0;o0<other;o0+=nb)
+            {
+                const size_t ob=std::min(nb,other-o0);
+                T *b=left?B+i0+o0*ldB:B+o0+i0*ldB;
+                g.submit([=]{ trmm(side,uplo,trans,diag,left?ib:ob,left?ob:ib,alpha,aii,ldA,b,ldB); },{tile_read(aii,ib,ib,ldA),tile_write(b,left?ib:ob,left?ob:ib,ldB)});
+            }
+            for(size_t r=s+1;r<nt;r++)
+            {
+                const size_t k0=(forward?r:nt-1-r)*nb;
+                const size_t kb=std::min(nb,order-k0);
+                for(size_t o0=0;o0<other;o0+=nb)
+                {
+                    const size_t ob=std::min(nb,other-o0);
+                    if(left)
+                    {
+                        T *a=(trans=='N')?A+i0+k0*ldA:A+k0+i0*ldA;
+                        T *bk=B+k0+o0*ldB;
+                        T *bi=B+i0+o0*ldB;
+                        g.submit([=]{ gemm_blocked(trans,'N',ib,ob,kb,alpha,a,ldA,bk,ldB,one,bi,ldB,profile<T>()); },{tile_read(trans,a,ib,kb,ldA),tile_read(bk,kb,ob,ldB),tile_write(bi,ib,ob,ldB)});
+                    }
+                    else
+                    {
+                        T *a=(trans=='N')?A+k0+i0*ldA:A+i0+k0*ldA;
+                        T *bk=B+o0+k0*ldB;
+                        T *bi=B+o0+i0*ldB;
+                        g.submit([=]{ gemm_blocked('N',trans,ob,ib,kb,alpha,bk,ldB,a,ldA,one,bi,ldB,profile<T>()); },{tile_read(trans,a,kb,ib,ldA),tile_read(bk,ob,kb,ldB),tile_write(bi,ob,ib,ldB)});
+                    }
+                }
+            }
+        }
+    }
 }
 #endif
@@ -35,12 +35,19 @@
 //
 //  incx    stride of vector x; if negative, x is stored in reverse order
 //
+//  trmv_multi applies the same operation to nv vectors x[0] to x[nv-1]
+//  with increments incx[0] to incx[nv-1], sweeping over A once: each
+//  column of A is applied to every vector while it is in cache, so A is
+//  read from memory once instead of nv times.
+//
 
 #ifndef __trmv__
 #define __trmv__
 
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "stride.h"
 
 using std::complex;
 using std::size_t;
@@ -48,6 +55,42 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
+    //  x[v] <- op(A) * x[v] for the nv unit-stride vectors x[v], one column
+    //  of A at a time.
+
+    template <typename T, typename C>
+    void trmv_sweep(char uplo, char trans, char diag, size_t n, const T *A, size_t ldA, size_t nv, T *const *x, C op)
+    {
+        const bool nounit(diag=='N');
+        const bool forward=(trans=='N')?(uplo=='U'):(uplo=='L');
+        for(size_t t=0;t<n;t++)
+        {
+            const size_t j=forward?t:n-1-t;
+            const T *a=A+j*ldA;
+            const size_t i0=(uplo=='U')?0:j+1;
+            const size_t i1=(uplo=='U')?j:n;
+            for(size_t v=0;v<nv;v++)
+            {
+                T *y=x[v];
+                if(trans=='N')
+                {
+                    const T yj=y[j];
+                    for(size_t i=i0;i<i1;i++)
+                        y[i]+=yj*a[i];
+                    if(nounit)
+                        y[j]=yj*a[j];
+                }
+                else
+                {
+                    T temp=nounit?op(a[j])*y[j]:y[j];
+                    for(size_t i=i0;i<i1;i++)
+                        temp+=op(a[i])*y[i];
+                    y[j]=temp;
+                }
+            }
+        }
+    }
+
     template <typename T>
     void trmv(char uplo, char trans, char diag, size_t n, T *A, size_t ldA, T *x, ptrdiff_t incx)
     {
@@ -395,5 +438,34 @@ namespace tblas
             }
         }
     }
+
+    template <typename T>
+    void trmv_multi(char uplo, char trans, char diag, size_t n, T *A, size_t ldA, size_t nv, T **x, const ptrdiff_t *incx)
+    {
+        if((n==0)||(nv==0))
+            return;
+
+        std::vector<T> w;
+        std::vector<T *> p;
+        gather_vectors(n,nv,x,incx,w,p);
+        trmv_sweep(uplo,trans,diag,n,A,ldA,nv,p.data(),[](T a){ return a; });
+        scatter_vectors(n,nv,p.data(),x,incx);
+    }
+
+    template <typename T>
+    void trmv_multi(char uplo, char trans, char diag, size_t n, complex<T> *A, size_t ldA, size_t nv, complex<T> **x, const ptrdiff_t *incx)
+    {
+        if((n==0)||(nv==0))
+            return;
+
+        std::vector<complex<T> > w;
+        std::vector<complex<T> *> p;
+        gather_vectors(n,nv,x,incx,w,p);
+        if(trans=='C')
+            trmv_sweep(uplo,trans,diag,n,A,ldA,nv,p.data(),[](complex<T> a){ return conj(a); });
+        else
+            trmv_sweep(uplo,trans,diag,n,A,ldA,nv,p.data(),[](complex<T> a){ return a; });
+        scatter_vectors(n,nv,p.data(),x,incx);
+    }
 }
 #endif
@@ -48,12 +48,19 @@
 //
 //  ldB     column length of the matrix B, must be at least m
 //
+//  If A or B spans more than one tile of dag.h, the solve is split into
+//  tile tasks and run on a task graph; trsm(g,...) queues those tasks on
+//  the task graph g instead.
+//
 
 #ifndef __trsm__
 #define __trsm__
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
+#include "dag.h"
+#include "gemm.h"
 
 using std::complex;
 using std::size_t;
@@ -61,6 +68,11 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
+    //  Queues the solve on a task graph (see below).
+
+    template <typename T>
+    void trsm(task_graph &g, char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, size_t ldA, T *B, size_t ldB);
+
     template <typename T>
     void trsm(char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, size_t ldA, T *B, size_t ldB)
     {
@@ -69,6 +81,14 @@ namespace tblas
         const bool nounit=(diag=='N');
         if((m==0)||(n==0))
             return;
+
+        if(std::max(m,n)>tile_order<T>())
+        {
+            task_graph g;
+            trsm(g,side,uplo,trans,diag,m,n,alpha,A,ldA,B,ldB);
+            g.wait();
+            return;
+        }
         
         if(alpha==zero)
         {
@@ -289,6 +309,14 @@ namespace tblas
         const bool nounit=(diag=='N');
         if((m==0)||(n==0))
             return;
+
+        if(std::max(m,n)>tile_order<complex<T> >())
+        {
+            task_graph g;
+            trsm(g,side,uplo,trans,diag,m,n,alpha,A,ldA,B,ldB);
+            g.wait();
+            return;
+        }
         
         if(alpha==zero)
         {
@@ -596,5 +624,78 @@ namespace tblas
             }
         }
     }
+
+    //  Queues the solve on g as tile tasks.  Step s solves the s-th tile
+    //  row (side='L') or column (side='R') of B, taken in the order the
+    //  substitution runs, against the diagonal tile of A, and subtracts
+    //  its product with the tiles of op(A) beyond it from the tile rows or
+    //  columns not yet solved.  alpha is applied at step 0.
+
+    template <typename T>
+    void trsm(task_graph &g, char side, char uplo, char trans, char diag, size_t m, size_t n, T alpha, T *A, size_t ldA, T *B, size_t ldB)
+    {
+        const T zero(0.0);
+        const T one(1.0);
+
+        if((m==0)||(n==0))
+            return;
+
+        const size_t nb=tile_order<T>();
+        if(alpha==zero)
+        {
+            for(size_t j0=0;j0<n;j0+=nb)
+                for(size_t i0=0;i0<m;i0+=nb)
+                {
+                    const size_t ib=std::min(nb,m-i0);
+                    const size_t jb=std::min(nb,n-j0);
+                    T *b=B+i0+j0*ldB;
+                    g.submit([=]{ gemm_scale(ib,jb,zero,b,ldB); },{tile_write(b,ib,jb,ldB)});
+                }
+            return;
+        }
+
+        const bool left=(side=='L');
+        const bool lower=((uplo=='L')==(trans=='N'));
+        const bool forward=(left==lower);
+        const size_t order=left?m:n;
+        const size_t other=left?n:m;
+        const size_t nt=(order+nb-1)/nb;
+        for(size_t s=0;s<nt;s++)
+        {
+            const size_t k0=(forward?s:nt-1-s)*nb;
+            const size_t kb=std::min(nb,order-k0);
+            T *akk=A+k0+k0*ldA;
+            const T as=(s==0)?alpha:one;
+            for(size_t o0=0;o0<other;o0+=nb)
+            {
+                const size_t ob=std::min(nb,other-o0);
+                T *b=left?B+k0+o0*ldB:B+o0+k0*ldB;
+                g.submit([=]{ trsm(side,uplo,trans,diag,left?kb:ob,left?ob:kb,as,akk,ldA,b,ldB); },{tile_read(akk,kb,kb,ldA),tile_write(b,left?kb:ob,left?ob:kb,ldB)});
+            }
+            for(size_t r=s+1;r<nt;r++)
+            {
+                const size_t i0=(forward?r:nt-1-r)*nb;
+                const size_t ib=std::min(nb,order-i0);
+                for(size_t o0=0;o0<other;o0+=nb)
+                {
+                    const size_t ob=std::min(nb,other-o0);
+                    if(left)
+                    {
+                        T *a=(trans=='N')?A+i0+k0*ldA:A+k0+i0*ldA;
+                        T *bk=B+k0+o0*ldB;
+                        T *bi=B+i0+o0*ldB;
+                        g.submit([=]{ gemm_blocked(trans,'N',ib,ob,kb,-one,a,ldA,bk,ldB,as,bi,ldB,profile<T>()); },{tile_read(trans,a,ib,kb,ldA),tile_read(bk,kb,ob,ldB),tile_write(bi,ib,ob,ldB)});
+                    }
+                    else
+                    {
+                        T *a=(trans=='N')?A+k0+i0*ldA:A+i0+k0*ldA;
+                        T *bk=B+o0+k0*ldB;
+                        T *bi=B+o0+i0*ldB;
+                        g.submit([=]{ gemm_blocked('N',trans,ob,ib,kb,-one,bk,ldB,a,ldA,as,bi,ldB,profile<T>()); },{tile_read(trans,a,kb,ib,ldA),tile_read(bk,ob,kb,ldB),tile_write(bi,ob,ib,ldB)});
+                    }
+                }
+            }
+        }
+    }
 }
 #endif
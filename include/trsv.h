@@ -16,6 +16,11 @@
 //  If diag='U', the matrix is assumed to be unit triangular,
 //  or diag='N' for nonunit triangular.
 //
+//  The triangle is taken in blocks of trsv_block columns.  Each diagonal
+//  block is solved on its own, a short dependency chain over data that
+//  stays in L1, and the rectangular panels between the blocks are applied
+//  with gemv, which is where nearly all of the work is done.
+//
 //  Arguments
 //  ==========
 //
@@ -35,12 +40,23 @@
 //
 //  incx    stride of vector x; if negative, x is stored in reverse order
 //
+//  trsv_multi solves the same system for nv vectors x[0] to x[nv-1] with
+//  increments incx[0] to incx[nv-1], sweeping over A once: each column of
+//  A is applied to every vector while it is in cache, so A is read from
+//  memory once instead of nv times.
+//
 
 #ifndef __trsv__
 #define __trsv__
 
+#include <algorithm>
 #include <complex>
 #include <cstddef>
+#include <vector>
+#include "gemv.h"
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
 
 using std::complex;
 using std::size_t;
@@ -48,353 +64,192 @@ using std::ptrdiff_t;
 
 namespace tblas
 {
-    template <typename T>
-    void trsv(char uplo, char trans, char diag, size_t n, T *A, size_t ldA, T *x, ptrdiff_t incx)
+    //  Number of columns in each diagonal block of trsv.
+
+    const size_t trsv_block=64;
+
+    //  Solves op(A) * x = b for a unit-stride x, where op is applied to the
+    //  elements of A if trans is not 'N'.  For trans='N' each solved block
+    //  is subtracted from the rest of x with gemv, split over the thread
+    //  pool by rows.  Otherwise each block first subtracts the transposed
+    //  product of its columns with the part of x already solved, each
+    //  thread taking a range of rows into its own partial sums, which are
+    //  then subtracted in order.
+
+    template <typename T, typename C>
+    void trsv_blocked(char uplo, char trans, char diag, size_t n, T *A, size_t ldA, T *x, C op)
     {
+        const T zero(0.0);
+        const T one(1.0);
         const bool nounit(diag=='N');
-        if(incx==1)
+        const size_t nb=trsv_block;
+        const size_t grain=std::max(size_t(1),profile<T>().l2/nb);
+        const bool forward=(trans=='N')?(uplo=='L'):(uplo=='U');
+        const size_t blocks=(n+nb-1)/nb;
+
+        std::vector<T> w(reduction_limit()*nb);
+        T *t=w.data();
+        for(size_t k=0;k<blocks;k++)
         {
+            const size_t j0=(forward?k:blocks-k-1)*nb;
+            const size_t j1=std::min(n,j0+nb);
+            const size_t r0=(uplo=='U')?0:j1;
+            const size_t r1=(uplo=='U')?j0:n;
             if(trans=='N')
             {
-                if(uplo=='U')
+                for(size_t l=0;l<j1-j0;l++)
                 {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                            x[i]-=x[j]*A[i];
-                    }
+                    const size_t c=(uplo=='L')?j0+l:j1-l-1;
+                    const T *a=A+c*ldA;
+                    if(nounit)
+                        x[c]=x[c]/a[c];
+                    const size_t i0=(uplo=='U')?j0:c+1;
+                    const size_t i1=(uplo=='U')?c:j1;
+                    for(size_t i=i0;i<i1;i++)
+                        x[i]-=x[c]*a[i];
                 }
-                else if(uplo=='L')
+                parallel_for(r1-r0,grain,[=](size_t begin, size_t end)
                 {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        for(size_t i=j+1;i<n;i++)
-                            x[i]-=x[j]*A[i];
-                        A+=ldA;
-                    }
-                }
+                    gemv('N',end-begin,j1-j0,-one,A+r0+begin+j0*ldA,ldA,x+j0,1,one,x+r0+begin,1);
+                });
             }
-            else if(trans=='T')
+            else
             {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        for(size_t i=0;i<j;i++)
-                            x[j]-=x[i]*A[i];
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                            x[j]-=x[i]*A[i];
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                    }
+                const size_t parts=reduction_parts(r1-r0,grain);
+                auto task=[&](size_t p)
+                {
+                    size_t begin,end;
+                    chunk(r1-r0,parts,p,begin,end);
+                    T *s=t+p*nb;
+                    if(begin<end)
+                        gemv(trans,end-begin,j1-j0,one,A+r0+begin+j0*ldA,ldA,x+r0+begin,1,zero,s,1);
+                    else
+                        std::fill(s,s+j1-j0,zero);
+                };
+                if(r0<r1)
+                    parallel_parts(parts,task);
+                for(size_t l=0;l<j1-j0;l++)
+                {
+                    const size_t c=(uplo=='U')?j0+l:j1-l-1;
+                    const T *a=A+c*ldA;
+                    const size_t i0=(uplo=='U')?j0:c+1;
+                    const size_t i1=(uplo=='U')?c:j1;
+                    T temp=x[c];
+                    if(r0<r1)
+                    {
+                        for(size_t p=0;p<parts;p++)
+                            temp-=t[p*nb+c-j0];
+                    }
+                    for(size_t i=i0;i<i1;i++)
+                        temp-=op(a[i])*x[i];
+                    x[c]=nounit?temp/op(a[c]):temp;
                 }
             }
         }
-        else
+    }
+
+    //  Solves op(A) * x[v] = b[v] for the nv unit-stride vectors x[v], one
+    //  column of A at a time.
+
+    template <typename T, typename C>
+    void trsv_sweep(char uplo, char trans, char diag, size_t n, const T *A, size_t ldA, size_t nv, T *const *x, C op)
+    {
+        const bool nounit(diag=='N');
+        const bool forward=(trans=='N')?(uplo=='L'):(uplo=='U');
+        for(size_t t=0;t<n;t++)
         {
-            ptrdiff_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
+            const size_t j=forward?t:n-1-t;
+            const T *a=A+j*ldA;
+            const size_t i0=(uplo=='U')?0:j+1;
+            const size_t i1=(uplo=='U')?j:n;
+            for(size_t v=0;v<nv;v++)
             {
-                if(uplo=='U')
+                T *y=x[v];
+                if(trans=='N')
                 {
-                    A+=n*ldA;
-                    ptrdiff_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        ptrdiff_t ix=jx;
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                        {
-                            ix-=incx;
-                            x[ix]-=x[jx]*A[i];
-                        }
-                    }
+                    if(nounit)
+                        y[j]=y[j]/a[j];
+                    const T yj=y[j];
+                    for(size_t i=i0;i<i1;i++)
+                        y[i]-=yj*a[i];
                 }
-                else if(uplo=='L')
+                else
                 {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        ptrdiff_t ix=jx;
-                        for(size_t i=j+1;i<n;i++)
-                        {
-                            ix+=incx;
-                            x[ix]-=x[jx]*A[i];
-                        }
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        ptrdiff_t ix=kx;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*A[i];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    ptrdiff_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        ptrdiff_t ix=kx;
-                        A-=ldA;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                        {
-                            ix-=incx;
-                            x[jx]-=x[ix]*A[i];
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                    }
+                    T temp=y[j];
+                    for(size_t i=i0;i<i1;i++)
+                        temp-=op(a[i])*y[i];
+                    y[j]=nounit?temp/op(a[j]):temp;
                 }
             }
         }
     }
 
     template <typename T>
-    void trsv(char uplo, char trans, char diag, size_t n, complex<T> *A, size_t ldA, complex<T> *x, ptrdiff_t incx)
+    void trsv(char uplo, char trans, char diag, size_t n, T *A, size_t ldA, T *x, ptrdiff_t incx)
     {
-        const bool nounit(diag=='N');
-        if(incx==1)
+        if(n==0)
+            return;
+
+        std::vector<T> u;
+        T *b=x;
+        if(incx!=1)
         {
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                            x[i]-=x[j]*A[i];
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        for(size_t i=j+1;i<n;i++)
-                            x[i]-=x[j]*A[i];
-                        A+=ldA;
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        for(size_t i=0;i<j;i++)
-                            x[j]-=x[i]*A[i];
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                            x[j]-=x[i]*A[i];
-                        if(nounit)
-                            x[j]=x[j]/A[j];
-                    }
-                }
-            }
-            else if(trans=='C')
-            {
-                if(uplo=='U')
-                {
-                    for(size_t j=0;j<n;j++)
-                    {
-                        for(size_t i=0;i<j;i++)
-                            x[j]-=x[i]*conj(A[i]);
-                        if(nounit)
-                            x[j]=x[j]/conj(A[j]);
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                            x[j]-=x[i]*conj(A[i]);
-                        if(nounit)
-                            x[j]=x[j]/conj(A[j]);
-                    }
-                }
-            }
+            gather(n,x,incx,u);
+            b=u.data();
         }
-        else
+        trsv_blocked(uplo,trans,diag,n,A,ldA,b,[](T a){ return a; });
+        if(incx!=1)
+            scatter(n,b,x,incx);
+    }
+
+    template <typename T>
+    void trsv(char uplo, char trans, char diag, size_t n, complex<T> *A, size_t ldA, complex<T> *x, ptrdiff_t incx)
+    {
+        if(n==0)
+            return;
+
+        std::vector<complex<T> > u;
+        complex<T> *b=x;
+        if(incx!=1)
         {
-            ptrdiff_t kx=(incx>0)?0:(1-n)*incx;
-            if(trans=='N')
-            {
-                if(uplo=='U')
-                {
-                    A+=n*ldA;
-                    ptrdiff_t jx=kx+n*incx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        A-=ldA;
-                        jx-=incx;
-                        ptrdiff_t ix=jx;
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        for(ptrdiff_t i=j-1;i>=0;i--)
-                        {
-                            ix-=incx;
-                            x[ix]-=x[jx]*A[i];
-                        }
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        ptrdiff_t ix=jx;
-                        for(size_t i=j+1;i<n;i++)
-                        {
-                            ix+=incx;
-                            x[ix]-=x[jx]*A[i];
-                        }
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-            }
-            else if(trans=='T')
-            {
-                if(uplo=='U')
-                {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        ptrdiff_t ix=kx;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*A[i];
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    ptrdiff_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        ptrdiff_t ix=kx;
-                        A-=ldA;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                        {
-                            ix-=incx;
-                            x[jx]-=x[ix]*A[i];
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/A[j];
-                    }
-                }
-            }
-            else if(trans=='C')
-            {
-                if(uplo=='U')
-                {
-                    ptrdiff_t jx=kx;
-                    for(size_t j=0;j<n;j++)
-                    {
-                        ptrdiff_t ix=kx;
-                        for(size_t i=0;i<j;i++)
-                        {
-                            x[jx]-=x[ix]*conj(A[i]);
-                            ix+=incx;
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/conj(A[j]);
-                        jx+=incx;
-                        A+=ldA;
-                    }
-                }
-                else if(uplo=='L')
-                {
-                    A+=n*ldA;
-                    kx+=n*incx;
-                    ptrdiff_t jx=kx;
-                    for(ptrdiff_t j=n-1;j>=0;j--)
-                    {
-                        jx-=incx;
-                        ptrdiff_t ix=kx;
-                        A-=ldA;
-                        for(ptrdiff_t i=n-1;i>j;i--)
-                        {
-                            ix-=incx;
-                            x[jx]-=x[ix]*conj(A[i]);
-                        }
-                        if(nounit)
-                            x[jx]=x[jx]/conj(A[j]);
-                    }
-                }
-            }
+            gather(n,x,incx,u);
+            b=u.data();
         }
+        if(trans=='C')
+            trsv_blocked(uplo,trans,diag,n,A,ldA,b,[](complex<T> a){ return conj(a); });
+        else
+            trsv_blocked(uplo,trans,diag,n,A,ldA,b,[](complex<T> a){ return a; });
+        if(incx!=1)
+            scatter(n,b,x,incx);
+    }
+
+    template <typename T>
+    void trsv_multi(char uplo, char trans, char diag, size_t n, T *A, size_t ldA, size_t nv, T **x, const ptrdiff_t *incx)
+    {
+        if((n==0)||(nv==0))
+            return;
+
+        std::vector<T> w;
+        std::vector<T *> p;
+        gather_vectors(n,nv,x,incx,w,p);
+        trsv_sweep(uplo,trans,diag,n,A,ldA,nv,p.data(),[](T a){ return a; });
+        scatter_vectors(n,nv,p.data(),x,incx);
+    }
+
+    template <typename T>
+    void trsv_multi(char uplo, char trans, char diag, size_t n, complex<T> *A, size_t ldA, size_t nv, complex<T> **x, const ptrdiff_t *incx)
+    {
+        if((n==0)||(nv==0))
+            return;
+
+        std::vector<complex<T> > w;
+        std::vector<complex<T> *> p;
+        gather_vectors(n,nv,x,incx,w,p);
+        if(trans=='C')
+            trsv_sweep(uplo,trans,diag,n,A,ldA,nv,p.data(),[](complex<T> a){ return conj(a); });
+        else
+            trsv_sweep(uplo,trans,diag,n,A,ldA,nv,p.data(),[](complex<T> a){ return a; });
+        scatter_vectors(n,nv,p.data(),x,incx);
     }
 }
 #endif
@@ -0,0 +1,176 @@
+//
+//  tune.h
+//
+//  Purpose
+//  =======
+//
+//  Blocking and threading parameters for the library kernels.  The values
+//  for each precision are read once, on first use, from the machine profile
+//  written by tblas-tune; any value missing from the profile, or the whole
+//  profile if it cannot be read, falls back to the compiled-in defaults.
+//
+//  The profile is located by the environment variable TBLAS_PROFILE, or
+//  else $HOME/.tblas_profile, and consists of lines of the form
+//
+//      <p>.<key> <value>
+//
+//  where <p> is one of s, d, c or z and <key> is one of the parameters below.
+//  Lines starting with '#' are ignored.
+//
+//  Parameters
+//  ==========
+//
+//  mc      number of rows of the packed block of op(A)
+//
+//  kc      inner dimension of the packed blocks of op(A) and op(B)
+//
+//  nc      number of columns of the packed block of op(B)
+//
+//  mr      number of rows of the micro-kernel, one of 4, 8 or 16
+//
+//  nr      number of columns of the micro-kernel, either 4 or 6
+//
+//  l1      minimum number of elements per thread in a Level-1 operation
+//
+//  l2      minimum number of matrix entries per thread in a Level-2 update
+//
+//  stream  number of elements above which copy, scal, swap and the beta
+//          scaling passes take the streaming sweeps of stream.h, or 0 to
+//          never do so
+//
+
+#ifndef __tune__
+#define __tune__
+
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using std::complex;
+using std::size_t;
+
+namespace tblas
+{
+    struct tuning
+    {
+        size_t mc;
+        size_t kc;
+        size_t nc;
+        size_t mr;
+        size_t nr;
+        size_t l1;
+        size_t l2;
+        size_t stream;
+    };
+
+    template <typename T>
+    struct precision
+    {
+        static const char letter=0;
+    };
+
+    template <> struct precision<float> { static const char letter='s'; };
+    template <> struct precision<double> { static const char letter='d'; };
+    template <> struct precision<complex<float> > { static const char letter='c'; };
+    template <> struct precision<complex<double> > { static const char letter='z'; };
+
+    template <typename T>
+    tuning default_tuning()
+    {
+        const size_t bytes=sizeof(T);
+        tuning b;
+        b.mr=(bytes<=4)?16:(bytes<=8)?8:4;
+        b.nr=4;
+        b.kc=(bytes<=8)?256:128;
+        b.mc=(bytes<=4)?192:(bytes<=8)?96:64;
+        b.nc=4096;
+        b.l1=65536;
+        b.l2=65536;
+        b.stream=(size_t(8)<<20)/bytes;
+        return b;
+    }
+
+    inline bool valid_micro_kernel(size_t mr, size_t nr)
+    {
+        return ((mr==4)||(mr==8)||(mr==16))&&((nr==4)||(nr==6));
+    }
+
+    inline tuning validate(tuning b, tuning fallback)
+    {
+        if(!valid_micro_kernel(b.mr,b.nr))
+        {
+            b.mr=fallback.mr;
+            b.nr=fallback.nr;
+        }
+        if(b.kc==0)
+            b.kc=fallback.kc;
+        if(b.mc<b.mr)
+            b.mc=b.mr;
+        if(b.nc<b.nr)
+            b.nc=b.nr;
+        b.mc-=b.mc%b.mr;
+        b.nc-=b.nc%b.nr;
+        return b;
+    }
+
+    inline std::string profile_path()
+    {
+        const char *path=std::getenv("TBLAS_PROFILE");
+        if(path&&*path)
+            return path;
+        const char *home=std::getenv("HOME");
+        if(home&&*home)
+            return std::string(home)+"/.tblas_profile";
+        return ".tblas_profile";
+    }
+
+    template <typename T>
+    tuning load_tuning()
+    {
+        const tuning fallback=default_tuning<T>();
+        const char p=precision<T>::letter;
+        tuning b=fallback;
+        if(p==0)
+            return b;
+        std::ifstream in(profile_path().c_str());
+        std::string line;
+        while(std::getline(in,line))
+        {
+            if((line.size()<3)||(line[0]!=p)||(line[1]!='.'))
+                continue;
+            std::istringstream fields(line.substr(2));
+            std::string key;
+            size_t value;
+            if(!(fields >> key >> value))
+                continue;
+            if(key=="mc")
+                b.mc=value;
+            else if(key=="kc")
+                b.kc=value;
+            else if(key=="nc")
+                b.nc=value;
+            else if(key=="mr")
+                b.mr=value;
+            else if(key=="nr")
+                b.nr=value;
+            else if(key=="l1")
+                b.l1=value;
+            else if(key=="l2")
+                b.l2=value;
+            else if(key=="stream")
+                b.stream=value;
+        }
+        return validate(b,fallback);
+    }
+
+    template <typename T>
+    const tuning &profile()
+    {
+        static const tuning b=load_tuning<T>();
+        return b;
+    }
+}
+#endif
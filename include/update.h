@@ -0,0 +1,193 @@
+//
+//  update.h
+//
+//  Purpose
+//  =======
+//
+//  Accumulates rank-1 and rank-2 updates of a matrix and applies them
+//  together as a single matrix-matrix product.
+//
+//  Each update queued on a rank_update is stored as columns of a pair of
+//  workspace matrices X and W, so that after k queued updates the matrix
+//  to be added is X * W^T.  The product is added to A by the blocked gemm
+//  when the workspace fills, when flush or matrix is called, and when the
+//  accumulator is destroyed.  A run of k updates therefore costs one sweep
+//  over A at matrix-matrix speed instead of k sweeps at vector speed.
+//
+//  A general accumulator, made with uplo='G', takes ger and gerc updates of
+//  the m-by-n matrix A:
+//
+//      A <- alpha * x * y^T + A  [ger]
+//
+//      A <- alpha * x * y^H + A  [gerc]
+//
+//  A triangular accumulator, made with uplo='U' or 'L' and m=n, takes syr,
+//  syr2, her and her2 updates of the upper or lower triangle of the order n
+//  matrix A:
+//
+//      A <- alpha * x * x^T + A  [syr]
+//
+//      A <- alpha * x * y^T + alpha * y * x^T + A  [syr2]
+//
+//      A <- alpha * x * x^H + A  [her]
+//
+//      A <- alpha * x * y^H + conj(alpha) * y * x^H + A  [her2]
+//
+//  and applies them through gemm_triangle, so only the referenced triangle
+//  is read or written.  After a her or her2 update the diagonal
+//  of A is kept real, so symmetric and Hermitian updates should not be
+//  queued on the same accumulator.
+//
+//  The matrix must not be accessed other than through matrix while updates
+//  are pending.
+//
+//  Arguments
+//  =========
+//
+//  uplo     specifies whether A is a general matrix ('G'), or is accessed as
+//           upper ('U') or lower ('L') triangular
+//
+//  m        number of rows of the matrix A
+//
+//  n        number of columns of the matrix A
+//
+//  A        matrix to be updated
+//
+//  ldA      column length of the matrix A, must be at least m
+//
+//  capacity number of rank-1 updates held before the accumulator flushes,
+//           default is the kc blocking parameter (see tune.h); a rank-2
+//           update counts as two
+//
+
+#ifndef __update__
+#define __update__
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "gemm.h"
+#include "stride.h"
+#include "tune.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T>
+    class rank_update
+    {
+    public:
+        rank_update(char uplo, size_t m, size_t n, T *A, size_t ldA, size_t capacity=0) :
+            uplo(uplo), m(m), n(n), A(A), ldA(ldA), k(0), hermitian(false)
+        {
+            cap=(capacity>0)?capacity:profile<T>().kc;
+            cap=std::max(cap,size_t(2));
+            X.resize(m*cap);
+            W.resize(n*cap);
+        }
+
+        ~rank_update()
+        {
+            flush();
+        }
+
+        void ger(T alpha, const T *x, ptrdiff_t incx, const T *y, ptrdiff_t incy)
+        {
+            queue(alpha,x,incx,y,incy,false);
+        }
+
+        void gerc(T alpha, const T *x, ptrdiff_t incx, const T *y, ptrdiff_t incy)
+        {
+            queue(alpha,x,incx,y,incy,true);
+        }
+
+        void syr(T alpha, const T *x, ptrdiff_t incx)
+        {
+            queue(alpha,x,incx,x,incx,false);
+        }
+
+        void syr2(T alpha, const T *x, ptrdiff_t incx, const T *y, ptrdiff_t incy)
+        {
+            queue(alpha,x,incx,y,incy,false);
+            queue(alpha,y,incy,x,incx,false);
+        }
+
+        template <typename U>
+        void her(U alpha, const T *x, ptrdiff_t incx)
+        {
+            if(alpha!=U(0))
+                hermitian=true;
+            queue(T(alpha),x,incx,x,incx,true);
+        }
+
+        void her2(T alpha, const T *x, ptrdiff_t incx, const T *y, ptrdiff_t incy)
+        {
+            if(alpha!=T(0))
+                hermitian=true;
+            queue(alpha,x,incx,y,incy,true);
+            queue(conjugate(alpha),y,incy,x,incx,true);
+        }
+
+        size_t pending() const
+        {
+            return k;
+        }
+
+        T *matrix()
+        {
+            flush();
+            return A;
+        }
+
+        void flush()
+        {
+            if(k==0)
+                return;
+            if((uplo!='U')&&(uplo!='L'))
+                gemm('N','T',m,n,k,T(1),X.data(),m,W.data(),n,T(1),A,ldA);
+            else
+                gemm_triangle(uplo,'N','T',n,k,T(1),X.data(),m,W.data(),n,A,ldA,hermitian);
+            k=0;
+        }
+
+    private:
+        rank_update(const rank_update &);
+        rank_update &operator=(const rank_update &);
+
+        //  Appends x as a column of X and alpha * op(y) as a column of W.
+
+        void queue(T alpha, const T *x, ptrdiff_t incx, const T *y, ptrdiff_t incy, bool conj)
+        {
+            if((m==0)||(n==0)||(alpha==T(0)))
+                return;
+            if(k==cap)
+                flush();
+            T *u=X.data()+k*m;
+            T *w=W.data()+k*n;
+            x=origin(x,m,incx);
+            y=origin(y,n,incy);
+            for(size_t i=0;i<m;i++)
+                u[i]=x[static_cast<ptrdiff_t>(i)*incx];
+            for(size_t j=0;j<n;j++)
+            {
+                const T yj=y[static_cast<ptrdiff_t>(j)*incy];
+                w[j]=alpha*(conj?conjugate(yj):yj);
+            }
+            k++;
+        }
+
+        char uplo;
+        size_t m;
+        size_t n;
+        T *A;
+        size_t ldA;
+        size_t k;
+        size_t cap;
+        bool hermitian;
+        std::vector<T> X;
+        std::vector<T> W;
+    };
+}
+#endif
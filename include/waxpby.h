@@ -0,0 +1,76 @@
+//
+//  waxpby.h
+//
+//  Purpose
+//  =======
+//
+//  Computes the sum of scalar multiples of two vectors into a third,
+//  as WAXPBY in the BLAS Technical Forum standard:
+//
+//      w <- alpha * x + beta * y
+//
+//  in a single pass over memory.  Long vectors are split across threads.
+//  The output w may coincide with x or y when its stride is the same.
+//
+//  Arguments
+//  =========
+//
+//  n       length of vectors x, y and w
+//
+//  alpha   scalar multiple of x
+//
+//  x       vector of length n
+//
+//  incx    stride of vector x; if negative, x is stored in reverse order
+//
+//  beta    scalar multiple of y
+//
+//  y       vector of length n
+//
+//  incy    stride of vector y; if negative, y is stored in reverse order
+//
+//  w       vector of length n (output only)
+//
+//  incw    stride of vector w; if negative, w is stored in reverse order
+//
+
+#ifndef __waxpby__
+#define __waxpby__
+
+#include <cstddef>
+#include "stride.h"
+#include "thread.h"
+#include "tune.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+namespace tblas
+{
+    template <typename T>
+    void waxpby(size_t n, T alpha, T *x, ptrdiff_t incx, T beta, T *y, ptrdiff_t incy, T *w, ptrdiff_t incw)
+    {
+        x=origin(x,n,incx);
+        y=origin(y,n,incy);
+        w=origin(w,n,incw);
+        parallel_for(n,profile<T>().l1,[=](size_t begin, size_t end)
+        {
+            const ptrdiff_t b=static_cast<ptrdiff_t>(begin);
+            const ptrdiff_t m=static_cast<ptrdiff_t>(end-begin);
+            T *xb=x+b*incx;
+            T *yb=y+b*incy;
+            T *wb=w+b*incw;
+            if((incx==1)&&(incy==1)&&(incw==1))
+            {
+                for(ptrdiff_t i=0;i<m;i++)
+                    wb[i]=alpha*xb[i]+beta*yb[i];
+            }
+            else
+            {
+                for(ptrdiff_t i=0;i<m;i++)
+                    wb[i*incw]=alpha*xb[i*incx]+beta*yb[i*incy];
+            }
+        });
+    }
+}
+#endif
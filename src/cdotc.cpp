@@ -1,7 +1,10 @@
 #include "blas.h"
 #include "dotc.h"
+#include "small.h"
 
 using tblas::dotc;
+using tblas::small_dot;
+using tblas::small_order;
 
 #ifdef __INTEL_COMPILER
 void cdotc_(complex<float> &sum, const int &n, complex<float> *x, const int &incx, complex<float> *y, const int &incy)
@@ -14,7 +17,9 @@ complex<float> cdotc_(const int &n, complex<float> *x, const int &incx, complex<
     const complex<float> zero(0.0f,0.0f);
     complex<float> sum(zero);
 #endif
-    if(n>=0)
+    if(n<=small_order)
+        sum=small_dot<true>(n,x,incx,y,incy);
+    else
         sum=dotc(n,sum,x,incx,y,incy);
 #ifndef __INTEL_COMPILER
     return sum;
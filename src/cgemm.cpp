@@ -1,14 +1,19 @@
 #include "blas.h"
 #include "gemm.h"
+#include "small.h"
 #include <cctype>
 #include <utility>
 
 using std::toupper;
 using std::max;
 using tblas::gemm;
+using tblas::small_gemm;
 
 void cgemm_(const char &TransA, const char &TransB, const int &m, const int &n, const int &k, const complex<float> &alpha, complex<float> *A, const int &ldA, complex<float> *B, const int &ldB, const complex<float> &beta, complex<float> *C, const int &ldC)
 {
+    if(small_gemm(TransA,TransB,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC))
+        return;
+
     int info=0;
     char transA=toupper(TransA);
     char transB=toupper(TransB);
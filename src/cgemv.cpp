@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "gemv.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::gemv;
+using tblas::small_gemv;
 
 void cgemv_(const char &Trans, const int &m, const int &n, const complex<float> &alpha, complex<float> *A, const int &ldA, complex<float> *x, const int &incx, const complex<float> &beta, complex<float> *y, const int &incy)
 {
+    if(small_gemv(Trans,m,n,alpha,A,ldA,x,incx,beta,y,incy))
+        return;
+
     int info=0;
     char trans=toupper(Trans);
     if((trans!='N')&&(trans!='T')&&(trans!='C'))
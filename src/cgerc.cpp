@@ -1,11 +1,16 @@
 #include "blas.h"
 #include "gerc.h"
+#include "small.h"
 
 using std::conj;
 using tblas::gerc;
+using tblas::small_gerc;
 
 void cgerc_(const int &m, const int &n, const complex<float> &alpha, complex<float> *x, const int &incx, complex<float> *y, const int &incy, complex<float> *A, const int &ldA)
 {
+    if(small_gerc(m,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     if(m<0)
         info=1;
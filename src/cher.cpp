@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "her.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::her;
+using tblas::small_her;
 
 void cher_(const char &Uplo, const int &n, const float &alpha, complex<float> *x, const int &incx, complex<float> *A, const int &ldA)
 {
+    if(small_her(Uplo,n,alpha,x,incx,A,ldA))
+        return;
+
     int info=0;
     char uplo=toupper(Uplo);
     if((uplo!='U')&&(uplo!='L'))
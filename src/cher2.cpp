@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "her2.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::her2;
+using tblas::small_her2;
 
 void cher2_(const char &Uplo, const int &n, const complex<float> &alpha, complex<float> *x, const int &incx, complex<float> *y, const int &incy, complex<float> *A, const int &ldA)
 {
+    if(small_her2(Uplo,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     char uplo=toupper(Uplo);
     if((uplo!='U')&&(uplo!='L'))
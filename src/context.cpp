@@ -0,0 +1,38 @@
+#include "context.h"
+#include <mutex>
+
+namespace tblas
+{
+    //  Function-local, so that the default is there for calls made while
+    //  other translation units are still being initialized.
+
+    static std::mutex &default_context_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static context &default_context_value()
+    {
+        static context c;
+        return c;
+    }
+
+    context default_context()
+    {
+        std::lock_guard<std::mutex> lock(default_context_mutex());
+        return default_context_value();
+    }
+
+    void set_default_context(const context &c)
+    {
+        std::lock_guard<std::mutex> lock(default_context_mutex());
+        default_context_value()=c;
+    }
+
+    context &this_context()
+    {
+        static thread_local context c=default_context();
+        return c;
+    }
+}
@@ -1,11 +1,16 @@
 #include "blas.h"
 #include "axpy.h"
+#include "small.h"
 
 using tblas::axpy;
+using tblas::small_axpy;
+using tblas::small_order;
 
 void daxpy_(const int &n, const double &alpha, double *x, const int &incx, double *y, const int &incy)
 {
     const double zero(0.0);
-    if((n>0)&&(alpha!=zero))
+    if(n<=small_order)
+        small_axpy(n,alpha,x,incx,y,incy);
+    else if(alpha!=zero)
         axpy(n,alpha,x,incx,y,incy);
 }
@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "dot.h"
+#include "small.h"
 
 using tblas::dot;
+using tblas::small_dot;
+using tblas::small_order;
 
 double ddot_(const int &n, double *x, const int &incx, double *y, const int &incy)
 {
     double sum(0.0);
-    if(n>=0)
+    if(n<=small_order)
+        sum=small_dot<false>(n,x,incx,y,incy);
+    else
         sum=dot(n,sum,x,incx,y,incy);
     return sum;
 }
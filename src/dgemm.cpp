@@ -1,14 +1,19 @@
 #include "blas.h"
 #include "gemm.h"
+#include "small.h"
 #include <cctype>
 #include <utility>
 
 using std::toupper;
 using std::max;
 using tblas::gemm;
+using tblas::small_gemm;
 
 void dgemm_(const char &TransA, const char &TransB, const int &m, const int &n, const int &k, const double &alpha, double *A, const int &ldA, double *B, const int &ldB, const double &beta, double *C, const int &ldC)
 {
+    if(small_gemm(TransA,TransB,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC))
+        return;
+
     int info=0;
     char transA=toupper(TransA);
     char transB=toupper(TransB);
@@ -1,10 +1,15 @@
 #include "blas.h"
 #include "ger.h"
+#include "small.h"
 
 using tblas::ger;
+using tblas::small_ger;
 
 void dger_(const int &m, const int &n, const double &alpha, double *x, const int &incx, double *y, const int &incy, double *A, const int &ldA)
 {
+    if(small_ger(m,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     if(m<0)
         info=1;
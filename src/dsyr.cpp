@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "syr.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::syr;
+using tblas::small_syr;
 
 void dsyr_(const char &Uplo, const int &n, const double &alpha, double *x, const int &incx, double *A, const int &ldA)
 {
+    if(small_syr(Uplo,n,alpha,x,incx,A,ldA))
+        return;
+
     int info=0;
     char uplo=toupper(Uplo);
     if((uplo!='U')&&(uplo!='L'))
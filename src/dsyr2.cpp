@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "syr2.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::syr2;
+using tblas::small_syr2;
 
 void dsyr2_(const char &Uplo, const int &n, const double &alpha, double *x, const int &incx, double *y, const int &incy, double *A, const int &ldA)
 {
+    if(small_syr2(Uplo,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     char uplo=toupper(Uplo);
     if((uplo!='U')&&(uplo!='L'))
@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "trsv.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::trsv;
+using tblas::small_trsv;
 
 void dtrsv_(const char &Uplo, const char &Trans, const char &Diag, const int &n, double *A, const int &ldA, double *x, const int &incx)
 {
+    if(small_trsv(Uplo,Trans,Diag,n,A,ldA,x,incx))
+        return;
+
     int info=0;
     char uplo=toupper(Uplo);
     char trans=toupper(Trans);
@@ -1,11 +1,16 @@
 #include "blas.h"
 #include "axpy.h"
+#include "small.h"
 
 using tblas::axpy;
+using tblas::small_axpy;
+using tblas::small_order;
 
 void saxpy_(const int &n, const float &alpha, float *x, const int &incx, float *y, const int &incy)
 {
     const float zero(0.0f);
-    if((n>0)&&(alpha!=zero))
+    if(n<=small_order)
+        small_axpy(n,alpha,x,incx,y,incy);
+    else if(alpha!=zero)
         axpy(n,alpha,x,incx,y,incy);
 }
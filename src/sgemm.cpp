@@ -1,14 +1,19 @@
 #include "blas.h"
 #include "gemm.h"
+#include "small.h"
 #include <cctype>
 #include <utility>
 
 using std::max;
 using std::toupper;
 using tblas::gemm;
+using tblas::small_gemm;
 
 void sgemm_(const char &TransA, const char &TransB, const int &m, const int &n, const int &k, const float &alpha, float *A, const int &ldA, float *B, const int &ldB, const float &beta, float *C, const int &ldC)
 {
+    if(small_gemm(TransA,TransB,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC))
+        return;
+
     int info=0;
     char transA=toupper(TransA);
     char transB=toupper(TransB);
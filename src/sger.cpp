@@ -1,10 +1,15 @@
 #include "blas.h"
 #include "ger.h"
+#include "small.h"
 
 using tblas::ger;
+using tblas::small_ger;
 
 void sger_(const int &m, const int &n, const float &alpha, float *x, const int &incx, float *y, const int &incy, float *A, const int &ldA)
 {
+    if(small_ger(m,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     if(m<0)
         info=1;
@@ -0,0 +1,16 @@
+#include "thread.h"
+
+namespace tblas
+{
+    thread_pool &thread_pool::instance()
+    {
+        static thread_pool pool(default_threads());
+        return pool;
+    }
+
+    bool &thread_pool::inside()
+    {
+        static thread_local bool flag=false;
+        return flag;
+    }
+}
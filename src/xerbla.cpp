@@ -1,15 +1,27 @@
 #include "blas.h"
+#include "context.h"
 #include <iostream>
 #include <cstdlib>
 
 using std::cout;
 using std::endl;
 using std::exit;
+using tblas::context;
+using tblas::this_context;
 
 void xerbla_(const char *name, const int &info)
 {
-    cout << " ** On entry to " << name;
-    cout << " parameter number " << info;
-    cout << " had an illegal value." << endl;
-    exit(EXIT_FAILURE);
+    const context &c=this_context();
+    if(c.stats)
+        c.stats->errors++;
+    if(c.handler)
+        c.handler(name,info);
+    else if(c.errors!=tblas::error_quiet)
+    {
+        cout << " ** On entry to " << name;
+        cout << " parameter number " << info;
+        cout << " had an illegal value." << endl;
+    }
+    if(c.errors==tblas::error_exit)
+        exit(EXIT_FAILURE);
 }
@@ -1,11 +1,16 @@
 #include "blas.h"
 #include "axpy.h"
+#include "small.h"
 
 using tblas::axpy;
+using tblas::small_axpy;
+using tblas::small_order;
 
 void zaxpy_(const int &n, const complex<double> &alpha, complex<double> *x, const int &incx, complex<double> *y, const int &incy)
 {
     const complex<double> zero(0.0);
-    if((n>0)&&(alpha!=zero))
+    if(n<=small_order)
+        small_axpy(n,alpha,x,incx,y,incy);
+    else if(alpha!=zero)
         axpy(n,alpha,x,incx,y,incy);
 }
@@ -1,7 +1,10 @@
 #include "blas.h"
 #include "dotc.h"
+#include "small.h"
 
 using tblas::dotc;
+using tblas::small_dot;
+using tblas::small_order;
 
 #ifdef __INTEL_COMPILER
 void zdotc_(complex<double> &sum, const int &n, complex<double> *x, const int &incx, complex<double> *y, const int &incy)
@@ -14,7 +17,9 @@ complex<double> zdotc_(const int &n, complex<double> *x, const int &incx, comple
     const complex<double> zero(0.0,0.0);
     complex<double> sum(zero);
 #endif
-    if(n>=0)
+    if(n<=small_order)
+        sum=small_dot<true>(n,x,incx,y,incy);
+    else
         sum=dotc(n,sum,x,incx,y,incy);
 #ifndef __INTEL_COMPILER
     return sum;
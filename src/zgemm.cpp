@@ -1,14 +1,19 @@
 #include "blas.h"
 #include "gemm.h"
+#include "small.h"
 #include <cctype>
 #include <utility>
 
 using std::max;
 using std::toupper;
 using tblas::gemm;
+using tblas::small_gemm;
 
 void zgemm_(const char &TransA, const char &TransB, const int &m, const int &n, const int &k, const complex<double> &alpha, complex<double> *A, const int &ldA, complex<double> *B, const int &ldB, const complex<double> &beta, complex<double> *C, const int &ldC)
 {
+    if(small_gemm(TransA,TransB,m,n,k,alpha,A,ldA,B,ldB,beta,C,ldC))
+        return;
+
     int info=0;
     char transA=toupper(TransA);
     char transB=toupper(TransB);
@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "gemv.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::gemv;
+using tblas::small_gemv;
 
 void zgemv_(const char &Trans, const int &m, const int &n, const complex<double> &alpha, complex<double> *A, const int &ldA, complex<double> *x, const int &incx, const complex<double> &beta, complex<double> *y, const int &incy)
 {
+    if(small_gemv(Trans,m,n,alpha,A,ldA,x,incx,beta,y,incy))
+        return;
+
     int info=0;
     char trans=toupper(Trans);
     if((trans!='N')&&(trans!='T')&&(trans!='C'))
@@ -1,10 +1,15 @@
 #include "blas.h"
 #include "gerc.h"
+#include "small.h"
 
 using tblas::gerc;
+using tblas::small_gerc;
 
 void zgerc_(const int &m, const int &n, const complex<double> &alpha, complex<double> *x, const int &incx, complex<double> *y, const int &incy, complex<double> *A, const int &ldA)
 {
+    if(small_gerc(m,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     if(m<0)
         info=1;
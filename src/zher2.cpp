@@ -1,12 +1,17 @@
 #include "blas.h"
 #include "her2.h"
+#include "small.h"
 #include <cctype>
 
 using std::toupper;
 using tblas::her2;
+using tblas::small_her2;
 
 void zher2_(const char &Uplo, const int &n, const complex<double> &alpha, complex<double> *x, const int &incx, complex<double> *y, const int &incy, complex<double> *A, const int &ldA)
 {
+    if(small_her2(Uplo,n,alpha,x,incx,y,incy,A,ldA))
+        return;
+
     int info=0;
     char uplo=toupper(Uplo);
     if((uplo!='U')&&(uplo!='L'))